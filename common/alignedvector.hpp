@@ -0,0 +1,72 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* std::vector whose storage starts on a cache line. Used for the SoA
+* arrays that worker threads stream through in chunks: with the base
+* aligned and chunk sizes a multiple of 16 elements, no two chunks of a
+* 4-byte array share a cache line.
+*/
+
+#ifndef ALIGNEDVECTOR_HPP
+#define ALIGNEDVECTOR_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+enum { CACHE_LINE_BYTES = 64 };
+
+template <class T>
+struct CacheLineAllocator
+{
+    typedef T value_type;
+
+    CacheLineAllocator() {}
+    template <class U> CacheLineAllocator(const CacheLineAllocator<U>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        std::size_t bytes = (n * sizeof(T) + CACHE_LINE_BYTES - 1) / CACHE_LINE_BYTES * CACHE_LINE_BYTES;
+#if defined(_MSC_VER)
+        void* p = _aligned_malloc(bytes, CACHE_LINE_BYTES);
+#else
+        void* p = NULL;
+        if (posix_memalign(&p, CACHE_LINE_BYTES, bytes) != 0)
+        {
+            p = NULL;
+        }
+#endif
+        if (!p)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+#if defined(_MSC_VER)
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+};
+
+template <class T, class U>
+bool operator==(const CacheLineAllocator<T>&, const CacheLineAllocator<U>&) { return true; }
+template <class T, class U>
+bool operator!=(const CacheLineAllocator<T>&, const CacheLineAllocator<U>&) { return false; }
+
+template <class T>
+using AlignedVector = std::vector<T, CacheLineAllocator<T> >;
+
+#endif
@@ -0,0 +1,299 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the frame-time recorder and its CSV/JSON report.
+*/
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include "clock.hpp"
+#include "benchmark.hpp"
+
+// Summary of one metric, in milliseconds
+struct MetricSummary
+{
+    double min, mean, p50, p95, p99;
+};
+
+/*
+* summarize
+* ------------------------------------------------------------------
+* Purpose: Nearest-rank percentiles plus min and mean of a sample set.
+* Negative samples (GPU queries that never completed) are ignored.
+*/
+static MetricSummary summarize(const std::vector<double>& samples)
+{
+    std::vector<double> sorted;
+    sorted.reserve(samples.size());
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        if (samples[i] >= 0.0)
+        {
+            sorted.push_back(samples[i]);
+        }
+    }
+
+    MetricSummary s = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+    if (sorted.empty())
+    {
+        return s;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (size_t i = 0; i < sorted.size(); i++)
+    {
+        sum += sorted[i];
+    }
+    const size_t n = sorted.size();
+    s.min  = sorted[0];
+    s.mean = sum / double(n);
+    s.p50  = sorted[std::min(n - 1, size_t(0.50 * (n - 1) + 0.5))];
+    s.p95  = sorted[std::min(n - 1, size_t(0.95 * (n - 1) + 0.5))];
+    s.p99  = sorted[std::min(n - 1, size_t(0.99 * (n - 1) + 0.5))];
+    return s;
+}
+
+FrameBenchmark::FrameBenchmark()
+    : m_frame(0), m_recorded(0), m_frameStart(0.0), m_submitStart(0.0), m_lastFrameStart(-1.0)
+{
+    for (int i = 0; i < kQueryLatency; i++)
+    {
+        m_queries[i] = 0;
+        m_queryFrame[i] = -1;
+    }
+}
+
+void FrameBenchmark::begin(unsigned int frameCount)
+{
+    m_frameMs.assign(frameCount, -1.0);
+    m_updateMs.assign(frameCount, -1.0);
+    m_submitMs.assign(frameCount, -1.0);
+    m_gpuMs.assign(frameCount, -1.0);
+    m_counters.assign(m_counterNames.size(), std::vector<double>(frameCount, -1.0));
+    m_frame = 0;
+    m_recorded = 0;
+    m_lastFrameStart = -1.0;
+
+    glGenQueries(kQueryLatency, m_queries);
+    for (int i = 0; i < kQueryLatency; i++)
+    {
+        m_queryFrame[i] = -1;
+    }
+}
+
+/*
+* collectQuery
+* ------------------------------------------------------------------
+* Purpose: Store the result of the query in `slot` into its frame's GPU
+* sample. Without `wait` the result is only read if already available.
+*/
+void FrameBenchmark::collectQuery(unsigned int slot, bool wait)
+{
+    if (m_queryFrame[slot] < 0)
+    {
+        return;
+    }
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(m_queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available && !wait)
+    {
+        return;
+    }
+    GLuint64 ns = 0;
+    glGetQueryObjectui64v(m_queries[slot], GL_QUERY_RESULT, &ns);
+    m_gpuMs[m_queryFrame[slot]] = double(ns) * 1e-6;
+    m_queryFrame[slot] = -1;
+}
+
+unsigned int FrameBenchmark::addCounter(const std::string& name)
+{
+    m_counterNames.push_back(name);
+    return (unsigned int)m_counterNames.size() - 1;
+}
+
+void FrameBenchmark::setCounter(unsigned int id, double value)
+{
+    if (id < m_counters.size() && m_frame < m_counters[id].size())
+    {
+        m_counters[id][m_frame] = value;
+    }
+}
+
+void FrameBenchmark::beginFrame()
+{
+    m_frameStart = clockSeconds();
+    if (m_lastFrameStart >= 0.0 && m_frame > 0)
+    {
+        m_frameMs[m_frame - 1] = (m_frameStart - m_lastFrameStart) * 1000.0;
+    }
+    m_lastFrameStart = m_frameStart;
+
+    // Reuse the query issued kQueryLatency frames ago; by now it is done
+    unsigned int slot = m_frame % kQueryLatency;
+    collectQuery(slot, true);
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[slot]);
+    m_queryFrame[slot] = int(m_frame);
+}
+
+void FrameBenchmark::markSubmit()
+{
+    m_submitStart = clockSeconds();
+    m_updateMs[m_frame] = (m_submitStart - m_frameStart) * 1000.0;
+}
+
+void FrameBenchmark::endFrame()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    double now = clockSeconds();
+    m_submitMs[m_frame] = (now - m_submitStart) * 1000.0;
+
+    // Opportunistically pick up finished queries from earlier frames
+    for (unsigned int i = 0; i < kQueryLatency; i++)
+    {
+        if (i != m_frame % kQueryLatency)
+        {
+            collectQuery(i, false);
+        }
+    }
+
+    m_frame++;
+    m_recorded = m_frame;
+}
+
+void FrameBenchmark::finish()
+{
+    // The last frame's duration ends when its GPU work is done
+    glFinish();
+    if (m_frame > 0)
+    {
+        m_frameMs[m_frame - 1] = (clockSeconds() - m_lastFrameStart) * 1000.0;
+    }
+    for (unsigned int i = 0; i < kQueryLatency; i++)
+    {
+        collectQuery(i, true);
+    }
+    glDeleteQueries(kQueryLatency, m_queries);
+}
+
+/*
+* writeJsonString
+* ------------------------------------------------------------------
+* Purpose: Write s as a quoted JSON string. The description is free-form
+* (it comes from the options), so quotes, backslashes and control
+* characters are escaped to keep the report valid JSON.
+*/
+static void writeJsonString(FILE* file, const char* s)
+{
+    fputc('"', file);
+    for (; *s; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+        {
+            fputc('\\', file);
+            fputc(c, file);
+        }
+        else if (c == '\n')
+        {
+            fputs("\\n", file);
+        }
+        else if (c == '\t')
+        {
+            fputs("\\t", file);
+        }
+        else if (c < 0x20)
+        {
+            fprintf(file, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+bool FrameBenchmark::writeReport(const std::string& prefix, const std::string& description) const
+{
+    const char* names[4] = { "frame", "cpu_update", "cpu_submit", "gpu" };
+    const std::vector<double>* series[4] = { &m_frameMs, &m_updateMs, &m_submitMs, &m_gpuMs };
+
+    std::string csvPath = prefix + ".csv";
+    FILE* csv = fopen(csvPath.c_str(), "w");
+    if (!csv)
+    {
+        printf("Impossible to write %s\n", csvPath.c_str());
+        return false;
+    }
+    fprintf(csv, "metric,min_ms,mean_ms,p50_ms,p95_ms,p99_ms\n");
+    for (int m = 0; m < 4; m++)
+    {
+        MetricSummary s = summarize(*series[m]);
+        fprintf(csv, "%s,%.4f,%.4f,%.4f,%.4f,%.4f\n", names[m], s.min, s.mean, s.p50, s.p95, s.p99);
+    }
+    // Counters share the columns; their values are counts, not ms
+    for (size_t c = 0; c < m_counters.size(); c++)
+    {
+        MetricSummary s = summarize(m_counters[c]);
+        fprintf(csv, "%s,%.4f,%.4f,%.4f,%.4f,%.4f\n", m_counterNames[c].c_str(), s.min, s.mean, s.p50, s.p95, s.p99);
+    }
+    fclose(csv);
+
+    std::string jsonPath = prefix + ".json";
+    FILE* json = fopen(jsonPath.c_str(), "w");
+    if (!json)
+    {
+        printf("Impossible to write %s\n", jsonPath.c_str());
+        return false;
+    }
+    fprintf(json, "{\n  \"description\": ");
+    writeJsonString(json, description.c_str());
+    fprintf(json, ",\n  \"frames\": %u,\n  \"metrics_ms\": {\n", m_recorded);
+    for (int m = 0; m < 4; m++)
+    {
+        MetricSummary s = summarize(*series[m]);
+        fprintf(json, "    \"%s\": { \"min\": %.4f, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f }%s\n",
+                names[m], s.min, s.mean, s.p50, s.p95, s.p99, m < 3 ? "," : "");
+    }
+    fprintf(json, "  },\n  \"counters\": {\n");
+    for (size_t c = 0; c < m_counters.size(); c++)
+    {
+        MetricSummary s = summarize(m_counters[c]);
+        fprintf(json, "    ");
+        writeJsonString(json, m_counterNames[c].c_str());
+        fprintf(json, ": { \"min\": %.4f, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f }%s\n",
+                s.min, s.mean, s.p50, s.p95, s.p99, c + 1 < m_counters.size() ? "," : "");
+    }
+    fprintf(json, "  }\n}\n");
+    fclose(json);
+
+    printf("Benchmark report written to %s and %s\n", csvPath.c_str(), jsonPath.c_str());
+    return true;
+}
+
+void FrameBenchmark::printSummary() const
+{
+    const char* names[4] = { "frame", "cpu_update", "cpu_submit", "gpu" };
+    const std::vector<double>* series[4] = { &m_frameMs, &m_updateMs, &m_submitMs, &m_gpuMs };
+
+    printf("%-12s %9s %9s %9s %9s %9s\n", "metric (ms)", "min", "mean", "p50", "p95", "p99");
+    for (int m = 0; m < 4; m++)
+    {
+        MetricSummary s = summarize(*series[m]);
+        printf("%-12s %9.3f %9.3f %9.3f %9.3f %9.3f\n", names[m], s.min, s.mean, s.p50, s.p95, s.p99);
+    }
+    for (size_t c = 0; c < m_counters.size(); c++)
+    {
+        MetricSummary s = summarize(m_counters[c]);
+        printf("%-12s %9.1f %9.1f %9.1f %9.1f %9.1f\n", m_counterNames[c].c_str(), s.min, s.mean, s.p50, s.p95, s.p99);
+    }
+}
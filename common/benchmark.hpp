@@ -0,0 +1,82 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Frame-time recorder for benchmark runs. Every frame records
+*   frame      - wall time between consecutive frame starts
+*   cpu_update - CPU time spent preparing the frame (camera, constants)
+*   cpu_submit - CPU time spent issuing GL calls
+*   gpu        - GPU time of the frame (GL_TIME_ELAPSED query)
+* GPU queries are read back a few frames late so recording never stalls
+* the pipeline. Callers can add per-frame counters (e.g. visible objects)
+* that are summarized the same way. The report gives min, mean, p50, p95
+* and p99 of each metric and counter as CSV and JSON.
+*/
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <string>
+#include <vector>
+
+class FrameBenchmark
+{
+public:
+    FrameBenchmark();
+
+    // Allocate sample storage and GPU queries for `frameCount` frames
+    void begin(unsigned int frameCount);
+
+    // Register a per-frame counter before begin(); returns its id
+    unsigned int addCounter(const std::string& name);
+
+    // Record a counter value for the current frame
+    void setCounter(unsigned int id, double value);
+
+    // Frame boundaries; markSubmit() separates CPU update from submission
+    void beginFrame();
+    void markSubmit();
+    void endFrame();
+
+    // Wait for the outstanding GPU queries after the last frame
+    void finish();
+
+    unsigned int recordedFrames() const { return m_recorded; }
+
+    /*
+    * writeReport()
+    * ------------------------------------------------------------------
+    * Purpose: Write <prefix>.csv and <prefix>.json with the summary
+    * statistics; `description` is stored verbatim in the JSON.
+    * Returns: true if both files were written.
+    */
+    bool writeReport(const std::string& prefix, const std::string& description) const;
+
+    // Print the summary table to stdout
+    void printSummary() const;
+
+private:
+    enum { kQueryLatency = 4 };
+
+    void collectQuery(unsigned int slot, bool wait);
+
+    std::vector<double> m_frameMs;
+    std::vector<double> m_updateMs;
+    std::vector<double> m_submitMs;
+    std::vector<double> m_gpuMs;
+
+    std::vector<std::string>         m_counterNames;
+    std::vector<std::vector<double> > m_counters;
+
+    GLuint       m_queries[kQueryLatency];
+    int          m_queryFrame[kQueryLatency];  // frame index per query, -1 = idle
+    unsigned int m_frame;                      // index of the current frame
+    unsigned int m_recorded;
+    double       m_frameStart;
+    double       m_submitStart;
+    double       m_lastFrameStart;
+};
+
+#endif
@@ -0,0 +1,44 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Process CPU time, per platform (std::clock() is wall time on Windows).
+*/
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#include "clock.hpp"
+
+double processCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+    {
+        return 0.0;
+    }
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return double(k.QuadPart + u.QuadPart) * 1.0e-7; // 100 ns units
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0.0;
+    }
+    return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1.0e-6;
+#endif
+}
@@ -0,0 +1,26 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Monotonic wall clock in seconds. Used instead of glfwGetTime() for
+* timings that must also work when GLFW is never initialized (headless
+* runs have no window system). processCpuSeconds() gives the CPU time the
+* process used, to report how busy the render loop keeps the machine.
+*/
+
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <chrono>
+
+inline double clockSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// User + system CPU time of the whole process (all threads), in seconds
+double processCpuSeconds();
+
+#endif
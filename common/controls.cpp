@@ -1,7 +1,7 @@
 /*
 * Author: Liam Long
 * Class: ECE4122 (Lab 3)
-* Last Date Modified: 2025-10-18
+* Last Date Modified: 2026-10-18
 *
 * Description / Purpose of this file:
 * Orbit-style camera controls and render-toggles used by the Lab 3 scene.
@@ -9,14 +9,25 @@
 * zoom (W/S), orbit left/right (A/D), and change elevation (Up/Down). The
 * 'L' key toggles a boolean used by the shader to enable/disable
 * diffuse/specular lighting. This module exposes the current View and
-* Projection matrices to the renderer.
+* Projection matrices to the renderer. Benchmark runs drive the same orbit
+* parameters from a deterministic script instead of the keyboard.
+* Render-on-demand support: key and window-refresh events are tracked
+* through callbacks, and waitForInput() sleeps until the next one.
 */
 
 #include <GLFW/glfw3.h>
 extern GLFWwindow* window;
 
+#if GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR < 2
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#endif
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
 using namespace glm;
 
 #include "controls.hpp"
@@ -24,6 +35,7 @@ using namespace glm;
 // Matrices exposed to renderer
 static glm::mat4 ViewMatrix;        // camera -> world transform inverse
 static glm::mat4 ProjectionMatrix;  // perspective projection
+static glm::vec3 CameraPosition;    // eye point in world space
 
 /*
 * getViewMatrix
@@ -49,17 +61,37 @@ glm::mat4 getProjectionMatrix()
     return ProjectionMatrix; 
 }
 
+/*
+* getCameraPosition
+* ------------------------------------------------------------------
+* Purpose: Return the eye point used to build the current view matrix.
+* Inputs: none
+* Returns: glm::vec3 camera position in world space.
+*/
+glm::vec3 getCameraPosition()
+{
+    return CameraPosition;
+}
+
 // ---- Camera state (orbit around origin, Z up) ----
 static float g_radius    = 12.0f;                 // distance from origin
 static float g_azimuth   = 0.0f;                  // radians around Z
 static float g_elevation = glm::radians(25.0f);   // radians up/down
 static float g_fovDeg    = 60.0f;                 // field of view
+static float g_aspect    = 4.0f / 3.0f;           // viewport width / height
+static float g_sceneRadius = 0.0f;                // extends the far plane
 static bool  g_enableDiffuseSpec = true;          // 'L' toggles this
 
 // Speeds
 static const float kAngSpeed  = 1.8f;  // rad/sec
 static const float kZoomSpeed = 6.0f;  // units/sec
 
+// ---- Input sampling / event state ----
+static double g_lastSampleTime = -1.0;   // glfwGetTime() of the last integration
+static bool   g_inputPending   = false;  // key or refresh event since the last sample
+static double g_pendingPress   = -1.0;   // delivery time of the first press since then
+static double g_sampledPress   = -1.0;   // same, taken in by the last sample
+
 /*
 * getEnableDiffuseSpec
 * ------------------------------------------------------------------
@@ -73,6 +105,85 @@ bool getEnableDiffuseSpec()
     return g_enableDiffuseSpec; 
 }
 
+/*
+* setAspectRatio / setSceneRadius
+* ------------------------------------------------------------------
+* Purpose: Configure the projection for non-default viewports and for
+* scenes larger than the lab ring (the far plane then covers the whole
+* scene seen from the orbit).
+* Inputs: aspect = width / height; radius = scene bounding radius.
+*/
+void setAspectRatio(float aspect)
+{
+    g_aspect = aspect;
+}
+
+void setSceneRadius(float radius)
+{
+    g_sceneRadius = radius;
+}
+
+/*
+* rebuildMatrices
+* ------------------------------------------------------------------
+* Purpose: Clamp the orbit state and rebuild the View and Projection
+* matrices from it. Shared by the keyboard and scripted camera paths.
+*/
+static void rebuildMatrices()
+{
+    // Prevent passing through the origin and flipping models at the poles
+    g_radius = glm::max(g_radius, 2.0f);
+    const float maxEl = glm::radians(89.9f); // avoid pole flip
+    if (g_elevation >  maxEl)
+    {
+        g_elevation =  maxEl;
+    }
+    
+    if (g_elevation < -maxEl)
+    {
+        g_elevation = -maxEl;
+    }
+
+    // Spherical -> Cartesian (Z up)
+    float x = g_radius * cosf(g_elevation) * cosf(g_azimuth);
+    float y = g_radius * cosf(g_elevation) * sinf(g_azimuth);
+    float z = g_radius * sinf(g_elevation);
+    glm::vec3 cam(x, y, z);
+    CameraPosition = cam;
+
+    // Look from cam toward origin with world up = +Z
+    ViewMatrix = glm::lookAt(cam, glm::vec3(0.0f), glm::vec3(0,0,1));
+    
+    float farPlane = glm::max(100.0f, g_radius + 2.0f * g_sceneRadius);
+    ProjectionMatrix = glm::perspective(glm::radians(g_fovDeg), g_aspect, 0.1f, farPlane);
+}
+
+/*
+* computeMatricesFromScript
+* ------------------------------------------------------------------
+* Purpose:
+* Deterministic camera flight for benchmark runs: one full orbit in
+* azimuth while the elevation swings between 10 and 50 degrees twice and
+* the radius breathes in and out three times. The same t always gives the
+* same matrices, so runs are comparable.
+*
+* Inputs:
+* t - progress along the path in [0, 1]
+* sceneRadius - radius enclosing the scene; sets the orbit distance
+*
+* Returns: void. Updates module‑global matrices.
+*/
+void computeMatricesFromScript(float t, float sceneRadius)
+{
+    const float twoPi = glm::two_pi<float>();
+    float baseRadius = glm::max(12.0f, 1.5f * sceneRadius);
+
+    g_azimuth   = twoPi * t;
+    g_elevation = glm::radians(30.0f + 20.0f * sinf(2.0f * twoPi * t));
+    g_radius    = baseRadius * (1.0f + 0.35f * sinf(3.0f * twoPi * t));
+    rebuildMatrices();
+}
+
 /*
 * computeMatricesFromInputs
 * ------------------------------------------------------------------
@@ -91,15 +202,21 @@ bool getEnableDiffuseSpec()
 * Up/Down arrows: raise/lower elevation (pitch)
 * L : toggle diffuse+specular lighting on/off (edge-triggered)
 *
-* Returns: void. Updates module‑global matrices and flags.
+* Returns: true if the orbit (after clamping) or the lighting flag
+* changed. Updates module‑global matrices and flags.
 */
-void computeMatricesFromInputs()
+bool computeMatricesFromInputs()
 {
     // Frame delta-time, independent of frame rate
-    static double lastTime = glfwGetTime();
     double now = glfwGetTime();
-    float dt = float(now - lastTime);
-    lastTime = now;
+    float dt = g_lastSampleTime < 0.0 ? 0.0f : float(now - g_lastSampleTime);
+    g_lastSampleTime = now;
+
+    g_sampledPress = g_pendingPress;
+    g_pendingPress = -1.0;
+    g_inputPending = false;
+    const float oldRadius = g_radius, oldAzimuth = g_azimuth, oldElevation = g_elevation;
+    const bool oldDiffuseSpec = g_enableDiffuseSpec;
 
     // Keyboard — spec requires WASD + arrows
     // W to zoom in 
@@ -147,27 +264,93 @@ void computeMatricesFromInputs()
     }
     lastL = lNow;
     
-    // Prevent passing through the origin and flipping models at the poles
-    g_radius = glm::max(g_radius, 2.0f);
-    const float maxEl = glm::radians(89.9f); // avoid pole flip
-    if (g_elevation >  maxEl)
+    rebuildMatrices();
+    return g_radius != oldRadius || g_azimuth != oldAzimuth || g_elevation != oldElevation ||
+           g_enableDiffuseSpec != oldDiffuseSpec;
+}
+
+/*
+* onKey / onRefresh
+* ------------------------------------------------------------------
+* Purpose: GLFW callbacks. Any key event or a window refresh request
+* (exposed, resized) asks for a redraw; the first press is timed for the
+* input-to-present latency.
+*/
+static void onKey(GLFWwindow*, int, int, int action, int)
+{
+    g_inputPending = true;
+    if (action != GLFW_RELEASE && g_pendingPress < 0.0)
     {
-        g_elevation =  maxEl;
+        g_pendingPress = glfwGetTime();
     }
-    
-    if (g_elevation < -maxEl)
+}
+
+static void onRefresh(GLFWwindow*)
+{
+    g_inputPending = true;
+}
+
+void trackInputEvents()
+{
+    glfwSetKeyCallback(window, onKey);
+    glfwSetWindowRefreshCallback(window, onRefresh);
+}
+
+bool inputPending()
+{
+    return g_inputPending;
+}
+
+double getInputEventTime()
+{
+    return g_sampledPress;
+}
+
+/*
+* waitForInput
+* ------------------------------------------------------------------
+* Purpose:
+* Block in GLFW until an event or the timeout. GLFW 3.1 has no
+* glfwWaitEventsTimeout(): a helper thread posts an empty event at the
+* deadline instead, unless the wait ended first. A late empty event only
+* makes the next wait return early.
+*
+* Inputs:
+* timeoutSeconds - longest sleep
+*/
+void waitForInput(double timeoutSeconds)
+{
+    if (timeoutSeconds > 0.0)
     {
-        g_elevation = -maxEl;
+#if GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR < 2
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool done = false;
+        std::thread timer([&]()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!wake.wait_for(lock, std::chrono::duration<double>(timeoutSeconds), [&]() { return done; }))
+            {
+                glfwPostEmptyEvent();
+            }
+        });
+        glfwWaitEvents();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        wake.notify_one();
+        timer.join();
+#else
+        glfwWaitEventsTimeout(timeoutSeconds);
+#endif
+    }
+    else
+    {
+        glfwPollEvents();
     }
 
-    // Spherical -> Cartesian (Z up)
-    float x = g_radius * cosf(g_elevation) * cosf(g_azimuth);
-    float y = g_radius * cosf(g_elevation) * sinf(g_azimuth);
-    float z = g_radius * sinf(g_elevation);
-    glm::vec3 cam(x, y, z);
-
-    // Look from cam toward origin with world up = +Z
-    ViewMatrix = glm::lookAt(cam, glm::vec3(0.0f), glm::vec3(0,0,1));
-    
-    ProjectionMatrix = glm::perspective(glm::radians(g_fovDeg), 4.0f/3.0f, 0.1f, 100.0f);
+    // Nothing was held while asleep (the loop only sleeps when the camera
+    // stood still), so the next sample starts from now
+    g_lastSampleTime = glfwGetTime();
 }
@@ -1,14 +1,16 @@
 /*
 * Author: Liam Long
 * Class: ECE4122 (Lab 3)
-* Last Date Modified: 2025-10-18
+* Last Date Modified: 2026-10-18
 *
 * Description / Purpose of this file:
 * Public interface for the orbit‑camera controls module. The renderer calls
 * `computeMatricesFromInputs()` once per frame to update camera state from
 * keyboard input, then retrieves the current view and projection matrices via
 * accessors. A lighting toggle flag is also exposed so the shader can enable
-* or disable diffuse/specular terms.
+* or disable diffuse/specular terms. For rendering on demand, the module also
+* reports whether a sample changed anything and lets the loop sleep until
+* the next key or window event.
 */
 
 #ifndef CONTROLS_HPP
@@ -25,9 +27,62 @@
 * Inputs:
 * None (reads from the GLFW window created in main.cpp).
 * Returns:
-* void (updates internal module state; call once per frame before rendering).
+* true if the camera or the lighting toggle changed since the last call
+* (call once per frame before rendering).
 */
-void computeMatricesFromInputs();
+bool computeMatricesFromInputs();
+
+/*
+* trackInputEvents()
+* ------------------------------------------------------------------
+* Purpose:
+* Install key and window-refresh callbacks on the window, so that
+* inputPending() and getInputEventTime() have something to report.
+*/
+void trackInputEvents();
+
+/*
+* waitForInput()
+* ------------------------------------------------------------------
+* Purpose:
+* Sleep until GLFW delivers any event or `timeoutSeconds` pass. The time
+* spent asleep is not integrated into the camera by the next
+* computeMatricesFromInputs().
+*/
+void waitForInput(double timeoutSeconds);
+
+/*
+* inputPending() / getInputEventTime()
+* ------------------------------------------------------------------
+* Purpose:
+* inputPending(): a key event or a window refresh request arrived since
+* the last computeMatricesFromInputs().
+* getInputEventTime(): glfwGetTime() at delivery of the first key press
+* the last computeMatricesFromInputs() took in, or -1 if none.
+*/
+bool inputPending();
+double getInputEventTime();
+
+/*
+* computeMatricesFromScript()
+* ------------------------------------------------------------------
+* Purpose:
+* Drive the same orbit parameters along a fixed, deterministic path
+* (benchmark mode) instead of reading the keyboard.
+* Inputs:
+* t - progress along the path in [0, 1]
+* sceneRadius - radius enclosing the scene; sets the orbit distance
+*/
+void computeMatricesFromScript(float t, float sceneRadius);
+
+/*
+* setAspectRatio() / setSceneRadius()
+* ------------------------------------------------------------------
+* Purpose: Adapt the projection to the viewport (width / height) and
+* push the far plane out for scenes larger than the lab ring.
+*/
+void setAspectRatio(float aspect);
+void setSceneRadius(float radius);
 
 /*
 * getViewMatrix()
@@ -46,6 +101,14 @@ glm::mat4 getViewMatrix();
 */
 glm::mat4 getProjectionMatrix();
 
+/*
+* getCameraPosition()
+* ------------------------------------------------------------------
+* Purpose: Provide the eye point of the current view (LOD distances).
+* Returns: glm::vec3 camera position in world space.
+*/
+glm::vec3 getCameraPosition();
+
 /*
 * getEnableDiffuseSpec()
 * ------------------------------------------------------------------
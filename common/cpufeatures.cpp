@@ -0,0 +1,53 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* CPUID-based feature detection.
+*/
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#include "cpufeatures.hpp"
+
+/*
+* detectAvx2
+* ------------------------------------------------------------------
+* Purpose: Query CPUID for AVX2 + FMA and check that the OS saves the
+* YMM registers (OSXSAVE + XCR0 bits 1 and 2).
+*/
+static bool detectAvx2()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+    bool fma     = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx     = (info[2] & (1 << 28)) != 0;
+    if (!fma || !osxsave || !avx)
+    {
+        return false;
+    }
+    if ((_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+bool cpuSupportsAvx2()
+{
+    static const bool supported = detectAvx2();
+    return supported;
+}
@@ -0,0 +1,41 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Run-time CPU feature checks for the SIMD kernels.
+*
+* Each kernel lives in its own *_avx2.cpp file. On x86 CMakeLists.txt
+* builds those files with AVX2/FMA code generation, and each defines a
+* ...Avx2Compiled() query returning true; callers enter the kernel only
+* when that query and cpuSupportsAvx2() both hold, and run the scalar
+* version in the owning module otherwise. Without the flags (other
+* architectures) a file builds a stub instead: the query returns false and
+* the kernel, never called, just returns with its parameters unnamed.
+*/
+
+#ifndef CPUFEATURES_HPP
+#define CPUFEATURES_HPP
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// True if the CPU and OS support AVX2 and FMA3 (cached after the first call)
+bool cpuSupportsAvx2();
+
+// Index of the lowest set bit (mask != 0); the SIMD kernels walk their
+// movemask results with it
+inline unsigned int lowestBit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned int)index;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+#endif
@@ -0,0 +1,279 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Dynamic resolution target and its frame-time controller.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "shaderprogram.hpp"
+#include "glstate.hpp"
+#include "dynamicresolution.hpp"
+
+const unsigned int DynamicResolution::kQueryLatency;
+
+// Hysteresis band, as fractions of the budget: above kLowerAbove the scale
+// drops, below kRaiseBelow it grows, in between it holds. A change aims
+// for the middle of the band.
+static const double kLowerAbove = 0.95;
+static const double kRaiseBelow = 0.80;
+static const double kAim = 0.875;
+
+// Largest step per change: drop fast when over budget, grow cautiously
+static const float kMaxDrop = 0.70f;
+static const float kMaxRaise = 1.15f;
+
+// Scales are multiples of this, so noise can't cause tiny changes
+static const float kScaleQuantum = 1.0f / 40.0f;
+
+// Consecutive frames outside the band before the scale changes, and the
+// weight of each new frame in the smoothed time
+static const unsigned int kMinMeasured = 4;
+static const double kSmoothing = 0.25;
+
+DynamicResolution::DynamicResolution()
+    : m_width(0), m_height(0), m_samples(0), m_budgetMs(0.0), m_minScale(1.0f), m_scale(1.0f),
+      m_renderWidth(0), m_renderHeight(0), m_measured(0), m_over(0), m_under(0),
+      m_framebuffer(0), m_colorBuffer(0), m_depthBuffer(0), m_resolveFramebuffer(0), m_texture(0),
+      m_uvScaleHandle(-1), m_vao(0), m_frame(0)
+{
+    memset(m_queries, 0, sizeof(m_queries));
+    memset(m_queryScale, 0, sizeof(m_queryScale));
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+bool DynamicResolution::init(int width, int height, int samples, double budgetMs, float minScale,
+                             const char* vertex_file_path, const char* fragment_file_path)
+{
+    destroy();
+    m_width = width;
+    m_height = height;
+    m_samples = samples;
+    m_budgetMs = budgetMs;
+    m_minScale = std::min(std::max(minScale, kScaleQuantum), 1.0f);
+
+    if (!m_program.load(vertex_file_path, fragment_file_path))
+    {
+        printf("Dynamic resolution: cannot build the upscale program\n");
+        return false;
+    }
+    m_uvScaleHandle = m_program.uniform("UVScale");
+    m_program.use();
+    m_program.setInt(m_program.uniform("SceneTexture"), 0);
+    glGenVertexArrays(1, &m_vao);
+
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &m_depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, width, height);
+
+    // A multisampled scene is drawn into a renderbuffer and resolved 1:1
+    // into the texture; otherwise it is drawn into the texture directly
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    if (samples > 0)
+    {
+        glGenRenderbuffers(1, &m_colorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+    }
+    else
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+    }
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status == GL_FRAMEBUFFER_COMPLETE && samples > 0)
+    {
+        glGenFramebuffers(1, &m_resolveFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_resolveFramebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+        status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glsInvalidate();
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        printf("Dynamic resolution target %dx%d (%d samples) incomplete (0x%x)\n", width, height, samples, status);
+        destroy();
+        return false;
+    }
+
+    glGenQueries(2 * kQueryLatency, m_queries);
+    memset(m_queryScale, 0, sizeof(m_queryScale));
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_frame = 0;
+    setScale(1.0f);
+    m_stats.changes = 0;
+    return true;
+}
+
+void DynamicResolution::destroy()
+{
+    if (m_queries[0])
+    {
+        glDeleteQueries(2 * kQueryLatency, m_queries);
+        memset(m_queries, 0, sizeof(m_queries));
+    }
+    if (m_framebuffer)
+    {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        glDeleteFramebuffers(1, &m_resolveFramebuffer);
+        glDeleteRenderbuffers(1, &m_colorBuffer);
+        glDeleteRenderbuffers(1, &m_depthBuffer);
+        glDeleteTextures(1, &m_texture);
+        m_framebuffer = m_resolveFramebuffer = m_colorBuffer = m_depthBuffer = m_texture = 0;
+    }
+    if (m_vao)
+    {
+        glDeleteVertexArrays(1, &m_vao);
+        m_vao = 0;
+    }
+    m_program.destroy();
+    glsInvalidate();
+}
+
+void DynamicResolution::setScale(float scale)
+{
+    m_scale = scale;
+    m_renderWidth = std::max(1, int(float(m_width) * scale + 0.5f));
+    m_renderHeight = std::max(1, int(float(m_height) * scale + 0.5f));
+    m_measured = m_over = m_under = 0;
+    m_stats.changes++;
+}
+
+/*
+* collect
+* ------------------------------------------------------------------
+* Purpose: Read the timestamps of the frame that last used `slot`
+* (kQueryLatency frames ago) and feed the controller. A result that isn't
+* ready yet is dropped rather than waited for.
+*/
+void DynamicResolution::collect(unsigned int slot)
+{
+    const float measuredScale = m_queryScale[slot];
+    m_queryScale[slot] = 0.0f;
+    GLint available = 0;
+    glGetQueryObjectiv(m_queries[2 * slot + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        return;
+    }
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(m_queries[2 * slot], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(m_queries[2 * slot + 1], GL_QUERY_RESULT, &end);
+    adjust(double(end - begin) / 1.0e6, measuredScale);
+}
+
+/*
+* adjust
+* ------------------------------------------------------------------
+* Purpose: The controller. Frames rendered before the last change are
+* ignored. Once kMinMeasured frames in a row land on the same side of the
+* band, the scale whose pixel count (time ~ scale^2) would put the
+* smoothed time in the middle of the band is taken, limited to one step.
+*/
+void DynamicResolution::adjust(double gpuMs, float measuredScale)
+{
+    m_stats.gpuMs = gpuMs;
+    if (measuredScale != m_scale)
+    {
+        return;
+    }
+    m_stats.smoothedGpuMs = m_measured++ == 0 ? gpuMs :
+        m_stats.smoothedGpuMs + kSmoothing * (gpuMs - m_stats.smoothedGpuMs);
+    m_over = gpuMs > kLowerAbove * m_budgetMs ? m_over + 1 : 0;
+    m_under = gpuMs < kRaiseBelow * m_budgetMs ? m_under + 1 : 0;
+    if ((m_over < kMinMeasured && m_under < kMinMeasured) || m_stats.smoothedGpuMs <= 0.0)
+    {
+        return;
+    }
+
+    float target = m_scale * float(std::sqrt(kAim * m_budgetMs / m_stats.smoothedGpuMs));
+    if (m_over >= kMinMeasured)
+    {
+        target = std::min(std::max(target, m_scale * kMaxDrop), m_scale - kScaleQuantum);
+    }
+    else
+    {
+        target = std::max(std::min(target, m_scale * kMaxRaise), m_scale + kScaleQuantum);
+    }
+    target = std::floor(target / kScaleQuantum + 0.5f) * kScaleQuantum;
+    target = std::min(std::max(target, m_minScale), 1.0f);
+    if (target != m_scale)
+    {
+        setScale(target);
+    }
+}
+
+void DynamicResolution::beginFrame()
+{
+    const unsigned int slot = m_frame % kQueryLatency;
+    if (m_queryScale[slot] > 0.0f)
+    {
+        collect(slot);
+    }
+    glQueryCounter(m_queries[2 * slot], GL_TIMESTAMP);
+    m_queryScale[slot] = m_scale;
+
+    glsBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, m_renderWidth, m_renderHeight);
+
+    // Clearing the whole full-size target would cost the same at any scale
+    glsEnable(GL_SCISSOR_TEST);
+    glScissor(0, 0, m_renderWidth, m_renderHeight);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glsDisable(GL_SCISSOR_TEST);
+}
+
+void DynamicResolution::endFrame(GLuint framebuffer, int width, int height)
+{
+    if (m_resolveFramebuffer)
+    {
+        glsBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+        glsBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_resolveFramebuffer);
+        glBlitFramebuffer(0, 0, m_renderWidth, m_renderHeight, 0, 0, m_renderWidth, m_renderHeight,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    glsBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+
+    const bool depthWasEnabled = glsIsEnabled(GL_DEPTH_TEST);
+    glsDisable(GL_DEPTH_TEST);
+    m_program.use();
+    m_program.setVec4(m_uvScaleHandle, glm::vec4(
+        float(m_renderWidth) / float(m_width), float(m_renderHeight) / float(m_height),
+        (float(m_renderWidth) - 0.5f) / float(m_width), (float(m_renderHeight) - 0.5f) / float(m_height)));
+    glsActiveTexture(GL_TEXTURE0);
+    glsBindTexture(GL_TEXTURE_2D, m_texture);
+    glsBindVertexArray(m_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glsBindVertexArray(0);
+    if (depthWasEnabled)
+    {
+        glsEnable(GL_DEPTH_TEST);
+    }
+
+    glQueryCounter(m_queries[2 * (m_frame % kQueryLatency) + 1], GL_TIMESTAMP);
+    m_frame++;
+}
@@ -0,0 +1,111 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Dynamic resolution: the scene is rendered into an offscreen multisampled
+* target at a fraction of the output size, and the fraction follows the
+* GPU time the frames actually take against a budget (e.g. 16.6 ms).
+* The target is allocated once at full size and only its lower-left
+* scale x scale rectangle is drawn, so changing the scale costs nothing;
+* endFrame() resolves that rectangle into a texture and stretches it over
+* the output with a full-screen triangle (Upscale shaders, bilinear), after
+* which anything drawn (the HUD) is at native resolution. A shader is used
+* rather than a scaling glBlitFramebuffer, which some drivers run on a slow
+* path costing more than the pixels saved.
+*
+* GPU time is read from GL_TIMESTAMP pairs a few frames late (they nest
+* with the benchmark's GL_TIME_ELAPSED query). The controller holds the
+* scale while frames stay inside a band below the budget (hysteresis);
+* after several consecutive frames on one side of it, it jumps to the
+* scale the pixel count predicts from the smoothed time, limited per
+* step, so a single hitch changes nothing. After each change it waits
+* until the frames measured were all rendered at the new scale.
+*/
+
+#ifndef DYNAMICRESOLUTION_HPP
+#define DYNAMICRESOLUTION_HPP
+
+struct DynamicResolutionStats
+{
+    double       gpuMs;          // latest measured frame, GPU time
+    double       smoothedGpuMs;  // what the controller decides on
+    unsigned int changes;        // scale changes so far
+};
+
+class DynamicResolution
+{
+public:
+    static const unsigned int kQueryLatency = 4;
+
+    DynamicResolution();
+
+    /*
+    * init()
+    * ------------------------------------------------------------------
+    * Purpose: Create the `width` x `height` target with `samples` samples
+    * per pixel (0: none), the upscale program and the timer queries. The
+    * scale starts at 1 and stays within [minScale, 1].
+    * Returns: false if the shaders or the framebuffers cannot be built.
+    */
+    bool init(int width, int height, int samples, double budgetMs, float minScale,
+              const char* vertex_file_path, const char* fragment_file_path);
+    void destroy();
+
+    // Update the scale from the timing of an earlier frame, start timing,
+    // bind the target and set the viewport to the scaled rectangle, and
+    // clear just that rectangle (color and depth)
+    void beginFrame();
+
+    /*
+    * endFrame()
+    * ------------------------------------------------------------------
+    * Purpose: Resolve the scaled rectangle, upscale it to all of
+    * `framebuffer` (`width` x `height`, 0 = the window) and stop timing.
+    * The framebuffer is left bound with its viewport; the depth test is
+    * left as it was found.
+    */
+    void endFrame(GLuint framebuffer, int width, int height);
+
+    float scale() const { return m_scale; }
+    int renderWidth() const { return m_renderWidth; }
+    int renderHeight() const { return m_renderHeight; }
+    GLuint framebuffer() const { return m_framebuffer; }  // the scene's target between beginFrame() and endFrame()
+    const DynamicResolutionStats& stats() const { return m_stats; }
+
+private:
+    DynamicResolution(const DynamicResolution&);
+    DynamicResolution& operator=(const DynamicResolution&);
+
+    void collect(unsigned int slot);
+    void adjust(double gpuMs, float measuredScale);
+    void setScale(float scale);
+
+    int     m_width, m_height;
+    int     m_samples;
+    double  m_budgetMs;
+    float   m_minScale;
+    float   m_scale;
+    int     m_renderWidth, m_renderHeight;
+    unsigned int m_measured;         // frames timed at the current scale
+    unsigned int m_over, m_under;    // consecutive such frames above / below the band
+
+    GLuint  m_framebuffer;           // what the scene draws into
+    GLuint  m_colorBuffer;           // multisampled target only
+    GLuint  m_depthBuffer;
+    GLuint  m_resolveFramebuffer;    // multisampled target only
+    GLuint  m_texture;               // the scene color, or its single-sample copy
+
+    ShaderProgram  m_program;
+    UniformHandle  m_uvScaleHandle;
+    GLuint         m_vao;            // empty: the triangle comes from gl_VertexID
+
+    GLuint       m_queries[2 * kQueryLatency];  // begin / end timestamp per slot
+    float        m_queryScale[kQueryLatency];   // scale the slot's frame used, 0 = idle
+    unsigned int m_frame;
+
+    DynamicResolutionStats m_stats;
+};
+
+#endif
@@ -0,0 +1,239 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Entity store: archetype lookup, row insertion / swap-removal and chunked
+* queries.
+*/
+
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "workerpool.hpp"
+#include "entitystore.hpp"
+
+static const unsigned int kNoArchetype = ~0u;
+
+const unsigned int EntityStore::kChunkSize;
+
+EntityStore::EntityStore()
+    : m_alive(0)
+{
+}
+
+Archetype& EntityStore::getArchetype(unsigned int components, unsigned int* index)
+{
+    for (size_t a = 0; a < m_archetypes.size(); a++)
+    {
+        if (m_archetypes[a].components == components)
+        {
+            *index = (unsigned int)a;
+            return m_archetypes[a];
+        }
+    }
+    m_archetypes.push_back(Archetype());
+    Archetype& archetype = m_archetypes.back();
+    archetype.components = components;
+    archetype.count = 0;
+    archetype.transforms.count = 0;
+    archetype.bounds.count = 0;
+    *index = (unsigned int)m_archetypes.size() - 1;
+    return archetype;
+}
+
+Archetype* EntityStore::findArchetype(unsigned int components)
+{
+    for (size_t a = 0; a < m_archetypes.size(); a++)
+    {
+        if (m_archetypes[a].components == components)
+        {
+            return &m_archetypes[a];
+        }
+    }
+    return NULL;
+}
+
+void EntityStore::reserve(unsigned int components, unsigned int count)
+{
+    unsigned int index;
+    Archetype& a = getArchetype(components, &index);
+    unsigned int rows = a.count + count;
+    a.entities.reserve(rows);
+    if (components & COMPONENT_TRANSFORM)
+    {
+        a.transforms.x.reserve(rows);
+        a.transforms.y.reserve(rows);
+        a.transforms.z.reserve(rows);
+        a.transforms.yaw.reserve(rows);
+        a.transforms.scale.reserve(rows);
+        a.nodes.reserve(rows);
+    }
+    if (components & COMPONENT_BOUNDS)
+    {
+        unsigned int padded = (rows + 7) & ~7u;
+        a.bounds.x.reserve(padded);
+        a.bounds.y.reserve(padded);
+        a.bounds.z.reserve(padded);
+        a.bounds.r.reserve(padded);
+    }
+    if (components & COMPONENT_MESH)     { a.meshes.reserve(rows); }
+    if (components & COMPONENT_MATERIAL) { a.materials.reserve(rows); }
+    if (components & COMPONENT_LOD)      { a.lods.reserve(rows); }
+    m_locations.reserve(m_locations.size() + count);
+}
+
+Entity EntityStore::create(const EntityDesc& desc)
+{
+    unsigned int index;
+    Archetype& a = getArchetype(desc.components, &index);
+
+    Entity entity;
+    if (!m_free.empty())
+    {
+        entity = m_free.back();
+        m_free.pop_back();
+    }
+    else
+    {
+        entity = (Entity)m_locations.size();
+        m_locations.push_back(Location());
+    }
+    m_locations[entity].archetype = index;
+    m_locations[entity].row = a.count;
+
+    a.entities.push_back(entity);
+    if (desc.components & COMPONENT_TRANSFORM)
+    {
+        a.transforms.x.push_back(desc.placement.x);
+        a.transforms.y.push_back(desc.placement.y);
+        a.transforms.z.push_back(desc.placement.z);
+        a.transforms.yaw.push_back(desc.placement.w);
+        a.transforms.scale.push_back(desc.scale);
+        a.transforms.count = a.count + 1;
+        a.nodes.push_back(desc.node);
+    }
+    if (desc.components & COMPONENT_BOUNDS)
+    {
+        // Keep the padding: rows past `count` up to a multiple of 8 never pass
+        unsigned int padded = (a.count + 1 + 7) & ~7u;
+        a.bounds.x.resize(padded, 0.0f);
+        a.bounds.y.resize(padded, 0.0f);
+        a.bounds.z.resize(padded, 0.0f);
+        a.bounds.r.resize(padded, -1e30f);
+        a.bounds.x[a.count] = desc.sphere.x;
+        a.bounds.y[a.count] = desc.sphere.y;
+        a.bounds.z[a.count] = desc.sphere.z;
+        a.bounds.r[a.count] = desc.sphere.w;
+        a.bounds.count = a.count + 1;
+    }
+    if (desc.components & COMPONENT_MESH)     { a.meshes.push_back(desc.mesh); }
+    if (desc.components & COMPONENT_MATERIAL) { a.materials.push_back(desc.material); }
+    if (desc.components & COMPONENT_LOD)      { a.lods.push_back(desc.lod); }
+    a.count++;
+    m_alive++;
+    return entity;
+}
+
+// Move element `from` onto `to` and drop the last element
+template <class T>
+static void swapRemove(AlignedVector<T>& column, unsigned int to, unsigned int from)
+{
+    column[to] = column[from];
+    column.pop_back();
+}
+
+void EntityStore::destroy(Entity entity)
+{
+    if (!alive(entity))
+    {
+        printf("EntityStore::destroy: entity %u is not alive\n", entity);
+        return;
+    }
+    Location location = m_locations[entity];
+    Archetype& a = m_archetypes[location.archetype];
+    unsigned int last = a.count - 1;
+    unsigned int row = location.row;
+
+    // The last row fills the hole
+    Entity moved = a.entities[last];
+    swapRemove(a.entities, row, last);
+    if (a.components & COMPONENT_TRANSFORM)
+    {
+        swapRemove(a.transforms.x, row, last);
+        swapRemove(a.transforms.y, row, last);
+        swapRemove(a.transforms.z, row, last);
+        swapRemove(a.transforms.yaw, row, last);
+        swapRemove(a.transforms.scale, row, last);
+        swapRemove(a.nodes, row, last);
+        a.transforms.count = last;
+    }
+    if (a.components & COMPONENT_BOUNDS)
+    {
+        a.bounds.x[row] = a.bounds.x[last];
+        a.bounds.y[row] = a.bounds.y[last];
+        a.bounds.z[row] = a.bounds.z[last];
+        a.bounds.r[row] = a.bounds.r[last];
+        a.bounds.r[last] = -1e30f;
+        unsigned int padded = (last + 7) & ~7u;
+        a.bounds.x.resize(padded);
+        a.bounds.y.resize(padded);
+        a.bounds.z.resize(padded);
+        a.bounds.r.resize(padded);
+        a.bounds.count = last;
+    }
+    if (a.components & COMPONENT_MESH)     { swapRemove(a.meshes, row, last); }
+    if (a.components & COMPONENT_MATERIAL) { swapRemove(a.materials, row, last); }
+    if (a.components & COMPONENT_LOD)      { swapRemove(a.lods, row, last); }
+    a.count = last;
+
+    m_locations[moved].row = row;
+    m_locations[entity].archetype = kNoArchetype;
+    m_free.push_back(entity);
+    m_alive--;
+}
+
+bool EntityStore::alive(Entity entity) const
+{
+    return entity < m_locations.size() && m_locations[entity].archetype != kNoArchetype;
+}
+
+Archetype& EntityStore::archetypeOf(Entity entity, unsigned int* row)
+{
+    *row = m_locations[entity].row;
+    return m_archetypes[m_locations[entity].archetype];
+}
+
+void EntityStore::queryChunks(unsigned int required, unsigned int excluded, std::vector<EntityChunk>& chunks)
+{
+    chunks.clear();
+    for (size_t a = 0; a < m_archetypes.size(); a++)
+    {
+        Archetype& archetype = m_archetypes[a];
+        if ((archetype.components & required) != required || (archetype.components & excluded) != 0)
+        {
+            continue;
+        }
+        for (unsigned int first = 0; first < archetype.count; first += kChunkSize)
+        {
+            EntityChunk chunk;
+            chunk.archetype = &archetype;
+            chunk.first = first;
+            chunk.count = std::min(kChunkSize, archetype.count - first);
+            chunks.push_back(chunk);
+        }
+    }
+}
+
+void EntityStore::parallelForChunks(WorkerPool& pool, const std::vector<EntityChunk>& chunks,
+                                    const std::function<void(unsigned int, const EntityChunk&, unsigned int)>& fn)
+{
+    pool.parallelFor((unsigned int)chunks.size(), [&](unsigned int c, unsigned int worker)
+    {
+        fn(c, chunks[c], worker);
+    });
+}
@@ -0,0 +1,136 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Archetype-based entity store. An entity is a handle; its components live
+* in the archetype for its exact component set, one structure-of-arrays
+* column per field (the transform columns are a TransformSoA and the
+* bounds a padded SphereSoA, so the SIMD kernels run on them directly).
+* Rows are kept dense: destroying an entity moves the archetype's last row
+* into the hole.
+*
+* Systems query the archetypes that have the components they need and
+* walk them in chunks of kChunkSize rows. Columns start on a cache line
+* and chunks are a multiple of 16 rows, so a chunk of any 4-byte column
+* covers whole cache lines and workers handed different chunks never
+* share one. A system touches only the columns it reads.
+*/
+
+#ifndef ENTITYSTORE_HPP
+#define ENTITYSTORE_HPP
+
+#include <vector>
+#include <deque>
+#include <functional>
+
+#include "alignedvector.hpp"
+#include "frustum.hpp"
+#include "transform.hpp"
+
+class WorkerPool;
+
+typedef unsigned int Entity;
+
+enum ComponentBits
+{
+    COMPONENT_TRANSFORM = 1 << 0,  // position, yaw, scale and transform hierarchy node
+    COMPONENT_BOUNDS    = 1 << 1,  // world bounding sphere
+    COMPONENT_MESH      = 1 << 2,  // index into the caller's mesh table
+    COMPONENT_MATERIAL  = 1 << 3,  // index into the caller's material table
+    COMPONENT_LOD       = 1 << 4   // selected level of detail (written by LOD selection)
+};
+
+// Initial component values for create(); fields of absent components are ignored
+struct EntityDesc
+{
+    unsigned int components;   // ComponentBits
+    glm::vec4    placement;    // TRANSFORM: xyz position, w yaw
+    float        scale;        // TRANSFORM
+    unsigned int node;         // TRANSFORM: transform hierarchy node
+    glm::vec4    sphere;       // BOUNDS: xyz center, w radius
+    unsigned int mesh;         // MESH
+    unsigned int material;     // MATERIAL
+    unsigned int lod;          // LOD
+};
+
+// Every entity with one exact component set; row r of each column belongs
+// to entities[r]. Columns of absent components stay empty.
+struct Archetype
+{
+    unsigned int                components;
+    unsigned int                count;
+    AlignedVector<Entity>       entities;
+    TransformSoA                transforms;   // TRANSFORM
+    AlignedVector<unsigned int> nodes;        // TRANSFORM
+    SphereSoA                   bounds;       // BOUNDS, padded to a multiple of 8
+    AlignedVector<unsigned int> meshes;       // MESH
+    AlignedVector<unsigned int> materials;    // MATERIAL
+    AlignedVector<unsigned int> lods;         // LOD
+};
+
+// Rows [first, first + count) of one archetype
+struct EntityChunk
+{
+    Archetype*   archetype;
+    unsigned int first;
+    unsigned int count;
+};
+
+class EntityStore
+{
+public:
+    // Rows per chunk: a multiple of 16 (cache-line granularity of 4-byte
+    // columns) and of 8 (the SIMD culling groups)
+    static const unsigned int kChunkSize = 1024;
+
+    EntityStore();
+
+    // Make room for `count` more entities with this component set
+    void reserve(unsigned int components, unsigned int count);
+
+    Entity create(const EntityDesc& desc);
+    void destroy(Entity entity);
+    bool alive(Entity entity) const;
+    unsigned int entityCount() const { return m_alive; }
+
+    // Where an entity's components are (valid until the next create/destroy)
+    Archetype& archetypeOf(Entity entity, unsigned int* row);
+
+    // The archetype with exactly this component set, or NULL
+    Archetype* findArchetype(unsigned int components);
+
+    /*
+    * queryChunks()
+    * ------------------------------------------------------------------
+    * Purpose: Replace `chunks` with the chunks of every non-empty
+    * archetype that has all `required` components and none of
+    * `excluded`, archetype by archetype in row order.
+    */
+    void queryChunks(unsigned int required, unsigned int excluded, std::vector<EntityChunk>& chunks);
+
+    // fn(i, chunks[i], worker) for every chunk, spread over the pool; `i`
+    // lets each chunk write its own output slot
+    static void parallelForChunks(WorkerPool& pool, const std::vector<EntityChunk>& chunks,
+                                  const std::function<void(unsigned int, const EntityChunk&, unsigned int)>& fn);
+
+private:
+    EntityStore(const EntityStore&);
+    EntityStore& operator=(const EntityStore&);
+
+    struct Location
+    {
+        unsigned int archetype;  // index into m_archetypes, ~0u when free
+        unsigned int row;
+    };
+
+    Archetype& getArchetype(unsigned int components, unsigned int* index);
+
+    std::deque<Archetype>     m_archetypes;  // deque: pointers stay valid as it grows
+    std::vector<Location>     m_locations;   // [entity]
+    std::vector<Entity>       m_free;        // destroyed handles for reuse
+    unsigned int              m_alive;
+};
+
+#endif
@@ -0,0 +1,477 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the pixel-pack ring, the encoder thread and the BMP /
+* PNG / raw writers.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "glstate.hpp"
+#include "clock.hpp"
+#include "profiler.hpp"
+#include "framecapture.hpp"
+
+const unsigned int FrameCapture::kRingSize;
+
+bool parseCaptureFormat(const char* name, CaptureFormat& format)
+{
+    if (strcmp(name, "bmp") == 0)      { format = CAPTURE_BMP; }
+    else if (strcmp(name, "png") == 0) { format = CAPTURE_PNG; }
+    else if (strcmp(name, "raw") == 0) { format = CAPTURE_RAW; }
+    else { return false; }
+    return true;
+}
+
+FrameCapture::FrameCapture()
+    : m_width(0), m_height(0), m_frameBytes(0), m_format(CAPTURE_BMP), m_rawFile(NULL), m_next(0),
+      m_handedOff(0), m_delaySum(0), m_quit(false), m_writeFailed(false)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    for (unsigned int s = 0; s < kRingSize; s++)
+    {
+        m_slots[s].buffer = 0;
+        m_slots[s].fence = 0;
+        m_slots[s].frame = 0;
+        m_slots[s].issued = 0;
+        m_slots[s].state = SLOT_FREE;
+        m_slots[s].mapped = NULL;
+        m_slots[s].pixels = NULL;
+    }
+}
+
+FrameCapture::~FrameCapture()
+{
+    shutdown();
+}
+
+bool FrameCapture::init(int width, int height, CaptureFormat format, const std::string& prefix)
+{
+    shutdown();
+    m_frameBytes = size_t(width) * size_t(height) * 4;
+    m_format = format;
+    m_prefix = prefix;
+    if (format == CAPTURE_RAW)
+    {
+        std::string path = prefix + ".raw";
+        m_rawFile = fopen(path.c_str(), "wb");
+        if (!m_rawFile)
+        {
+            printf("Impossible to write %s\n", path.c_str());
+            return false;
+        }
+    }
+
+    // Readback targets; persistently mapped when the driver allows it
+    const bool persistent = GLEW_ARB_buffer_storage != 0;
+    for (unsigned int s = 0; s < kRingSize; s++)
+    {
+        Slot& slot = m_slots[s];
+        glGenBuffers(1, &slot.buffer);
+        glsBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        if (persistent)
+        {
+            GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_PACK_BUFFER, m_frameBytes, NULL, flags);
+            slot.mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_frameBytes, flags);
+        }
+        else
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, m_frameBytes, NULL, GL_STREAM_READ);
+        }
+        slot.state = SLOT_FREE;
+    }
+    glsBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_width = width;
+    m_height = height;
+    m_next = 0;
+    m_handedOff = 0;
+    m_delaySum = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_quit = false;
+    m_writeFailed = false;
+    m_thread = std::thread(&FrameCapture::encoderMain, this);
+    printf("Capturing %dx%d frames to %s%s (%s readback)\n", width, height, prefix.c_str(),
+        format == CAPTURE_BMP ? "_*.bmp" : format == CAPTURE_PNG ? "_*.png" : ".raw",
+        m_slots[0].mapped ? "persistent" : "mapped");
+    return true;
+}
+
+void FrameCapture::capture(unsigned int frameIndex)
+{
+    if (!active())
+    {
+        return;
+    }
+    PROFILE_SCOPE("capture");
+    poll();
+
+    // Every slot busy: finish the oldest read and/or wait for the encoder
+    Slot& slot = m_slots[m_next];
+    if (slot.state != SLOT_FREE)
+    {
+        double start = clockSeconds();
+        if (slot.state == SLOT_READING)
+        {
+            glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(-1));
+            handOff(slot);
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (slot.state != SLOT_FREE)
+        {
+            m_released.wait(lock);
+        }
+        m_stats.stalls++;
+        m_stats.stallMs += (clockSeconds() - start) * 1000.0;
+    }
+
+    // Asynchronous: with a pack buffer bound the read only queues a copy.
+    // BGRA is the layout drivers read back without conversion.
+    glsBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glReadPixels(0, 0, m_width, m_height, GL_BGRA, GL_UNSIGNED_BYTE, (void*)0);
+    glsBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = frameIndex;
+    slot.issued = m_stats.captured++;
+    slot.state = SLOT_READING;
+    m_next = (m_next + 1) % kRingSize;
+}
+
+void FrameCapture::poll()
+{
+    // Oldest read first; fences signal in order, so stop at the first
+    // one still pending
+    for (unsigned int k = 0; k < kRingSize; k++)
+    {
+        Slot& slot = m_slots[(m_next + k) % kRingSize];
+        if (slot.state != SLOT_READING)
+        {
+            continue;
+        }
+        GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+        handOff(slot);
+    }
+}
+
+/*
+* handOff
+* ------------------------------------------------------------------
+* Purpose: Give a slot whose read has completed to the encoder. A
+* persistently mapped slot is read in place; otherwise it is mapped now
+* (no wait: the fence has signaled) and copied out.
+*/
+void FrameCapture::handOff(Slot& slot)
+{
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+    m_delaySum += m_stats.captured - slot.issued;
+    m_handedOff++;
+
+    if (slot.mapped)
+    {
+        slot.pixels = slot.mapped;
+    }
+    else
+    {
+        slot.pixels = NULL;
+        glsBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_frameBytes, GL_MAP_READ_BIT);
+        if (data)
+        {
+            slot.copy.resize(m_frameBytes);
+            memcpy(&slot.copy[0], data, m_frameBytes);
+            slot.pixels = &slot.copy[0];
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glsBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    slot.state = SLOT_ENCODING;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back((unsigned int)(&slot - m_slots));
+    }
+    m_queued.notify_one();
+}
+
+void FrameCapture::shutdown()
+{
+    if (!active())
+    {
+        return;
+    }
+
+    // Finish the reads still in flight, oldest first
+    for (unsigned int k = 0; k < kRingSize; k++)
+    {
+        Slot& slot = m_slots[(m_next + k) % kRingSize];
+        if (slot.state == SLOT_READING)
+        {
+            glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(-1));
+            handOff(slot);
+        }
+    }
+
+    // The encoder drains its queue before it exits
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_queued.notify_one();
+    m_thread.join();
+
+    for (unsigned int s = 0; s < kRingSize; s++)
+    {
+        Slot& slot = m_slots[s];
+        if (slot.mapped)
+        {
+            glsBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            slot.mapped = NULL;
+        }
+        glDeleteBuffers(1, &slot.buffer);
+        slot.buffer = 0;
+        slot.pixels = NULL;
+        std::vector<unsigned char>().swap(slot.copy);
+    }
+    glsBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (m_rawFile)
+    {
+        fclose(m_rawFile);
+        m_rawFile = NULL;
+    }
+    m_width = 0;
+    m_height = 0;
+}
+
+CaptureStats FrameCapture::stats()
+{
+    CaptureStats stats = m_stats;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stats.written = m_stats.written;
+    }
+    stats.meanDelay = m_handedOff > 0 ? double(m_delaySum) / m_handedOff : 0.0;
+    return stats;
+}
+
+void FrameCapture::encoderMain()
+{
+    profilerSetThreadName("capture encoder");
+    for (;;)
+    {
+        unsigned int index;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_quit && m_jobs.empty())
+            {
+                m_queued.wait(lock);
+            }
+            if (m_jobs.empty())
+            {
+                return;
+            }
+            index = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        encode(m_slots[index]);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_slots[index].state = SLOT_FREE;
+            m_stats.written++;
+        }
+        m_released.notify_one();
+    }
+}
+
+static void putLE16(unsigned char* p, unsigned int v) { p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8); }
+static void putLE32(unsigned char* p, unsigned int v) { putLE16(p, v); putLE16(p + 2, v >> 16); }
+static void putBE32(unsigned char* p, unsigned int v)
+{
+    p[0] = (unsigned char)(v >> 24); p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);  p[3] = (unsigned char)v;
+}
+
+static unsigned int crc32(unsigned int crc, const unsigned char* data, size_t length)
+{
+    static unsigned int table[256];
+    static bool tableReady = false;  // only the encoder thread gets here
+    if (!tableReady)
+    {
+        for (unsigned int n = 0; n < 256; n++)
+        {
+            unsigned int c = n;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static bool writePngChunk(FILE* file, const char* type, const unsigned char* data, size_t length)
+{
+    unsigned char header[8];
+    putBE32(header, (unsigned int)length);
+    memcpy(header + 4, type, 4);
+    unsigned int crc = crc32(crc32(0, header + 4, 4), data, length);
+    unsigned char trailer[4];
+    putBE32(trailer, crc);
+    return fwrite(header, 8, 1, file) == 1 &&
+           (length == 0 || fwrite(data, length, 1, file) == 1) &&
+           fwrite(trailer, 4, 1, file) == 1;
+}
+
+/*
+* writePng
+* ------------------------------------------------------------------
+* Purpose: Write bottom-up BGRA pixels as an RGB PNG. The zlib stream uses
+* stored (uncompressed) deflate blocks: files are larger than a real
+* encoder's but cost only a copy, which keeps up with full-rate capture.
+*/
+static bool writePng(FILE* file, const unsigned char* pixels, int width, int height,
+                     std::vector<unsigned char>& buffer)
+{
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    unsigned char ihdr[13];
+    putBE32(ihdr, (unsigned int)width);
+    putBE32(ihdr + 4, (unsigned int)height);
+    ihdr[8] = 8;    // bits per channel
+    ihdr[9] = 2;    // RGB
+    ihdr[10] = 0;   // deflate
+    ihdr[11] = 0;   // adaptive filtering (every row uses filter 0)
+    ihdr[12] = 0;   // not interlaced
+
+    // Scanlines, top row first: filter byte, then RGB
+    const size_t rowBytes = 1 + size_t(width) * 3;
+    const size_t rawBytes = rowBytes * size_t(height);
+    const size_t kBlock = 65535;
+    const size_t blocks = (rawBytes + kBlock - 1) / kBlock;
+    buffer.resize(rawBytes + 2 + blocks * 5 + 4);
+    unsigned char* raw = &buffer[buffer.size() - rawBytes];  // scanlines at the end, zlib stream written over them from the front
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* src = pixels + size_t(height - 1 - y) * size_t(width) * 4;
+        unsigned char* dst = raw + size_t(y) * rowBytes;
+        *dst++ = 0;
+        for (int x = 0; x < width; x++, src += 4, dst += 3)
+        {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+        }
+    }
+
+    // Adler-32 of the uncompressed data (before it is overwritten)
+    unsigned int a = 1, b = 0;
+    for (size_t i = 0; i < rawBytes; )
+    {
+        size_t end = i + 5552 < rawBytes ? i + 5552 : rawBytes;  // no overflow before the modulo
+        for (; i < end; i++)
+        {
+            a += raw[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+
+    // zlib header, stored blocks, checksum. Each block header adds 5 bytes
+    // ahead of its data, so the output never overtakes the unread input.
+    unsigned char* out = &buffer[0];
+    *out++ = 0x78;
+    *out++ = 0x01;
+    for (size_t offset = 0; offset < rawBytes; offset += kBlock)
+    {
+        size_t length = rawBytes - offset < kBlock ? rawBytes - offset : kBlock;
+        out[0] = offset + length == rawBytes ? 1 : 0;
+        putLE16(out + 1, (unsigned int)length);
+        putLE16(out + 3, (unsigned int)(~length & 0xFFFF));
+        memmove(out + 5, raw + offset, length);
+        out += 5 + length;
+    }
+    putBE32(out, (b << 16) | a);
+    out += 4;
+
+    return fwrite(signature, 8, 1, file) == 1 &&
+           writePngChunk(file, "IHDR", ihdr, sizeof(ihdr)) &&
+           writePngChunk(file, "IDAT", &buffer[0], size_t(out - &buffer[0])) &&
+           writePngChunk(file, "IEND", NULL, 0);
+}
+
+// 32-bit BMP: rows bottom-up in BGRA, exactly what the GPU read back
+static bool writeBmp(FILE* file, const unsigned char* pixels, int width, int height, size_t bytes)
+{
+    unsigned char header[54];
+    memset(header, 0, sizeof(header));
+    header[0] = 'B';
+    header[1] = 'M';
+    putLE32(header + 2, (unsigned int)(54 + bytes));  // file size
+    putLE32(header + 10, 54);                         // pixel data offset
+    putLE32(header + 14, 40);                         // BITMAPINFOHEADER
+    putLE32(header + 18, (unsigned int)width);
+    putLE32(header + 22, (unsigned int)height);       // positive: bottom-up
+    putLE16(header + 26, 1);                          // planes
+    putLE16(header + 28, 32);                         // bits per pixel
+    putLE32(header + 34, (unsigned int)bytes);
+    putLE32(header + 38, 2835);                       // 72 dpi
+    putLE32(header + 42, 2835);
+    return fwrite(header, sizeof(header), 1, file) == 1 && fwrite(pixels, bytes, 1, file) == 1;
+}
+
+void FrameCapture::encode(const Slot& slot)
+{
+    PROFILE_SCOPE("encode frame");
+    if (!slot.pixels)
+    {
+        return;
+    }
+    if (m_format == CAPTURE_RAW)
+    {
+        if (fwrite(slot.pixels, m_frameBytes, 1, m_rawFile) != 1 && !m_writeFailed)
+        {
+            printf("Capture: writing %s.raw failed\n", m_prefix.c_str());
+            m_writeFailed = true;
+        }
+        return;
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s_%06u.%s", m_prefix.c_str(), slot.frame, m_format == CAPTURE_PNG ? "png" : "bmp");
+    FILE* file = fopen(path, "wb");
+    bool ok = file != NULL;
+    if (ok)
+    {
+        ok = m_format == CAPTURE_PNG ? writePng(file, slot.pixels, m_width, m_height, m_encodeBuffer)
+                                     : writeBmp(file, slot.pixels, m_width, m_height, m_frameBytes);
+        ok = fclose(file) == 0 && ok;
+    }
+    if (!ok && !m_writeFailed)
+    {
+        printf("Capture: impossible to write %s\n", path);
+        m_writeFailed = true;
+    }
+}
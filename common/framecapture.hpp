@@ -0,0 +1,132 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Pipelined frame capture. capture() only queues a glReadPixels into one
+* of a ring of pixel-pack buffers and drops a fence behind it; the copy
+* runs on the GPU while the next frames are built. A slot whose fence has
+* signaled (normally one or two frames later) is handed to an encoder
+* thread that writes it as BMP, PNG or a raw frame sequence. The render
+* thread waits only when every slot is still busy, which is counted.
+*
+* With GL 4.4 / ARB_buffer_storage the buffers stay persistently mapped
+* and the encoder reads them in place; otherwise the render thread maps a
+* finished buffer and copies it out (no GPU wait either way).
+*/
+
+#ifndef FRAMECAPTURE_HPP
+#define FRAMECAPTURE_HPP
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+enum CaptureFormat
+{
+    CAPTURE_BMP,  // <prefix>_NNNNNN.bmp, 32-bit BGRA
+    CAPTURE_PNG,  // <prefix>_NNNNNN.png, RGB, uncompressed deflate
+    CAPTURE_RAW   // every frame appended to <prefix>.raw, BGRA, bottom row first
+};
+
+// "bmp", "png" or "raw"; returns false for anything else
+bool parseCaptureFormat(const char* name, CaptureFormat& format);
+
+struct CaptureStats
+{
+    unsigned int captured;      // reads issued
+    unsigned int written;       // frames encoded
+    unsigned int stalls;        // capture() calls that had to wait for a slot
+    double       stallMs;       // render-thread time spent in those waits
+    double       meanDelay;     // frames between a read and its hand-off
+};
+
+class FrameCapture
+{
+public:
+    static const unsigned int kRingSize = 3;
+
+    FrameCapture();
+    ~FrameCapture();
+
+    /*
+    * init()
+    * ------------------------------------------------------------------
+    * Purpose: Allocate the pixel-pack ring for width x height frames and
+    * start the encoder thread.
+    * Returns: false if the raw output file cannot be created.
+    */
+    bool init(int width, int height, CaptureFormat format, const std::string& prefix);
+
+    // Queue a read of the bound read framebuffer as frame `frameIndex`
+    void capture(unsigned int frameIndex);
+
+    // Hand every finished read to the encoder (capture() does this too)
+    void poll();
+
+    // Wait for the outstanding reads and encodes, stop the thread and
+    // release the buffers
+    void shutdown();
+
+    bool active() const { return m_width > 0; }
+    CaptureStats stats();
+
+private:
+    FrameCapture(const FrameCapture&);
+    FrameCapture& operator=(const FrameCapture&);
+
+    enum SlotState
+    {
+        SLOT_FREE,      // may be read into
+        SLOT_READING,   // GPU copy in flight, fence pending
+        SLOT_ENCODING   // owned by the encoder thread
+    };
+
+    struct Slot
+    {
+        GLuint                     buffer;
+        GLsync                     fence;
+        unsigned int               frame;
+        unsigned int               issued;   // m_stats.captured when the read was queued
+        std::atomic<int>           state;
+        unsigned char*             mapped;   // persistent mapping, or NULL
+        const unsigned char*       pixels;   // what the encoder reads
+        std::vector<unsigned char> copy;     // filled from a transient map when not persistent
+    };
+
+    void handOff(Slot& slot);
+    void encoderMain();
+    void encode(const Slot& slot);
+
+    int           m_width;
+    int           m_height;
+    size_t        m_frameBytes;
+    CaptureFormat m_format;
+    std::string   m_prefix;
+    FILE*         m_rawFile;
+
+    Slot          m_slots[kRingSize];
+    unsigned int  m_next;           // slot for the next read (also the oldest one)
+    CaptureStats  m_stats;          // `written` is updated under m_mutex
+    unsigned int  m_handedOff;
+    unsigned long long m_delaySum;
+
+    std::thread              m_thread;
+    std::mutex               m_mutex;
+    std::condition_variable  m_queued;     // encoder: jobs or quit
+    std::condition_variable  m_released;   // render thread: a slot became free
+    std::deque<unsigned int> m_jobs;       // slot indices in frame order
+    bool                     m_quit;
+
+    // Encoder-thread only
+    std::vector<unsigned char> m_encodeBuffer;  // PNG scanlines and zlib stream
+    bool                       m_writeFailed;
+};
+
+#endif
@@ -0,0 +1,546 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Frame preparation pipeline: chunked culling, occlusion, transforms and
+* packet generation, optionally one frame ahead on its own thread.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "frustum.hpp"
+#include "uniformblocks.hpp"
+#include "occlusion.hpp"
+#include "transform.hpp"
+#include "transformhierarchy.hpp"
+#include "profiler.hpp"
+#include "frameprep.hpp"
+
+// Visible rows per task; a multiple of 8 so chunks start on SIMD groups
+static const unsigned int kChunkSize = EntityStore::kChunkSize;
+
+// Spin of the animated heads, radians per second
+static const float kSpinRate = 1.0f;
+
+// Distance classes of the instanced heads' front-to-back order; early-Z
+// only needs roughly nearest first
+static const unsigned int kDepthBuckets = 256;
+
+// Normalized depth of a world point for the sort key (0 behind the camera)
+static float depth01(const glm::mat4& viewProj, const glm::vec3& p)
+{
+    glm::vec4 clip = viewProj * glm::vec4(p, 1.0f);
+    return clip.w > 0.0f ? clip.z / clip.w * 0.5f + 0.5f : 0.0f;
+}
+
+// LOD of a bounded entity on the per-object path: same distance rule as
+// the GPU-driven path. Instanced heads and entities without a LOD
+// component always draw LOD 0.
+static unsigned int entityLod(const Archetype& a, unsigned int row, const SceneMesh& mesh,
+                              const glm::vec3& cameraPosition, HeadSubmission submission)
+{
+    if (submission != HEADS_PER_OBJECT || (a.components & COMPONENT_LOD) == 0)
+    {
+        return 0;
+    }
+    glm::vec3 center(a.bounds.x[row], a.bounds.y[row], a.bounds.z[row]);
+    return selectMeshLod(glm::length(center - cameraPosition) / a.bounds.r[row], (unsigned int)mesh.lods.size());
+}
+
+// Packet drawing one LOD of a mesh with a material, reading block `slot`
+static DrawPacket entityPacket(const SceneMaterial& material, const SceneMesh& mesh, unsigned int lod,
+                               unsigned int slot, float depth, SortOrder order)
+{
+    const MeshLod& range = mesh.lods[lod];
+    DrawPacket packet = DrawPacket();
+    packet.program = material.program;
+    packet.texture = material.texture;
+    packet.vao = mesh.vao;
+    packet.renderState = material.renderState;
+    packet.uniformSlot = slot;
+    packet.indexCount = (GLsizei)range.indexCount;
+    packet.indexType = mesh.indexType;
+    packet.indexOffset = (const void*)(size_t(range.firstIndex) *
+                                       (mesh.indexType == GL_UNSIGNED_SHORT ? 2 : 4));
+    packet.instanceCount = 1;
+    packet.key = RenderQueue::makeKey(PASS_OPAQUE, packet.program, packet.texture, packet.vao,
+                                      packet.renderState, depth, order);
+    return packet;
+}
+
+DrawPacket splitDepthPrepass(DrawPacket& packet, GLuint depthProgram, GLuint depthVao, float depth01)
+{
+    // Same texture and block as the shading half, so switching passes
+    // rebinds neither
+    DrawPacket depthOnly = packet;
+    depthOnly.program = depthProgram;
+    depthOnly.vao = depthVao;
+    depthOnly.renderState = packet.renderState | RS_DEPTH_ONLY;
+    depthOnly.key = RenderQueue::makeKey(PASS_DEPTH_PREPASS, depthOnly.program, depthOnly.texture, depthOnly.vao,
+                                         depthOnly.renderState, depth01);
+
+    packet.renderState |= RS_DEPTH_EQUAL;
+    packet.key = RenderQueue::makeKey(PASS_OPAQUE, packet.program, packet.texture, packet.vao,
+                                      packet.renderState, depth01);
+    return depthOnly;
+}
+
+FramePrep::FramePrep()
+    : m_pool(NULL), m_overlap(false), m_submitted(0), m_completed(0), m_consumed(0), m_quit(false)
+{
+}
+
+FramePrep::~FramePrep()
+{
+    shutdown();
+}
+
+void FramePrep::init(const FramePrepScene& scene, WorkerPool& pool, bool overlap)
+{
+    shutdown();
+    m_scene = scene;
+    m_pool = &pool;
+    m_spinBaseYaw.resize(scene.spinningCount);
+    for (unsigned int i = 0; i < scene.spinningCount; i++)
+    {
+        m_spinBaseYaw[i] = scene.spinning->transforms.yaw[i];
+    }
+    m_spinLocals.resize(scene.spinningCount);
+    m_overlap = overlap;
+    m_submitted = m_completed = m_consumed = 0;
+    m_quit = false;
+    if (overlap)
+    {
+        m_thread = std::thread(&FramePrep::threadMain, this);
+    }
+}
+
+void FramePrep::shutdown()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_kicked.notify_all();
+        m_thread.join();
+    }
+    m_pool = NULL;
+}
+
+FramePrepInput& FramePrep::nextInput()
+{
+    return m_frames[m_submitted % 2].input;
+}
+
+void FramePrep::kick()
+{
+    if (m_submitted - m_consumed >= 2)
+    {
+        printf("FramePrep::kick: two frames already outstanding, call wait() first\n");
+        return;
+    }
+    if (!m_overlap)
+    {
+        prepare(m_frames[m_submitted % 2]);
+        m_submitted++;
+        m_completed++;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_submitted++;
+    }
+    m_kicked.notify_one();
+}
+
+PreparedFrame& FramePrep::wait()
+{
+    PROFILE_SCOPE("wait for prep");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_completed <= m_consumed)
+    {
+        m_finished.wait(lock);
+    }
+    return m_frames[m_consumed++ % 2];
+}
+
+void FramePrep::threadMain()
+{
+    profilerSetThreadName("frame prep");
+    for (;;)
+    {
+        unsigned long long index;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_quit && m_completed == m_submitted)
+            {
+                m_kicked.wait(lock);
+            }
+            if (m_quit)
+            {
+                return;
+            }
+            index = m_completed;
+        }
+
+        prepare(m_frames[index % 2]);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed++;
+        }
+        m_finished.notify_one();
+    }
+}
+
+/*
+* prepare
+* ------------------------------------------------------------------
+* Purpose: Build one frame from its input: spin the animated rows and
+* update the hierarchy, emit the always-drawn entities, frustum-cull the
+* bounded entities chunk by chunk, compact the survivors per archetype,
+* run occlusion on them, then pick each visible entity's LOD and write its
+* uniform block and packet in parallel, and sort the queue.
+*/
+void FramePrep::prepare(PreparedFrame& frame)
+{
+    PROFILE_SCOPE("prepare frame");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    const FramePrepInput& in = frame.input;
+    const glm::mat4 viewProj = in.projection * in.view;
+    TransformHierarchy& hierarchy = *m_scene.hierarchy;
+    EntityStore& entities = *m_scene.entities;
+    const std::vector<SceneMesh>& meshes = *m_scene.meshes;
+    const bool prepass = m_scene.depthPrepass;
+    const SortOrder order = prepass ? SORT_BY_STATE : SORT_FRONT_TO_BACK;
+
+    frame.queue.clear();
+    frame.blocks.assign(in.fixedBlocks.begin(), in.fixedBlocks.end());
+    for (size_t i = 0; i < in.fixedPackets.size(); i++)
+    {
+        frame.queue.push(in.fixedPackets[i]);
+    }
+    frame.visibleRuns.clear();
+    frame.visibleCount = 0;
+    frame.occluded = 0;
+    frame.occludedTriangles = 0;
+
+    // 0. Only the spinning rows get new local matrices (batched), so only
+    // their world matrices are recomputed
+    {
+        PROFILE_SCOPE("update transforms");
+        if (m_scene.spinningCount > 0)
+        {
+            Archetype& spinning = *m_scene.spinning;
+            frame.spinPlacements.resize(m_scene.spinningCount);
+            for (unsigned int i = 0; i < m_scene.spinningCount; i++)
+            {
+                spinning.transforms.yaw[i] = m_spinBaseYaw[i] + kSpinRate * in.time;
+                frame.spinPlacements[i] = glm::vec4(spinning.transforms.x[i], spinning.transforms.y[i],
+                                                    spinning.transforms.z[i], spinning.transforms.yaw[i]);
+            }
+            transformObjects(spinning.transforms, NULL, m_scene.spinningCount, m_scene.meshFix, glm::mat4(1.0f),
+                             &m_spinLocals[0], NULL);
+            for (unsigned int i = 0; i < m_scene.spinningCount; i++)
+            {
+                hierarchy.setLocal(spinning.nodes[i], m_spinLocals[i]);
+            }
+        }
+        frame.transformsUpdated = hierarchy.update();
+    }
+
+    // 1. Entities without bounds (the floor) are always drawn; they have no
+    // single depth, so they sort behind the bounded ones
+    entities.queryChunks(COMPONENT_TRANSFORM | COMPONENT_MESH | COMPONENT_MATERIAL, COMPONENT_BOUNDS, m_chunks);
+    for (size_t c = 0; c < m_chunks.size(); c++)
+    {
+        const Archetype& a = *m_chunks[c].archetype;
+        for (unsigned int row = m_chunks[c].first; row < m_chunks[c].first + m_chunks[c].count; row++)
+        {
+            const SceneMaterial& material = in.materials[a.materials[row]];
+            PerObjectBlock block;
+            block.M = hierarchy.world(a.nodes[row]);
+            block.Tint = material.tint;
+            frame.blocks.push_back(block);
+            const SceneMesh& mesh = meshes[a.meshes[row]];
+            DrawPacket packet = entityPacket(material, mesh, 0, (unsigned int)frame.blocks.size() - 1, 1.0f, order);
+            if (prepass)
+            {
+                frame.queue.push(splitDepthPrepass(packet, material.depthProgram, mesh.depthVao, 1.0f));
+            }
+            frame.queue.push(packet);
+        }
+    }
+
+    // 2. Bounded entities (the heads)
+    entities.queryChunks(COMPONENT_TRANSFORM | COMPONENT_BOUNDS | COMPONENT_MESH | COMPONENT_MATERIAL, 0, m_chunks);
+    if (m_scene.submission == HEADS_GPU_DRIVEN)
+    {
+        // Culled and drawn by the GPU
+        for (size_t c = 0; c < m_chunks.size(); c++)
+        {
+            frame.visibleCount += m_chunks[c].count;
+        }
+    }
+    else
+    {
+        // Frustum culling: each chunk writes its own visible rows
+        glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+        extractFrustumPlanes(viewProj, planes);
+        const unsigned int chunks = (unsigned int)m_chunks.size();
+        m_chunkVisible.resize(chunks);
+        m_chunkCounts.resize(chunks);
+        EntityStore::parallelForChunks(*m_pool, m_chunks, [&](unsigned int c, const EntityChunk& chunk, unsigned int)
+        {
+            PROFILE_SCOPE("frustum cull chunk");
+            std::vector<unsigned int>& out = m_chunkVisible[c];
+            out.resize(kChunkSize);
+            if (m_scene.frustumCulling)
+            {
+                m_chunkCounts[c] = cullSphereRange(planes, chunk.archetype->bounds, chunk.first, chunk.count, &out[0]);
+            }
+            else
+            {
+                for (unsigned int i = 0; i < chunk.count; i++)
+                {
+                    out[i] = chunk.first + i;
+                }
+                m_chunkCounts[c] = chunk.count;
+            }
+        });
+
+        // Compact; chunks come archetype by archetype, so each archetype's
+        // survivors form one run
+        frame.visible.resize(chunks * kChunkSize);
+        unsigned int total = 0;
+        for (unsigned int c = 0; c < chunks; c++)
+        {
+            if (frame.visibleRuns.empty() || frame.visibleRuns.back().archetype != m_chunks[c].archetype)
+            {
+                VisibleRun run = { m_chunks[c].archetype, total, 0 };
+                frame.visibleRuns.push_back(run);
+            }
+            std::copy(m_chunkVisible[c].begin(), m_chunkVisible[c].begin() + m_chunkCounts[c],
+                      frame.visible.begin() + total);
+            total += m_chunkCounts[c];
+            frame.visibleRuns.back().count += m_chunkCounts[c];
+        }
+
+        // Occlusion: rasterize the floor and the nearest surviving entities,
+        // then drop the entities entirely behind them
+        if (m_scene.occlusion && total > 0)
+        {
+            PROFILE_SCOPE("occlusion");
+            OcclusionCuller& occlusion = *m_scene.occlusion;
+            m_occluderCandidates.clear();
+            for (size_t r = 0; r < frame.visibleRuns.size(); r++)
+            {
+                const VisibleRun& run = frame.visibleRuns[r];
+                const SphereSoA& bounds = run.archetype->bounds;
+                for (unsigned int i = run.first; i < run.first + run.count; i++)
+                {
+                    unsigned int row = frame.visible[i];
+                    glm::vec3 d = glm::vec3(bounds.x[row], bounds.y[row], bounds.z[row]) - in.cameraPosition;
+                    m_occluderCandidates.push_back(std::make_pair(glm::dot(d, d), run.archetype->nodes[row]));
+                }
+            }
+            unsigned int occluders = std::min(m_scene.occluderCount, total);
+            std::partial_sort(m_occluderCandidates.begin(), m_occluderCandidates.begin() + occluders,
+                              m_occluderCandidates.end());
+
+            occlusion.beginFrame(viewProj);
+            occlusion.addOccluder(m_scene.floorOccluder, glm::mat4(1.0f));
+            for (unsigned int i = 0; i < occluders; i++)
+            {
+                occlusion.addOccluder(m_scene.headOccluder, hierarchy.world(m_occluderCandidates[i].second));
+            }
+            occlusion.rasterizeOccluders();
+
+            // Filter each run and close the gaps between them. The filter
+            // keeps the order, so walking the unfiltered copy alongside the
+            // survivors finds the rejected rows, which are charged the
+            // triangles of the LOD they would have drawn.
+            unsigned int kept = 0;
+            for (size_t r = 0; r < frame.visibleRuns.size(); r++)
+            {
+                VisibleRun& run = frame.visibleRuns[r];
+                const Archetype& a = *run.archetype;
+                m_unoccluded.assign(frame.visible.begin() + run.first, frame.visible.begin() + run.first + run.count);
+                unsigned int left = occlusion.filterOccluded(a.bounds, &frame.visible[run.first], run.count);
+                for (unsigned int i = 0, k = 0; i < run.count; i++)
+                {
+                    unsigned int row = m_unoccluded[i];
+                    if (k < left && frame.visible[run.first + k] == row)
+                    {
+                        k++;
+                        continue;
+                    }
+                    const SceneMesh& mesh = meshes[a.meshes[row]];
+                    unsigned int lod = entityLod(a, row, mesh, in.cameraPosition, m_scene.submission);
+                    frame.occludedTriangles += mesh.lods[lod].indexCount / 3;
+                }
+                std::copy(frame.visible.begin() + run.first, frame.visible.begin() + run.first + left,
+                          frame.visible.begin() + kept);
+                run.first = kept;
+                run.count = left;
+                kept += left;
+            }
+            total = kept;
+            frame.occluded = occlusion.stats().occluded;
+        }
+        frame.visibleCount = total;
+
+        // 3. Per-entity data, one chunk of each run per task
+        if (m_scene.submission == HEADS_PER_OBJECT)
+        {
+            PROFILE_SCOPE("build packets");
+            const unsigned int firstBlock = (unsigned int)frame.blocks.size();
+            const unsigned int packetsPerEntity = prepass ? 2 : 1;
+            const unsigned int firstPacket = frame.queue.allocate(total * packetsPerEntity);
+            frame.blocks.resize(firstBlock + total);
+            for (size_t r = 0; r < frame.visibleRuns.size(); r++)
+            {
+                const VisibleRun& run = frame.visibleRuns[r];
+                Archetype& a = *run.archetype;
+                m_pool->parallelFor((run.count + kChunkSize - 1) / kChunkSize, [&](unsigned int c, unsigned int)
+                {
+                    PROFILE_SCOPE("build packet chunk");
+                    unsigned int end = run.first + std::min(run.count, (c + 1) * kChunkSize);
+                    for (unsigned int i = run.first + c * kChunkSize; i < end; i++)
+                    {
+                        unsigned int row = frame.visible[i];
+                        glm::vec3 center(a.bounds.x[row], a.bounds.y[row], a.bounds.z[row]);
+                        const SceneMesh& mesh = meshes[a.meshes[row]];
+                        const SceneMaterial& material = in.materials[a.materials[row]];
+
+                        unsigned int lod = entityLod(a, row, mesh, in.cameraPosition, m_scene.submission);
+                        if ((a.components & COMPONENT_LOD) != 0)
+                        {
+                            a.lods[row] = lod;
+                        }
+
+                        // Cached world matrix: placement, yaw, then the chin fix
+                        PerObjectBlock& block = frame.blocks[firstBlock + i];
+                        block.M = hierarchy.world(a.nodes[row]);
+                        block.Tint = material.tint;
+                        const float depth = depth01(viewProj, center);
+                        DrawPacket packet = entityPacket(material, mesh, lod, firstBlock + i, depth, order);
+                        if (prepass)
+                        {
+                            frame.queue.set(firstPacket + 2 * i + 1,
+                                splitDepthPrepass(packet, material.depthProgram, mesh.depthVao, depth));
+                        }
+                        frame.queue.set(firstPacket + packetsPerEntity * i, packet);
+                    }
+                });
+            }
+        }
+        else
+        {
+            PROFILE_SCOPE("gather placements");
+            frame.visiblePlacements.resize(total);
+            for (size_t r = 0; r < frame.visibleRuns.size(); r++)
+            {
+                const VisibleRun& run = frame.visibleRuns[r];
+                const TransformSoA& transforms = run.archetype->transforms;
+                m_pool->parallelFor((run.count + kChunkSize - 1) / kChunkSize, [&](unsigned int c, unsigned int)
+                {
+                    unsigned int end = run.first + std::min(run.count, (c + 1) * kChunkSize);
+                    for (unsigned int i = run.first + c * kChunkSize; i < end; i++)
+                    {
+                        unsigned int row = frame.visible[i];
+                        frame.visiblePlacements[i] = glm::vec4(transforms.x[row], transforms.y[row],
+                                                               transforms.z[row], transforms.yaw[row]);
+                    }
+                });
+            }
+            if (!prepass && total > 1)
+            {
+                PROFILE_SCOPE("sort instances");
+                sortFrontToBack(in.view, frame.visiblePlacements);
+            }
+            if (total > 0)
+            {
+                DrawPacket packet = in.headPacket;
+                packet.instanceCount = (GLsizei)total;
+                packet.key = RenderQueue::makeKey(PASS_OPAQUE, packet.program, packet.texture, packet.vao,
+                    packet.renderState, 0.0f, order);
+                if (prepass)
+                {
+                    frame.queue.push(splitDepthPrepass(packet, in.headDepthProgram, in.headDepthVao, 0.0f));
+                }
+                frame.queue.push(packet);
+            }
+        }
+    }
+
+    {
+        PROFILE_SCOPE("sort queue");
+        frame.queue.sort();
+    }
+    frame.prepMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+* sortFrontToBack
+* ------------------------------------------------------------------
+* Purpose: Reorder instance placements nearest first by view depth, as a
+* counting sort over kDepthBuckets distance classes spanning this frame's
+* nearest and farthest placement: two linear passes instead of a
+* comparison sort, and exact enough for early depth rejection.
+*/
+void FramePrep::sortFrontToBack(const glm::mat4& view, std::vector<glm::vec4>& placements)
+{
+    const size_t n = placements.size();
+    m_instanceDepth.resize(n);
+    m_instanceBucket.resize(n);
+    m_sortedPlacements.resize(n);
+
+    // View depth is -z of the view-space position (third row of `view`)
+    float nearest = FLT_MAX, farthest = -FLT_MAX;
+    for (size_t i = 0; i < n; i++)
+    {
+        const glm::vec4& p = placements[i];
+        float depth = -(view[0][2] * p.x + view[1][2] * p.y + view[2][2] * p.z + view[3][2]);
+        m_instanceDepth[i] = depth;
+        nearest = std::min(nearest, depth);
+        farthest = std::max(farthest, depth);
+    }
+
+    const float scale = float(kDepthBuckets - 1) / std::max(farthest - nearest, 1e-6f);
+    unsigned int offsets[kDepthBuckets];
+    memset(offsets, 0, sizeof(offsets));
+    for (size_t i = 0; i < n; i++)
+    {
+        unsigned int bucket = std::min((unsigned int)((m_instanceDepth[i] - nearest) * scale), kDepthBuckets - 1);
+        m_instanceBucket[i] = bucket;
+        offsets[bucket]++;
+    }
+    unsigned int sum = 0;
+    for (unsigned int b = 0; b < kDepthBuckets; b++)
+    {
+        unsigned int count = offsets[b];
+        offsets[b] = sum;
+        sum += count;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        m_sortedPlacements[offsets[m_instanceBucket[i]]++] = placements[i];
+    }
+    placements.swap(m_sortedPlacements);
+}
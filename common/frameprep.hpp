@@ -0,0 +1,205 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Frame preparation off the render thread. Everything a frame needs that
+* does not touch GL - frustum culling, occlusion, LOD selection, per-object
+* model matrices and sort keys, the sorted draw-packet queue - is built by
+* a preparation thread that walks the scene's entity store in chunks and
+* hands them to a worker pool, each worker writing its own range of
+* blocks and packets. The render thread only uploads the finished blocks
+* and submits the queue. Model matrices come from a transform hierarchy
+* that only the preparation touches; static objects are never recomputed.
+*
+* With overlap on, frame N+1 is prepared while frame N is submitted (two
+* frame slots), at the cost of one frame of input latency. With overlap
+* off, kick() prepares on the calling thread (still using the pool).
+*
+* With a depth pre-pass every entity is queued twice: depth only through
+* its mesh's position-only VAO first, then shaded with GL_EQUAL, so each
+* pixel runs the full fragment shader once. Without it the packets (and
+* the instanced heads) are ordered front to back instead, which leaves
+* early-Z to reject most of the hidden fragments.
+*/
+
+#ifndef FRAMEPREP_HPP
+#define FRAMEPREP_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "renderqueue.hpp"
+#include "workerpool.hpp"
+#include "meshlod.hpp"
+#include "entitystore.hpp"
+
+class OcclusionCuller;
+class TransformHierarchy;
+
+enum HeadSubmission
+{
+    HEADS_PER_OBJECT,  // one packet and one uniform block per visible head
+    HEADS_INSTANCED,   // one packet, visible placements as instance data
+    HEADS_GPU_DRIVEN   // culled on the GPU; nothing to prepare per head
+};
+
+// What an entity's mesh handle refers to
+struct SceneMesh
+{
+    GLuint               vao;
+    GLuint               depthVao;  // positions only, same element buffer (depth pre-pass)
+    GLenum               indexType;
+    std::vector<MeshLod> lods;   // ranges in the VAO's element buffer, finest first
+};
+
+// What an entity's material handle refers to (filled per frame: the
+// program depends on the lighting toggle)
+struct SceneMaterial
+{
+    GLuint       program;
+    GLuint       depthProgram;  // depth pre-pass, same vertex transform
+    GLuint       texture;
+    unsigned int renderState;   // RenderStateBits
+    glm::vec4    tint;
+};
+
+// Fixed for the whole run. Entities with MESH and MATERIAL but no BOUNDS
+// are always drawn; the ones with BOUNDS (the heads) are culled, and use
+// `headOccluder` when picked as occluders.
+struct FramePrepScene
+{
+    EntityStore*                  entities;    // read and animated only by the preparation
+    const std::vector<SceneMesh>* meshes;
+    glm::mat4                     meshFix;     // applied before the placement
+    TransformHierarchy*           hierarchy;   // world matrices; updated only by the preparation
+    Archetype*                    spinning;    // rows [0, spinningCount) spin about their own z axis
+    unsigned int                  spinningCount;
+    HeadSubmission                submission;
+    bool                          frustumCulling;
+    OcclusionCuller*              occlusion;   // NULL: no occlusion culling
+    unsigned int                  floorOccluder, headOccluder, occluderCount;
+    bool                          depthPrepass;  // else packets sort front to back
+};
+
+// Visible rows of one archetype, a range of PreparedFrame::visible
+struct VisibleRun
+{
+    Archetype*   archetype;
+    unsigned int first, count;
+};
+
+// Filled by the render thread for each kick()
+struct FramePrepInput
+{
+    glm::mat4 view, projection;
+    glm::vec3 cameraPosition;
+    float     time;            // animation clock, seconds
+
+    // Indexed by the entities' material handles
+    std::vector<SceneMaterial>  materials;
+
+    // Packets that don't come from entities (GPU-driven batch); their
+    // uniformSlot indexes `fixedBlocks`
+    std::vector<DrawPacket>     fixedPackets;
+    std::vector<PerObjectBlock> fixedBlocks;
+
+    // HEADS_INSTANCED: the batch packet, which gets the visible count and
+    // keeps the template's slot, and its depth-only program and VAO
+    DrawPacket headPacket;
+    GLuint     headDepthProgram, headDepthVao;
+};
+
+struct PreparedFrame
+{
+    FramePrepInput input;
+
+    std::vector<unsigned int>   visible;       // visible rows, grouped by archetype
+    std::vector<VisibleRun>     visibleRuns;   // which archetype each range of `visible` is
+    unsigned int                visibleCount;  // culled entities left (all of them if not culled)
+    unsigned int                occluded;      // rejected by occlusion culling
+    unsigned int                occludedTriangles;  // what the rejected ones would have drawn, at their LOD
+    unsigned int                transformsUpdated;  // world matrices recomputed
+    std::vector<PerObjectBlock> blocks;        // fixed blocks, then one per drawn entity
+    std::vector<glm::vec4>      visiblePlacements;  // HEADS_INSTANCED only; front to back without a pre-pass
+    std::vector<glm::vec4>      spinPlacements;     // the spinning rows' placements, culled or not
+    RenderQueue                 queue;         // sorted, slots index `blocks`
+    double                      prepMs;        // wall time of the preparation
+};
+
+/*
+* splitDepthPrepass()
+* ------------------------------------------------------------------
+* Purpose: Make `packet` (an opaque packet) the shading half of a depth
+* pre-pass pair: it now tests GL_EQUAL without writing depth. Returns the
+* depth-only half, which draws the same range with `depthProgram` and
+* `depthVao` ahead of every opaque packet.
+*/
+DrawPacket splitDepthPrepass(DrawPacket& packet, GLuint depthProgram, GLuint depthVao, float depth01);
+
+class FramePrep
+{
+public:
+    FramePrep();
+    ~FramePrep();
+
+    /*
+    * init()
+    * ------------------------------------------------------------------
+    * Purpose: Spread the per-frame work over `pool` (already started, and
+    * shared with the scene's occlusion culler, which only runs from inside
+    * prepare()) and, with `overlap`, start the preparation thread.
+    */
+    void init(const FramePrepScene& scene, WorkerPool& pool, bool overlap);
+    void shutdown();
+
+    // Threads sharing the per-head work
+    unsigned int workerCount() const { return m_pool ? m_pool->workerCount() : 1; }
+    bool overlapped() const { return m_overlap; }
+
+    // Input of the next frame to kick (valid until kick())
+    FramePrepInput& nextInput();
+
+    // Start preparing nextInput(); at most two frames may be outstanding
+    void kick();
+
+    // Oldest kicked frame, once finished; valid until the next kick() after it
+    PreparedFrame& wait();
+
+private:
+    FramePrep(const FramePrep&);
+    FramePrep& operator=(const FramePrep&);
+
+    void threadMain();
+    void prepare(PreparedFrame& frame);
+    void sortFrontToBack(const glm::mat4& view, std::vector<glm::vec4>& placements);
+
+    FramePrepScene             m_scene;
+    WorkerPool*                m_pool;           // not owned
+    PreparedFrame              m_frames[2];
+    std::vector<EntityChunk>   m_chunks;
+    std::vector<std::vector<unsigned int> > m_chunkVisible;  // [chunk]
+    std::vector<unsigned int>  m_chunkCounts;
+    std::vector<float>         m_spinBaseYaw;    // yaw of the spinning rows at time 0
+    std::vector<glm::mat4>     m_spinLocals;
+    std::vector<std::pair<float, unsigned int> > m_occluderCandidates;
+    std::vector<unsigned int>  m_unoccluded;     // a run's rows before the occlusion filter
+    std::vector<float>         m_instanceDepth;   // sortFrontToBack() scratch
+    std::vector<unsigned int>  m_instanceBucket;
+    std::vector<glm::vec4>     m_sortedPlacements;
+
+    bool                       m_overlap;
+    std::thread                m_thread;
+    std::mutex                 m_mutex;
+    std::condition_variable    m_kicked;      // work or quit for the thread
+    std::condition_variable    m_finished;    // a frame completed
+    unsigned long long         m_submitted;   // frames kicked
+    unsigned long long         m_completed;   // frames prepared
+    unsigned long long         m_consumed;    // frames returned by wait()
+    bool                       m_quit;
+};
+
+#endif
@@ -0,0 +1,228 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Frustum plane extraction, the scalar sphere tests, kernel dispatch and
+* the culling benchmark.
+*/
+
+#include <stdio.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "cpufeatures.hpp"
+#include "kernelbench.hpp"
+#include "frustum.hpp"
+
+void extractFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[FRUSTUM_PLANE_COUNT])
+{
+    // glm is column-major: row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; i++)
+    {
+        row[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    }
+
+    planes[0] = row[3] + row[0];  // left
+    planes[1] = row[3] - row[0];  // right
+    planes[2] = row[3] + row[1];  // bottom
+    planes[3] = row[3] - row[1];  // top
+    planes[4] = row[3] + row[2];  // near (GL clip space, z >= -w)
+    planes[5] = row[3] - row[2];  // far
+
+    for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+    {
+        planes[p] = planes[p] / glm::length(glm::vec3(planes[p]));
+    }
+}
+
+bool sphereInFrustum(const glm::vec4 planes[FRUSTUM_PLANE_COUNT], const glm::vec3& center, float radius)
+{
+    for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+    {
+        if (glm::dot(glm::vec3(planes[p]), center) + planes[p].w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// AVX2 kernel, built in frustum_avx2.cpp with AVX2/FMA code generation
+bool frustumAvx2Compiled();
+unsigned int cullSpheresAvx2(const glm::vec4 planes[FRUSTUM_PLANE_COUNT],
+                             const float* x, const float* y, const float* z, const float* r,
+                             unsigned int first, unsigned int end, unsigned int* visible);
+
+void buildSphereSoA(const std::vector<glm::vec4>& spheres, SphereSoA& soa)
+{
+    soa.count = (unsigned int)spheres.size();
+    size_t padded = (spheres.size() + 7) & ~size_t(7);
+
+    // Padding: a hugely negative radius fails every plane test
+    soa.x.assign(padded, 0.0f);
+    soa.y.assign(padded, 0.0f);
+    soa.z.assign(padded, 0.0f);
+    soa.r.assign(padded, -1e30f);
+    for (size_t i = 0; i < spheres.size(); i++)
+    {
+        soa.x[i] = spheres[i].x;
+        soa.y[i] = spheres[i].y;
+        soa.z[i] = spheres[i].z;
+        soa.r[i] = spheres[i].w;
+    }
+}
+
+CullKernel bestCullKernel()
+{
+    return (frustumAvx2Compiled() && cpuSupportsAvx2()) ? CULL_AVX2 : CULL_SCALAR;
+}
+
+const char* cullKernelName(CullKernel kernel)
+{
+    return kernel == CULL_AVX2 ? "AVX2" : "scalar";
+}
+
+/*
+* cullSpheresScalar
+* ------------------------------------------------------------------
+* Purpose: Reference kernel over the same SoA arrays.
+*/
+static unsigned int cullSpheresScalar(const glm::vec4 planes[FRUSTUM_PLANE_COUNT], const SphereSoA& spheres,
+                                      unsigned int first, unsigned int end, unsigned int* visible)
+{
+    unsigned int n = 0;
+    for (unsigned int i = first; i < end; i++)
+    {
+        bool inside = true;
+        for (int p = 0; p < FRUSTUM_PLANE_COUNT && inside; p++)
+        {
+            float d = planes[p].x * spheres.x[i] + planes[p].y * spheres.y[i] + planes[p].z * spheres.z[i] + planes[p].w;
+            inside = d >= -spheres.r[i];
+        }
+        if (inside)
+        {
+            visible[n++] = i;
+        }
+    }
+    return n;
+}
+
+unsigned int cullSpheres(const glm::vec4 planes[FRUSTUM_PLANE_COUNT], const SphereSoA& spheres,
+                         std::vector<unsigned int>& visible, CullKernel kernel)
+{
+    if (visible.size() < spheres.x.size())
+    {
+        visible.resize(spheres.x.size());
+    }
+    if (spheres.count == 0)
+    {
+        return 0;
+    }
+
+    return cullSphereRange(planes, spheres, 0, spheres.count, &visible[0], kernel);
+}
+
+unsigned int cullSphereRange(const glm::vec4 planes[FRUSTUM_PLANE_COUNT], const SphereSoA& spheres,
+                             unsigned int first, unsigned int count, unsigned int* visible, CullKernel kernel)
+{
+    unsigned int end = std::min(first + count, spheres.count);
+    if (first >= end)
+    {
+        return 0;
+    }
+    if (kernel == CULL_AVX2 && frustumAvx2Compiled() && cpuSupportsAvx2())
+    {
+        // Whole groups of 8. Only the last range may round up into the
+        // padding (which never passes); a range that stops mid-group before
+        // the end would pick up the next range's spheres, so its tail goes
+        // through the scalar kernel instead.
+        unsigned int groupEnd = (end == spheres.count)
+            ? std::min((end + 7) & ~7u, (unsigned int)spheres.x.size())
+            : (end & ~7u);
+        unsigned int n = 0;
+        if (groupEnd > first)
+        {
+            n = cullSpheresAvx2(planes, &spheres.x[0], &spheres.y[0], &spheres.z[0], &spheres.r[0],
+                                first, groupEnd, visible);
+        }
+        if (groupEnd < end)
+        {
+            n += cullSpheresScalar(planes, spheres, std::max(first, groupEnd), end, visible + n);
+        }
+        return n;
+    }
+    return cullSpheresScalar(planes, spheres, first, end, visible);
+}
+
+bool benchmarkSphereCulling(unsigned int count)
+{
+    // Random spheres in a 200-unit cube, seen from outside one face
+    std::vector<float> random;
+    fillBenchmarkRandom(count, 4, random);
+    std::vector<glm::vec4> spheres(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const float* v = &random[4 * i];
+        spheres[i] = glm::vec4(200.0f * v[0] - 100.0f, 200.0f * v[1] - 100.0f, 200.0f * v[2] - 100.0f, 0.5f + 1.5f * v[3]);
+    }
+    SphereSoA soa;
+    buildSphereSoA(spheres, soa);
+
+    glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+    extractFrustumPlanes(benchmarkViewProjection(), planes);
+
+    const CullKernel kernels[2] = { CULL_SCALAR, CULL_AVX2 };
+    const int kernelCount = bestCullKernel() == CULL_AVX2 ? 2 : 1;
+    std::vector<unsigned int> visible[2];
+    unsigned int visibleCount[2] = { 0, 0 };
+
+    printf("Culling %u spheres (%s kernel available)\n", count, cullKernelName(bestCullKernel()));
+    for (int k = 0; k < kernelCount; k++)
+    {
+        double rate = measureThroughput(count, [&]()
+        {
+            visibleCount[k] = cullSpheres(planes, soa, visible[k], kernels[k]);
+        });
+        printf("  %-6s %8.1f M spheres/s, %u visible (%.1f%%)\n", cullKernelName(kernels[k]),
+               rate, visibleCount[k],
+               count ? 100.0 * visibleCount[k] / count : 0.0);
+    }
+
+    if (kernelCount == 2)
+    {
+        // FMA rounding may flip spheres that touch a plane; anything
+        // else is a kernel bug
+        std::vector<bool> a(count, false), b(count, false);
+        for (unsigned int i = 0; i < visibleCount[0]; i++) a[visible[0][i]] = true;
+        for (unsigned int i = 0; i < visibleCount[1]; i++) b[visible[1][i]] = true;
+        unsigned int hard = 0;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (a[i] == b[i])
+            {
+                continue;
+            }
+            float margin = 1e30f;
+            for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+            {
+                float d = glm::dot(glm::vec3(planes[p]), glm::vec3(spheres[i])) + planes[p].w + spheres[i].w;
+                margin = std::min(margin, std::fabs(d));
+            }
+            if (margin > 1e-3f)
+            {
+                hard++;
+            }
+        }
+        printf("  kernels %s\n", agreementText(hard == 0));
+        return hard == 0;
+    }
+    return true;
+}
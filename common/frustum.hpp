@@ -0,0 +1,102 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* View-frustum helpers shared by the CPU and GPU culling paths. Planes are
+* extracted from the combined projection * view matrix (Gribb/Hartmann) and
+* normalized, so dot(plane.xyz, p) + plane.w is a signed distance in world
+* units, positive inside.
+*
+* For large object counts the spheres are kept in structure-of-arrays form
+* and tested eight at a time with AVX2/FMA when the CPU supports it (with a
+* scalar fallback); the result is a compact list of visible indices.
+*/
+
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "alignedvector.hpp"
+
+enum { FRUSTUM_PLANE_COUNT = 6 };
+
+enum CullKernel
+{
+    CULL_SCALAR,
+    CULL_AVX2     // 8 spheres per iteration
+};
+
+// Bounding spheres in structure-of-arrays form. The arrays are padded to a
+// multiple of 8 with spheres that can never pass, so the SIMD kernel has
+// no scalar tail.
+struct SphereSoA
+{
+    AlignedVector<float> x, y, z, r;
+    unsigned int count;  // real spheres (excluding padding)
+};
+
+/*
+* extractFrustumPlanes()
+* ------------------------------------------------------------------
+* Purpose: Fill planes[0..5] (left, right, bottom, top, near, far) from
+* viewProj = P * V.
+*/
+void extractFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[FRUSTUM_PLANE_COUNT]);
+
+/*
+* sphereInFrustum()
+* ------------------------------------------------------------------
+* Purpose: Conservative sphere test; true unless the sphere lies
+* entirely behind one of the planes.
+*/
+bool sphereInFrustum(const glm::vec4 planes[FRUSTUM_PLANE_COUNT], const glm::vec3& center, float radius);
+
+// Fill `soa` from xyz = center, w = radius
+void buildSphereSoA(const std::vector<glm::vec4>& spheres, SphereSoA& soa);
+
+// Fastest kernel the CPU (and the build) supports
+CullKernel bestCullKernel();
+const char* cullKernelName(CullKernel kernel);
+
+/*
+* cullSpheres()
+* ------------------------------------------------------------------
+* Purpose: Test every sphere against the planes and write the indices of
+* the visible ones, in increasing order, to visible[0 .. n).
+* Returns: n, the number of visible spheres. `visible` is grown to hold
+* every sphere; its size is not the visible count.
+*/
+unsigned int cullSpheres(const glm::vec4 planes[FRUSTUM_PLANE_COUNT], const SphereSoA& spheres,
+                         std::vector<unsigned int>& visible, CullKernel kernel = bestCullKernel());
+
+/*
+* cullSphereRange()
+* ------------------------------------------------------------------
+* Purpose: cullSpheres() for spheres [first, first + count) only, so
+* threads can cull disjoint ranges; `first` must be a multiple of 8.
+* `count` need not be: only the final range is rounded up into the
+* padding, other ranges finish their last partial group with scalar tests,
+* so results never include a neighbouring range's spheres. Writes absolute
+* indices to visible[0 .. n), which needs room for `count` rounded up to
+* 8 entries.
+* Returns: n.
+*/
+unsigned int cullSphereRange(const glm::vec4 planes[FRUSTUM_PLANE_COUNT], const SphereSoA& spheres,
+                             unsigned int first, unsigned int count, unsigned int* visible,
+                             CullKernel kernel = bestCullKernel());
+
+/*
+* benchmarkSphereCulling()
+* ------------------------------------------------------------------
+* Purpose: Cull `count` random spheres against a fixed view with every
+* available kernel, check that they agree, and print spheres per second.
+* Returns: false if the kernels disagree.
+*/
+bool benchmarkSphereCulling(unsigned int count);
+
+#endif
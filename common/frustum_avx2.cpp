@@ -0,0 +1,89 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* AVX2/FMA sphere-frustum kernel (see cpufeatures.hpp).
+*/
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include "cpufeatures.hpp"
+#include "frustum.hpp"
+
+#if defined(__AVX2__)
+
+bool frustumAvx2Compiled()
+{
+    return true;
+}
+
+/*
+* cullSpheresAvx2
+* ------------------------------------------------------------------
+* Purpose: Eight spheres per iteration: the signed distance to each plane
+* is formed with FMAs, the six "not behind" masks are ANDed, and the set
+* lanes are appended to `visible` in order.
+* Inputs: spheres [first, end) are tested; both are multiples of 8 and
+* padding spheres never pass. Indices are written relative to the arrays.
+*/
+unsigned int cullSpheresAvx2(const glm::vec4 planes[FRUSTUM_PLANE_COUNT],
+                             const float* x, const float* y, const float* z, const float* r,
+                             unsigned int first, unsigned int end, unsigned int* visible)
+{
+    __m256 px[FRUSTUM_PLANE_COUNT], py[FRUSTUM_PLANE_COUNT], pz[FRUSTUM_PLANE_COUNT], pw[FRUSTUM_PLANE_COUNT];
+    for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+    {
+        px[p] = _mm256_set1_ps(planes[p].x);
+        py[p] = _mm256_set1_ps(planes[p].y);
+        pz[p] = _mm256_set1_ps(planes[p].z);
+        pw[p] = _mm256_set1_ps(planes[p].w);
+    }
+
+    unsigned int n = 0;
+    for (unsigned int i = first; i < end; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 cz = _mm256_loadu_ps(z + i);
+        __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(r + i));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+        {
+            __m256 d = _mm256_fmadd_ps(px[p], cx, pw[p]);
+            d = _mm256_fmadd_ps(py[p], cy, d);
+            d = _mm256_fmadd_ps(pz[p], cz, d);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negR, _CMP_GE_OQ));
+        }
+
+        unsigned int mask = (unsigned int)_mm256_movemask_ps(inside);
+        while (mask)
+        {
+            visible[n++] = i + lowestBit(mask);
+            mask &= mask - 1;
+        }
+    }
+    return n;
+}
+
+#else
+
+bool frustumAvx2Compiled()
+{
+    return false;
+}
+
+unsigned int cullSpheresAvx2(const glm::vec4[FRUSTUM_PLANE_COUNT],
+                             const float*, const float*, const float*, const float*,
+                             unsigned int, unsigned int, unsigned int*)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,660 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* GL state shadow: redundant-call elision and read-back validation.
+*/
+
+#include <stdio.h>
+
+#include <GL/glew.h>
+
+#include "glstate.hpp"
+
+// Shadow value for "not known": no GL name or enum has this value
+static const GLuint kUnknown = 0xFFFFFFFFu;
+
+static const unsigned int kTextureUnits   = 16;
+static const unsigned int kIndexedBindings = 16;  // per indexed target
+static const unsigned int kMaxReports     = 20;   // validation messages printed
+
+// Tracked targets with the query that reads them back
+struct TargetInfo
+{
+    GLenum target;
+    GLenum binding;
+};
+
+static const TargetInfo kBufferTargets[] =
+{
+    { GL_ARRAY_BUFFER,          GL_ARRAY_BUFFER_BINDING },
+    { GL_ELEMENT_ARRAY_BUFFER,  GL_ELEMENT_ARRAY_BUFFER_BINDING },
+    { GL_UNIFORM_BUFFER,        GL_UNIFORM_BUFFER_BINDING },
+    { GL_SHADER_STORAGE_BUFFER, GL_SHADER_STORAGE_BUFFER_BINDING },
+    { GL_DRAW_INDIRECT_BUFFER,  GL_DRAW_INDIRECT_BUFFER_BINDING },
+    { GL_PARAMETER_BUFFER_ARB,  GL_PARAMETER_BUFFER_BINDING_ARB },
+    { GL_PIXEL_PACK_BUFFER,     GL_PIXEL_PACK_BUFFER_BINDING },
+    { GL_PIXEL_UNPACK_BUFFER,   GL_PIXEL_UNPACK_BUFFER_BINDING },
+    { GL_COPY_WRITE_BUFFER,     GL_COPY_WRITE_BUFFER_BINDING },
+};
+static const unsigned int kBufferTargetCount = sizeof(kBufferTargets) / sizeof(kBufferTargets[0]);
+
+// Indexed targets: binding, start and size queries
+struct IndexedInfo
+{
+    GLenum target;
+    GLenum binding;
+    GLenum start;
+    GLenum size;
+};
+
+static const IndexedInfo kIndexedTargets[] =
+{
+    { GL_UNIFORM_BUFFER,        GL_UNIFORM_BUFFER_BINDING,        GL_UNIFORM_BUFFER_START,        GL_UNIFORM_BUFFER_SIZE },
+    { GL_SHADER_STORAGE_BUFFER, GL_SHADER_STORAGE_BUFFER_BINDING, GL_SHADER_STORAGE_BUFFER_START, GL_SHADER_STORAGE_BUFFER_SIZE },
+};
+static const unsigned int kIndexedTargetCount = sizeof(kIndexedTargets) / sizeof(kIndexedTargets[0]);
+
+static const TargetInfo kTextureTargets[] =
+{
+    { GL_TEXTURE_2D,       GL_TEXTURE_BINDING_2D },
+    { GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BINDING_CUBE_MAP },
+    { GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BINDING_2D_ARRAY },
+    { GL_TEXTURE_BUFFER,   GL_TEXTURE_BINDING_BUFFER },
+};
+static const unsigned int kTextureTargetCount = sizeof(kTextureTargets) / sizeof(kTextureTargets[0]);
+
+static const GLenum kCaps[] =
+{
+    GL_CULL_FACE, GL_DEPTH_TEST, GL_BLEND, GL_POLYGON_OFFSET_FILL, GL_SCISSOR_TEST,
+    GL_STENCIL_TEST, GL_MULTISAMPLE, GL_FRAMEBUFFER_SRGB, GL_PRIMITIVE_RESTART,
+    GL_RASTERIZER_DISCARD
+};
+static const unsigned int kCapCount = sizeof(kCaps) / sizeof(kCaps[0]);
+
+struct IndexedBinding
+{
+    GLuint     buffer;
+    GLintptr   offset;  // 0 / 0 for glBindBufferBase
+    GLsizeiptr size;
+};
+
+struct ShadowState
+{
+    GLuint         program;
+    GLuint         vao;
+    GLuint         buffers[kBufferTargetCount];
+    IndexedBinding indexed[kIndexedTargetCount][kIndexedBindings];
+    GLuint         drawFramebuffer;
+    GLuint         readFramebuffer;
+    GLuint         activeUnit;  // 0-based
+    GLuint         textures[kTextureUnits][kTextureTargetCount];
+    signed char    caps[kCapCount];  // -1 unknown, 0 off, 1 on
+    GLenum         blendSrc, blendDst;
+    GLenum         depthFunc;
+    GLuint         depthMask;
+    GLuint         colorMask;  // GL_TRUE: every channel written, GL_FALSE: none
+    bool           offsetKnown;
+    GLfloat        offsetFactor, offsetUnits;
+};
+
+static ShadowState  s_state;
+static bool         s_validate = false;
+static GLStateStats s_frameStats = { 0, 0, 0 };
+
+template <typename T>
+static int findIndex(const T* table, unsigned int count, GLenum target)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (table[i].target == target)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static int findCap(GLenum cap)
+{
+    for (unsigned int i = 0; i < kCapCount; i++)
+    {
+        if (kCaps[i] == cap)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Count one wrapper call; returns true if it has to be forwarded
+static bool needsCall(bool current)
+{
+    if (current)
+    {
+        s_frameStats.elided++;
+        return false;
+    }
+    s_frameStats.forwarded++;
+    return true;
+}
+
+/*
+* mismatch
+* ------------------------------------------------------------------
+* Purpose: Record a shadow/driver difference; the first few are printed.
+*/
+static void mismatch(const char* where, const char* what, double shadow, double actual)
+{
+    if (s_frameStats.validationErrors < kMaxReports)
+    {
+        printf("GL state %s: %s is %g, shadow says %g\n", where, what, actual, shadow);
+    }
+    s_frameStats.validationErrors++;
+}
+
+static void checkInteger(const char* where, const char* what, GLenum pname, GLuint shadow)
+{
+    if (shadow == kUnknown)
+    {
+        return;
+    }
+    GLint actual = 0;
+    glGetIntegerv(pname, &actual);
+    if (GLuint(actual) != shadow)
+    {
+        mismatch(where, what, shadow, actual);
+    }
+}
+
+static void checkProgram(const char* where)
+{
+    checkInteger(where, "program", GL_CURRENT_PROGRAM, s_state.program);
+}
+
+static void checkVertexArray(const char* where)
+{
+    checkInteger(where, "vertex array", GL_VERTEX_ARRAY_BINDING, s_state.vao);
+}
+
+static void checkBuffer(const char* where, unsigned int t)
+{
+    checkInteger(where, "buffer binding", kBufferTargets[t].binding, s_state.buffers[t]);
+}
+
+static void checkIndexed(const char* where, unsigned int t, GLuint index)
+{
+    const IndexedBinding& b = s_state.indexed[t][index];
+    if (b.buffer == kUnknown)
+    {
+        return;
+    }
+    GLint buffer = 0;
+    GLint64 start = 0, size = 0;
+    glGetIntegeri_v(kIndexedTargets[t].binding, index, &buffer);
+    glGetInteger64i_v(kIndexedTargets[t].start, index, &start);
+    glGetInteger64i_v(kIndexedTargets[t].size, index, &size);
+    if (GLuint(buffer) != b.buffer)
+    {
+        mismatch(where, "indexed buffer", b.buffer, buffer);
+    }
+    else if (start != GLint64(b.offset) || size != GLint64(b.size))
+    {
+        mismatch(where, "indexed buffer offset", double(b.offset), double(start));
+    }
+}
+
+static void checkFramebuffers(const char* where)
+{
+    checkInteger(where, "draw framebuffer", GL_DRAW_FRAMEBUFFER_BINDING, s_state.drawFramebuffer);
+    checkInteger(where, "read framebuffer", GL_READ_FRAMEBUFFER_BINDING, s_state.readFramebuffer);
+}
+
+static void checkActiveTexture(const char* where)
+{
+    if (s_state.activeUnit != kUnknown)
+    {
+        checkInteger(where, "active texture", GL_ACTIVE_TEXTURE, GL_TEXTURE0 + s_state.activeUnit);
+    }
+}
+
+// Only the active unit can be read back without switching units
+static void checkTexture(const char* where, unsigned int t)
+{
+    if (s_state.activeUnit != kUnknown && s_state.activeUnit < kTextureUnits)
+    {
+        checkInteger(where, "texture binding", kTextureTargets[t].binding,
+                     s_state.textures[s_state.activeUnit][t]);
+    }
+}
+
+static void checkCap(const char* where, unsigned int c)
+{
+    if (s_state.caps[c] < 0)
+    {
+        return;
+    }
+    bool actual = glIsEnabled(kCaps[c]) == GL_TRUE;
+    if (actual != (s_state.caps[c] == 1))
+    {
+        mismatch(where, "enable bit", s_state.caps[c], actual);
+    }
+}
+
+static void checkBlendDepthOffset(const char* where)
+{
+    checkInteger(where, "blend source", GL_BLEND_SRC_RGB, s_state.blendSrc);
+    checkInteger(where, "blend destination", GL_BLEND_DST_RGB, s_state.blendDst);
+    checkInteger(where, "depth function", GL_DEPTH_FUNC, s_state.depthFunc);
+    checkInteger(where, "depth mask", GL_DEPTH_WRITEMASK, s_state.depthMask);
+    if (s_state.colorMask != kUnknown)
+    {
+        GLboolean mask[4] = { GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE };
+        glGetBooleanv(GL_COLOR_WRITEMASK, mask);
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            if (GLuint(mask[c]) != s_state.colorMask)
+            {
+                mismatch(where, "color mask", s_state.colorMask, mask[c]);
+                break;
+            }
+        }
+    }
+    if (s_state.offsetKnown)
+    {
+        GLfloat factor = 0.0f, units = 0.0f;
+        glGetFloatv(GL_POLYGON_OFFSET_FACTOR, &factor);
+        glGetFloatv(GL_POLYGON_OFFSET_UNITS, &units);
+        if (factor != s_state.offsetFactor || units != s_state.offsetUnits)
+        {
+            mismatch(where, "polygon offset factor", s_state.offsetFactor, factor);
+        }
+    }
+}
+
+void glsInit(bool validate)
+{
+    s_validate = validate;
+    s_frameStats.validationErrors = 0;
+    glsInvalidate();
+    glsBeginFrame();
+    if (validate)
+    {
+        printf("GL state validation on: every tracked call is read back\n");
+    }
+}
+
+void glsInvalidate()
+{
+    s_state.program = kUnknown;
+    s_state.vao = kUnknown;
+    for (unsigned int t = 0; t < kBufferTargetCount; t++)
+    {
+        s_state.buffers[t] = kUnknown;
+    }
+    for (unsigned int t = 0; t < kIndexedTargetCount; t++)
+    {
+        for (unsigned int i = 0; i < kIndexedBindings; i++)
+        {
+            s_state.indexed[t][i].buffer = kUnknown;
+            s_state.indexed[t][i].offset = 0;
+            s_state.indexed[t][i].size = 0;
+        }
+    }
+    s_state.drawFramebuffer = s_state.readFramebuffer = kUnknown;
+    s_state.activeUnit = kUnknown;
+    for (unsigned int u = 0; u < kTextureUnits; u++)
+    {
+        for (unsigned int t = 0; t < kTextureTargetCount; t++)
+        {
+            s_state.textures[u][t] = kUnknown;
+        }
+    }
+    for (unsigned int c = 0; c < kCapCount; c++)
+    {
+        s_state.caps[c] = -1;
+    }
+    s_state.blendSrc = s_state.blendDst = kUnknown;
+    s_state.depthFunc = kUnknown;
+    s_state.depthMask = kUnknown;
+    s_state.colorMask = kUnknown;
+    s_state.offsetKnown = false;
+    s_state.offsetFactor = s_state.offsetUnits = 0.0f;
+}
+
+void glsUseProgram(GLuint program)
+{
+    if (needsCall(s_state.program == program))
+    {
+        glUseProgram(program);
+        s_state.program = program;
+    }
+    if (s_validate)
+    {
+        checkProgram("glsUseProgram");
+    }
+}
+
+void glsBindVertexArray(GLuint vao)
+{
+    if (needsCall(s_state.vao == vao))
+    {
+        glBindVertexArray(vao);
+        s_state.vao = vao;
+        // GL_ELEMENT_ARRAY_BUFFER is part of the VAO
+        s_state.buffers[findIndex(kBufferTargets, kBufferTargetCount, GL_ELEMENT_ARRAY_BUFFER)] = kUnknown;
+    }
+    if (s_validate)
+    {
+        checkVertexArray("glsBindVertexArray");
+    }
+}
+
+void glsBindBuffer(GLenum target, GLuint buffer)
+{
+    int t = findIndex(kBufferTargets, kBufferTargetCount, target);
+    if (t < 0)
+    {
+        s_frameStats.forwarded++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (needsCall(s_state.buffers[t] == buffer))
+    {
+        glBindBuffer(target, buffer);
+        s_state.buffers[t] = buffer;
+    }
+    if (s_validate)
+    {
+        checkBuffer("glsBindBuffer", t);
+    }
+}
+
+/*
+* bindIndexed
+* ------------------------------------------------------------------
+* Purpose: Shared body of glsBindBufferBase/Range. Both also set the
+* generic binding of the target.
+*/
+static void bindIndexed(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size, bool range)
+{
+    int t = findIndex(kIndexedTargets, kIndexedTargetCount, target);
+    int g = findIndex(kBufferTargets, kBufferTargetCount, target);
+    bool tracked = t >= 0 && index < kIndexedBindings;
+    if (tracked)
+    {
+        const IndexedBinding& b = s_state.indexed[t][index];
+        if (!needsCall(b.buffer == buffer && b.offset == offset && b.size == size &&
+                       (g < 0 || s_state.buffers[g] == buffer)))
+        {
+            return;
+        }
+    }
+    else
+    {
+        s_frameStats.forwarded++;
+    }
+
+    if (range)
+    {
+        glBindBufferRange(target, index, buffer, offset, size);
+    }
+    else
+    {
+        glBindBufferBase(target, index, buffer);
+    }
+    if (g >= 0)
+    {
+        s_state.buffers[g] = buffer;
+    }
+    if (tracked)
+    {
+        IndexedBinding& b = s_state.indexed[t][index];
+        b.buffer = buffer;
+        b.offset = offset;
+        b.size = size;
+        if (s_validate)
+        {
+            checkIndexed(range ? "glsBindBufferRange" : "glsBindBufferBase", t, index);
+        }
+    }
+}
+
+void glsBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    bindIndexed(target, index, buffer, 0, 0, false);
+}
+
+void glsBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    bindIndexed(target, index, buffer, offset, size, true);
+}
+
+void glsBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    bool current = (!draw || s_state.drawFramebuffer == framebuffer) &&
+                   (!read || s_state.readFramebuffer == framebuffer);
+    if (needsCall(current))
+    {
+        glBindFramebuffer(target, framebuffer);
+        if (draw) s_state.drawFramebuffer = framebuffer;
+        if (read) s_state.readFramebuffer = framebuffer;
+    }
+    if (s_validate)
+    {
+        checkFramebuffers("glsBindFramebuffer");
+    }
+}
+
+void glsActiveTexture(GLenum unit)
+{
+    if (needsCall(s_state.activeUnit == unit - GL_TEXTURE0))
+    {
+        glActiveTexture(unit);
+        s_state.activeUnit = unit - GL_TEXTURE0;
+    }
+    if (s_validate)
+    {
+        checkActiveTexture("glsActiveTexture");
+    }
+}
+
+void glsBindTexture(GLenum target, GLuint texture)
+{
+    int t = findIndex(kTextureTargets, kTextureTargetCount, target);
+    if (t < 0 || s_state.activeUnit >= kTextureUnits)  // also covers an unknown unit
+    {
+        s_frameStats.forwarded++;
+        glBindTexture(target, texture);
+        return;
+    }
+    if (needsCall(s_state.textures[s_state.activeUnit][t] == texture))
+    {
+        glBindTexture(target, texture);
+        s_state.textures[s_state.activeUnit][t] = texture;
+    }
+    if (s_validate)
+    {
+        checkTexture("glsBindTexture", t);
+    }
+}
+
+void glsSetEnabled(GLenum cap, bool enabled)
+{
+    int c = findCap(cap);
+    if (c < 0)
+    {
+        s_frameStats.forwarded++;
+        if (enabled) glEnable(cap); else glDisable(cap);
+        return;
+    }
+    if (needsCall(s_state.caps[c] == (enabled ? 1 : 0)))
+    {
+        if (enabled) glEnable(cap); else glDisable(cap);
+        s_state.caps[c] = enabled ? 1 : 0;
+    }
+    if (s_validate)
+    {
+        checkCap("glsSetEnabled", c);
+    }
+}
+
+void glsEnable(GLenum cap)
+{
+    glsSetEnabled(cap, true);
+}
+
+void glsDisable(GLenum cap)
+{
+    glsSetEnabled(cap, false);
+}
+
+bool glsIsEnabled(GLenum cap)
+{
+    int c = findCap(cap);
+    if (c >= 0 && s_state.caps[c] >= 0)
+    {
+        if (s_validate)
+        {
+            checkCap("glsIsEnabled", c);
+        }
+        return s_state.caps[c] == 1;
+    }
+    bool enabled = glIsEnabled(cap) == GL_TRUE;
+    if (c >= 0)
+    {
+        s_state.caps[c] = enabled ? 1 : 0;
+    }
+    return enabled;
+}
+
+void glsBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    if (needsCall(s_state.blendSrc == sfactor && s_state.blendDst == dfactor))
+    {
+        glBlendFunc(sfactor, dfactor);
+        s_state.blendSrc = sfactor;
+        s_state.blendDst = dfactor;
+    }
+    if (s_validate)
+    {
+        checkBlendDepthOffset("glsBlendFunc");
+    }
+}
+
+void glsDepthFunc(GLenum func)
+{
+    if (needsCall(s_state.depthFunc == func))
+    {
+        glDepthFunc(func);
+        s_state.depthFunc = func;
+    }
+    if (s_validate)
+    {
+        checkBlendDepthOffset("glsDepthFunc");
+    }
+}
+
+void glsDepthMask(GLboolean flag)
+{
+    GLuint value = flag ? GL_TRUE : GL_FALSE;
+    if (needsCall(s_state.depthMask == value))
+    {
+        glDepthMask(flag);
+        s_state.depthMask = value;
+    }
+    if (s_validate)
+    {
+        checkBlendDepthOffset("glsDepthMask");
+    }
+}
+
+void glsColorMask(GLboolean flag)
+{
+    GLuint value = flag ? GL_TRUE : GL_FALSE;
+    if (needsCall(s_state.colorMask == value))
+    {
+        glColorMask(flag, flag, flag, flag);
+        s_state.colorMask = value;
+    }
+    if (s_validate)
+    {
+        checkBlendDepthOffset("glsColorMask");
+    }
+}
+
+void glsPolygonOffset(GLfloat factor, GLfloat units)
+{
+    if (needsCall(s_state.offsetKnown && s_state.offsetFactor == factor && s_state.offsetUnits == units))
+    {
+        glPolygonOffset(factor, units);
+        s_state.offsetKnown = true;
+        s_state.offsetFactor = factor;
+        s_state.offsetUnits = units;
+    }
+    if (s_validate)
+    {
+        checkBlendDepthOffset("glsPolygonOffset");
+    }
+}
+
+bool glsValidate(const char* where)
+{
+    unsigned int before = s_frameStats.validationErrors;
+
+    checkProgram(where);
+    checkVertexArray(where);
+    for (unsigned int t = 0; t < kBufferTargetCount; t++)
+    {
+        checkBuffer(where, t);
+    }
+    for (unsigned int t = 0; t < kIndexedTargetCount; t++)
+    {
+        for (unsigned int i = 0; i < kIndexedBindings; i++)
+        {
+            checkIndexed(where, t, i);
+        }
+    }
+    checkFramebuffers(where);
+    checkActiveTexture(where);
+
+    // Visit every unit with a known binding, then restore the active one
+    if (s_state.activeUnit < kTextureUnits)
+    {
+        for (unsigned int u = 0; u < kTextureUnits; u++)
+        {
+            glActiveTexture(GL_TEXTURE0 + u);
+            for (unsigned int t = 0; t < kTextureTargetCount; t++)
+            {
+                GLuint shadow = s_state.textures[u][t];
+                if (shadow != kUnknown)
+                {
+                    checkInteger(where, "texture binding", kTextureTargets[t].binding, shadow);
+                }
+            }
+        }
+        glActiveTexture(GL_TEXTURE0 + s_state.activeUnit);
+    }
+
+    for (unsigned int c = 0; c < kCapCount; c++)
+    {
+        checkCap(where, c);
+    }
+    checkBlendDepthOffset(where);
+    return s_frameStats.validationErrors == before;
+}
+
+void glsBeginFrame()
+{
+    s_frameStats.forwarded = 0;
+    s_frameStats.elided = 0;
+}
+
+GLStateStats glsFrameStats()
+{
+    return s_frameStats;
+}
@@ -0,0 +1,87 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Shadow copy of the GL state the renderer touches every frame: bound
+* program, VAO, buffers (generic and indexed UBO/SSBO ranges), framebuffers,
+* textures per unit, the active unit, enable bits and the blend, depth,
+* color-mask and polygon-offset parameters. The gls* wrappers forward a call only when it
+* changes the shadowed value, so the per-frame code can state what it needs
+* without tracking what the previous pass left behind, and nothing has to
+* be read back from the driver (glIsEnabled and friends are synchronous).
+*
+* Everything starts out unknown, so the first call of each kind is always
+* forwarded. Code that changes tracked state with raw gl* calls (loaders,
+* third-party code) must be followed by glsInvalidate().
+*
+* In validation mode every wrapper also reads the real state back and
+* reports any difference from the shadow: slow, for debugging only.
+*/
+
+#ifndef GLSTATE_HPP
+#define GLSTATE_HPP
+
+struct GLStateStats
+{
+    unsigned int forwarded;         // calls that reached the driver this frame
+    unsigned int elided;            // calls skipped this frame, state already current
+    unsigned int validationErrors;  // shadow/driver mismatches since glsInit()
+};
+
+// Start tracking on the current context; `validate` enables read-back checks
+void glsInit(bool validate);
+
+/*
+* glsInvalidate()
+* ------------------------------------------------------------------
+* Purpose: Forget everything: the next call of each kind is forwarded.
+* Call it after raw GL calls that change tracked state, and after
+* deleting objects: glGen* may hand a deleted name out again while the
+* shadow still records it as bound, and the bind of the new object would
+* then be skipped.
+*/
+void glsInvalidate();
+
+void glsUseProgram(GLuint program);
+void glsBindVertexArray(GLuint vao);   // the element buffer binding follows the VAO
+void glsBindBuffer(GLenum target, GLuint buffer);
+void glsBindBufferBase(GLenum target, GLuint index, GLuint buffer);
+void glsBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+void glsBindFramebuffer(GLenum target, GLuint framebuffer);
+void glsActiveTexture(GLenum unit);
+void glsBindTexture(GLenum target, GLuint texture);  // on the active unit
+
+void glsEnable(GLenum cap);
+void glsDisable(GLenum cap);
+void glsSetEnabled(GLenum cap, bool enabled);
+
+/*
+* glsIsEnabled()
+* ------------------------------------------------------------------
+* Purpose: Answer from the shadow. Falls back to glIsEnabled only when
+* the capability is untracked or still unknown.
+*/
+bool glsIsEnabled(GLenum cap);
+
+void glsBlendFunc(GLenum sfactor, GLenum dfactor);
+void glsDepthFunc(GLenum func);
+void glsDepthMask(GLboolean flag);
+void glsColorMask(GLboolean flag);  // all four channels at once
+void glsPolygonOffset(GLfloat factor, GLfloat units);
+
+/*
+* glsValidate()
+* ------------------------------------------------------------------
+* Purpose: Compare every known shadow entry with the driver and report
+* differences, tagged with `where`. Works with validation mode off too.
+* Returns: true if the shadow matches.
+*/
+bool glsValidate(const char* where);
+
+// Reset the per-frame call counters
+void glsBeginFrame();
+GLStateStats glsFrameStats();
+
+#endif
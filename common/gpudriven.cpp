@@ -0,0 +1,333 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the compute-culled, multi-draw-indirect head path.
+*
+* The indirect buffer holds the draw count followed by one command per LOD:
+*   [uint drawCount][DrawElementsIndirectCommand lod0][lod1]...
+* Each command's baseInstance points at its own region of the instance
+* stream (objectCount entries per LOD), so the shader can append to a LOD
+* with a single atomicAdd on that command's instanceCount.
+*/
+
+#include <stdio.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+#include "meshlod.hpp"
+#include "frustum.hpp"
+#include "gpudriven.hpp"
+#include "glstate.hpp"
+
+// Matches the GL definition and the std430 struct in CullLod.computeshader
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLuint baseVertex;
+    GLuint baseInstance;
+};
+
+// Binding points used by the culling shader
+enum
+{
+    CULL_BINDING_OBJECTS   = 0,  // vec4 positionYaw per object
+    CULL_BINDING_INDIRECT  = 1,  // draw count + commands
+    CULL_BINDING_INSTANCES = 2,  // vec4 per visible object, grouped by LOD
+    CULL_BINDING_IDS       = 3   // object index per visible object (read back)
+};
+
+static const unsigned int kWorkgroupSize = 64;      // local_size_x in the shader
+static const GLintptr     kCommandsOffset = sizeof(GLuint);
+
+// Same thresholds as the CPU paths (meshlod.hpp)
+static const float* const kLodDistance = kMeshLodDistance;
+
+// Module state
+static GLuint s_program = 0;
+static GLuint s_objectBuffer = 0;
+static GLuint s_instanceBuffer = 0;
+static GLuint s_idBuffer = 0;
+static GLuint s_indirectBuffer = 0;
+static GLuint s_vao = 0;
+static GLint  s_planesLocation = -1;
+static GLint  s_cameraLocation = -1;
+static unsigned int s_objectCount = 0;
+static unsigned int s_lodCount = 0;
+static glm::vec4 s_localSphere;
+static std::vector<glm::vec4> s_placements;              // CPU copy for the reference path
+static std::vector<DrawElementsIndirectCommand> s_commandTemplate;
+
+bool gpuDrivenSupported()
+{
+    return GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_multi_draw_indirect);
+}
+
+bool initGpuDriven(const char* computeShaderPath,
+                   const std::vector<glm::vec4>& placements,
+                   const glm::vec4& localSphere,
+                   const std::vector<MeshLod>& lods,
+                   GLuint vertexbuffer, GLuint uvbuffer, GLuint normalbuffer,
+                   GLuint elementbuffer)
+{
+    s_program = LoadComputeShader(computeShaderPath);
+    if (s_program == 0)
+    {
+        return false;
+    }
+
+    s_objectCount = (unsigned int)placements.size();
+    s_lodCount = (unsigned int)std::min<size_t>(lods.size(), GPU_LOD_MAX);
+    s_localSphere = localSphere;
+    s_placements = placements;
+
+    // Everything that never changes is set once
+    glUseProgram(s_program);
+    s_planesLocation = glGetUniformLocation(s_program, "FrustumPlanes");
+    s_cameraLocation = glGetUniformLocation(s_program, "CameraPosition");
+    glUniform4fv(glGetUniformLocation(s_program, "LocalSphere"), 1, &localSphere[0]);
+    glUniform1fv(glGetUniformLocation(s_program, "LodDistances"), GPU_LOD_MAX - 1, kLodDistance);
+    glUniform1ui(glGetUniformLocation(s_program, "ObjectCount"), s_objectCount);
+    glUniform1ui(glGetUniformLocation(s_program, "LodCount"), s_lodCount);
+    glUseProgram(0);
+
+    glGenBuffers(1, &s_objectBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, s_objectBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, placements.size() * sizeof(glm::vec4), &placements[0], GL_STATIC_DRAW);
+
+    // Worst case every object lands in the same LOD, so each LOD gets a
+    // full-size region
+    glGenBuffers(1, &s_instanceBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, s_instanceBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, s_lodCount * s_objectCount * sizeof(glm::vec4), NULL, GL_DYNAMIC_COPY);
+
+    glGenBuffers(1, &s_idBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, s_idBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, s_lodCount * s_objectCount * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Commands with zero instances; the shader fills in instanceCount
+    s_commandTemplate.resize(s_lodCount);
+    for (unsigned int l = 0; l < s_lodCount; l++)
+    {
+        s_commandTemplate[l].count = lods[l].indexCount;
+        s_commandTemplate[l].instanceCount = 0;
+        s_commandTemplate[l].firstIndex = lods[l].firstIndex;
+        s_commandTemplate[l].baseVertex = 0;
+        s_commandTemplate[l].baseInstance = l * s_objectCount;
+    }
+    glGenBuffers(1, &s_indirectBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, s_indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, kCommandsOffset + s_lodCount * sizeof(DrawElementsIndirectCommand),
+                 NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    // Mesh attributes plus the culled instance stream
+    glGenVertexArrays(1, &s_vao);
+    glBindVertexArray(s_vao);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, normalbuffer);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glEnableVertexAttribArray(3);
+    glBindBuffer(GL_ARRAY_BUFFER, s_instanceBuffer);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glVertexAttribDivisor(3, 1); // baseInstance selects the LOD's region
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementbuffer);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    printf("GPU-driven path: %u objects, %u LODs, %s\n", s_objectCount, s_lodCount,
+           GLEW_ARB_indirect_parameters ? "GPU draw count" : "fixed draw count");
+    return true;
+}
+
+void dispatchGpuCulling(const glm::mat4& viewProj, const glm::vec3& cameraPos)
+{
+    glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+    extractFrustumPlanes(viewProj, planes);
+
+    // Reset the draw count and instance counts
+    GLuint zero = 0;
+    glsBindBuffer(GL_DRAW_INDIRECT_BUFFER, s_indirectBuffer);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, kCommandsOffset, &zero);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, kCommandsOffset,
+                    s_lodCount * sizeof(DrawElementsIndirectCommand), &s_commandTemplate[0]);
+
+    glsUseProgram(s_program);
+    glUniform4fv(s_planesLocation, FRUSTUM_PLANE_COUNT, &planes[0][0]);
+    glUniform3fv(s_cameraLocation, 1, &cameraPos[0]);
+    glsBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_BINDING_OBJECTS, s_objectBuffer);
+    glsBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_BINDING_INDIRECT, s_indirectBuffer);
+    glsBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_BINDING_INSTANCES, s_instanceBuffer);
+    glsBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_BINDING_IDS, s_idBuffer);
+    glDispatchCompute((s_objectCount + kWorkgroupSize - 1) / kWorkgroupSize, 1, 1);
+
+    // The draw reads the commands and the instance stream as vertex input
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+void drawGpuDriven()
+{
+    // The indirect and parameter bindings are left in place: the shadow
+    // skips rebinding them next frame and no other draw reads them
+    glsBindVertexArray(s_vao);
+    glsBindBuffer(GL_DRAW_INDIRECT_BUFFER, s_indirectBuffer);
+    if (GLEW_ARB_indirect_parameters)
+    {
+        // Skips the trailing LODs nothing was assigned to
+        glsBindBuffer(GL_PARAMETER_BUFFER_ARB, s_indirectBuffer);
+        glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_SHORT, (const void*)kCommandsOffset,
+                                            0, s_lodCount, sizeof(DrawElementsIndirectCommand));
+    }
+    else
+    {
+        // Commands with instanceCount 0 draw nothing
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, (const void*)kCommandsOffset,
+                                    s_lodCount, sizeof(DrawElementsIndirectCommand));
+    }
+    glsBindVertexArray(0);
+}
+
+void readBackGpuCulling(CullResult& result)
+{
+    result.lodOf.assign(s_objectCount, (unsigned int)CullResult::CULLED);
+    result.margin.clear();
+    result.duplicates = 0;
+    for (unsigned int l = 0; l < GPU_LOD_MAX; l++)
+    {
+        result.lodInstances[l] = 0;
+    }
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    std::vector<DrawElementsIndirectCommand> commands(s_lodCount);
+    glsBindBuffer(GL_DRAW_INDIRECT_BUFFER, s_indirectBuffer);
+    glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER, kCommandsOffset,
+                       s_lodCount * sizeof(DrawElementsIndirectCommand), &commands[0]);
+    glsBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    std::vector<GLuint> ids(s_lodCount * s_objectCount);
+    glsBindBuffer(GL_SHADER_STORAGE_BUFFER, s_idBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, ids.size() * sizeof(GLuint), &ids[0]);
+    glsBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    for (unsigned int l = 0; l < s_lodCount; l++)
+    {
+        unsigned int n = std::min(commands[l].instanceCount, s_objectCount);
+        result.lodInstances[l] = n;
+        for (unsigned int i = 0; i < n; i++)
+        {
+            GLuint id = ids[commands[l].baseInstance + i];
+            if (id >= s_objectCount || result.lodOf[id] != (unsigned int)CullResult::CULLED)
+            {
+                result.duplicates++;
+                continue;
+            }
+            result.lodOf[id] = l;
+        }
+    }
+}
+
+void cullOnCpu(const glm::mat4& viewProj, const glm::vec3& cameraPos, CullResult& result)
+{
+    glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+    extractFrustumPlanes(viewProj, planes);
+
+    result.lodOf.assign(s_objectCount, (unsigned int)CullResult::CULLED);
+    result.margin.assign(s_objectCount, 0.0f);
+    result.duplicates = 0;
+    for (unsigned int l = 0; l < GPU_LOD_MAX; l++)
+    {
+        result.lodInstances[l] = 0;
+    }
+
+    const float radius = s_localSphere.w;
+    for (unsigned int i = 0; i < s_objectCount; i++)
+    {
+        // Same arithmetic as CullLod.computeshader
+        const glm::vec4& p = s_placements[i];
+        float c = cosf(p.w), s = sinf(p.w);
+        glm::vec3 center = glm::vec3(p) + glm::vec3(c * s_localSphere.x - s * s_localSphere.y,
+                                                    s * s_localSphere.x + c * s_localSphere.y,
+                                                    s_localSphere.z);
+        float distance = glm::length(center - cameraPos);
+
+        // Margin: how far the nearest plane / LOD threshold is from flipping
+        float margin = 1e30f;
+        bool visible = true;
+        for (int k = 0; k < FRUSTUM_PLANE_COUNT; k++)
+        {
+            float d = glm::dot(glm::vec3(planes[k]), center) + planes[k].w + radius;
+            margin = std::min(margin, std::fabs(d));
+            visible = visible && d >= 0.0f;
+        }
+
+        unsigned int lod = 0;
+        for (unsigned int k = 0; k + 1 < s_lodCount; k++)
+        {
+            float t = distance / radius - kLodDistance[k];
+            margin = std::min(margin, std::fabs(t) * radius);
+            if (t >= 0.0f)
+            {
+                lod = k + 1;
+            }
+        }
+
+        result.margin[i] = margin / (1.0f + distance);
+        if (visible)
+        {
+            result.lodOf[i] = lod;
+            result.lodInstances[lod]++;
+        }
+    }
+}
+
+CullComparison compareCullResults(const CullResult& gpu, const CullResult& cpu)
+{
+    // Relative slack for differences in GPU trig / fused arithmetic
+    const float kTolerance = 1e-4f;
+
+    CullComparison cmp = { gpu.duplicates, 0 };
+    size_t n = std::min(gpu.lodOf.size(), cpu.lodOf.size());
+    for (size_t i = 0; i < n; i++)
+    {
+        if (gpu.lodOf[i] != cpu.lodOf[i])
+        {
+            cmp.mismatches++;
+            if (i < cpu.margin.size() && cpu.margin[i] < kTolerance)
+            {
+                cmp.borderline++;
+            }
+        }
+    }
+    return cmp;
+}
+
+void cleanupGpuDriven()
+{
+    glDeleteProgram(s_program);
+    glDeleteBuffers(1, &s_objectBuffer);
+    glDeleteBuffers(1, &s_instanceBuffer);
+    glDeleteBuffers(1, &s_idBuffer);
+    glDeleteBuffers(1, &s_indirectBuffer);
+    glDeleteVertexArrays(1, &s_vao);
+    s_program = s_objectBuffer = s_instanceBuffer = s_idBuffer = s_indirectBuffer = s_vao = 0;
+    s_placements.clear();
+    s_commandTemplate.clear();
+}
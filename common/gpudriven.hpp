@@ -0,0 +1,92 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* GPU-driven rendering of the head population (GL 4.3+). Object records
+* (position + yaw) live in a shader storage buffer; a compute shader tests
+* each object's bounding sphere against the view frustum, picks a mesh LOD
+* from its distance to the camera, and appends the visible objects to
+* per-LOD regions of an instance stream while bumping the instance count
+* of that LOD's DrawElementsIndirectCommand. The scene is then drawn with
+* one glMultiDrawElementsIndirect (or the Count variant, which reads the
+* draw count the shader wrote, when ARB_indirect_parameters is present).
+*
+* cullOnCpu() runs the same test on the CPU so the GPU results can be read
+* back and compared (--verify-cull).
+*/
+
+#ifndef GPUDRIVEN_HPP
+#define GPUDRIVEN_HPP
+
+#include <vector>
+
+enum { GPU_LOD_MAX = 4 };
+
+// Per-object outcome of one culling pass
+struct CullResult
+{
+    enum { CULLED = 0xFFFFFFFFu };
+
+    std::vector<unsigned int> lodOf;         // LOD index per object, or CULLED
+    std::vector<float>        margin;        // CPU only: distance to the nearest decision boundary
+    unsigned int lodInstances[GPU_LOD_MAX];  // visible objects per LOD
+    unsigned int duplicates;                 // GPU only: objects emitted more than once
+};
+
+// Comparison of a GPU pass against the CPU reference
+struct CullComparison
+{
+    unsigned int mismatches;  // objects whose LOD / visibility differ
+    unsigned int borderline;  // ... of which lie within float tolerance of a boundary
+};
+
+// True if the context offers compute shaders, SSBOs and multi-draw indirect
+bool gpuDrivenSupported();
+
+/*
+* initGpuDriven()
+* ------------------------------------------------------------------
+* Purpose: Build the compute program, the object / instance / indirect
+* buffers and a VAO that reads the mesh attributes plus the culled
+* instance stream (attribute 3, one vec4 per instance).
+* Inputs:
+* computeShaderPath - the culling compute shader
+* placements  - xyz + yaw per object (see generateScene)
+* localSphere - bounding sphere of the mesh in the placed, un-yawed frame
+* lods        - index ranges inside `elementbuffer`, finest first
+* Returns: false if the compute program could not be built.
+*/
+bool initGpuDriven(const char* computeShaderPath,
+                   const std::vector<glm::vec4>& placements,
+                   const glm::vec4& localSphere,
+                   const std::vector<MeshLod>& lods,
+                   GLuint vertexbuffer, GLuint uvbuffer, GLuint normalbuffer,
+                   GLuint elementbuffer);
+
+/*
+* dispatchGpuCulling()
+* ------------------------------------------------------------------
+* Purpose: Reset the indirect commands, run the culling shader for this
+* view and make its writes visible to the following draw.
+*/
+void dispatchGpuCulling(const glm::mat4& viewProj, const glm::vec3& cameraPos);
+
+// Draw every visible object with one multi-draw indirect call
+void drawGpuDriven();
+
+/*
+* readBackGpuCulling() / cullOnCpu()
+* ------------------------------------------------------------------
+* Purpose: The GPU outcome of the last dispatch (stalls until it is done),
+* and the CPU reference for the same view.
+*/
+void readBackGpuCulling(CullResult& result);
+void cullOnCpu(const glm::mat4& viewProj, const glm::vec3& cameraPos, CullResult& result);
+
+CullComparison compareCullResults(const CullResult& gpu, const CullResult& cpu);
+
+void cleanupGpuDriven();
+
+#endif
@@ -0,0 +1,182 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* EGL setup for the windowless context.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "headless.hpp"
+
+#ifdef HAVE_EGL
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+static EGLDisplay g_display = EGL_NO_DISPLAY;
+static EGLSurface g_surface = EGL_NO_SURFACE;
+static EGLContext g_context = EGL_NO_CONTEXT;
+
+// Whole-word search in a space-separated extension string
+static bool hasExtension(const char* extensions, const char* name)
+{
+    if (!extensions)
+    {
+        return false;
+    }
+    size_t length = strlen(name);
+    for (const char* p = strstr(extensions, name); p; p = strstr(p + length, name))
+    {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+* openDisplay
+* ------------------------------------------------------------------
+* Purpose: Mesa's surfaceless platform needs neither X11, Wayland nor a
+* DRM device; without it, the default display (which may need one).
+*/
+static EGLDisplay openDisplay()
+{
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless") &&
+        hasExtension(clientExtensions, "EGL_EXT_platform_base"))
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+        {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+            if (display != EGL_NO_DISPLAY)
+            {
+                return display;
+            }
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool createHeadlessContext()
+{
+    g_display = openDisplay();
+    EGLint major = 0, minor = 0;
+    if (g_display == EGL_NO_DISPLAY || !eglInitialize(g_display, &major, &minor))
+    {
+        fprintf(stderr, "Headless: no EGL display (0x%x)\n", eglGetError());
+        g_display = EGL_NO_DISPLAY;
+        return false;
+    }
+    const char* extensions = eglQueryString(g_display, EGL_EXTENSIONS);
+    const bool surfaceless = hasExtension(extensions, "EGL_KHR_surfaceless_context");
+    if (!hasExtension(extensions, "EGL_KHR_create_context") || !eglBindAPI(EGL_OPENGL_API))
+    {
+        fprintf(stderr, "Headless: EGL %d.%d cannot create desktop GL core contexts\n", major, minor);
+        destroyHeadlessContext();
+        return false;
+    }
+
+    // The depth and color formats only matter for the pbuffer fallback:
+    // rendering goes to an FBO
+    const EGLint configAttribs[] =
+    {
+        EGL_SURFACE_TYPE,    surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(g_display, configAttribs, &config, 1, &configCount) || configCount == 0)
+    {
+        fprintf(stderr, "Headless: no EGL config for desktop GL\n");
+        destroyHeadlessContext();
+        return false;
+    }
+
+    // Same versions the windowed path asks GLFW for
+    const int contextVersions[2][2] = { {4, 5}, {3, 3} };
+    for (int v = 0; v < 2 && g_context == EGL_NO_CONTEXT; v++)
+    {
+        const EGLint contextAttribs[] =
+        {
+            EGL_CONTEXT_MAJOR_VERSION_KHR, contextVersions[v][0],
+            EGL_CONTEXT_MINOR_VERSION_KHR, contextVersions[v][1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+            EGL_CONTEXT_FLAGS_KHR, EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE_BIT_KHR,
+            EGL_NONE
+        };
+        g_context = eglCreateContext(g_display, config, EGL_NO_CONTEXT, contextAttribs);
+    }
+    if (g_context == EGL_NO_CONTEXT)
+    {
+        fprintf(stderr, "Headless: cannot create a GL 3.3 core context (0x%x)\n", eglGetError());
+        destroyHeadlessContext();
+        return false;
+    }
+
+    if (!surfaceless)
+    {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE };
+        g_surface = eglCreatePbufferSurface(g_display, config, pbufferAttribs);
+        if (g_surface == EGL_NO_SURFACE)
+        {
+            fprintf(stderr, "Headless: cannot create a pbuffer (0x%x)\n", eglGetError());
+            destroyHeadlessContext();
+            return false;
+        }
+    }
+    if (!eglMakeCurrent(g_display, g_surface, g_surface, g_context))
+    {
+        fprintf(stderr, "Headless: cannot make the context current (0x%x)\n", eglGetError());
+        destroyHeadlessContext();
+        return false;
+    }
+    printf("Headless EGL %d.%d context (%s, %s)\n", major, minor, eglQueryString(g_display, EGL_VENDOR),
+        surfaceless ? "surfaceless" : "pbuffer");
+    return true;
+}
+
+void destroyHeadlessContext()
+{
+    if (g_display == EGL_NO_DISPLAY)
+    {
+        return;
+    }
+    eglMakeCurrent(g_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (g_surface != EGL_NO_SURFACE)
+    {
+        eglDestroySurface(g_display, g_surface);
+        g_surface = EGL_NO_SURFACE;
+    }
+    if (g_context != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(g_display, g_context);
+        g_context = EGL_NO_CONTEXT;
+    }
+    eglTerminate(g_display);
+    g_display = EGL_NO_DISPLAY;
+}
+
+#else
+
+bool createHeadlessContext()
+{
+    fprintf(stderr, "Headless: built without EGL\n");
+    return false;
+}
+
+void destroyHeadlessContext()
+{
+}
+
+#endif
@@ -0,0 +1,33 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Windowless OpenGL context through EGL, for benchmark and regression runs
+* on machines without a display server or GPU (Mesa llvmpipe works). The
+* context has at most a tiny pbuffer; frames go to an offscreen
+* RenderTarget of the requested size.
+*
+* Built only when CMake finds EGL (HAVE_EGL); otherwise
+* createHeadlessContext() reports that and fails.
+*/
+
+#ifndef HEADLESS_HPP
+#define HEADLESS_HPP
+
+/*
+* createHeadlessContext()
+* ------------------------------------------------------------------
+* Purpose: Open an EGL display (Mesa's surfaceless platform when offered,
+* the default display otherwise), create a core-profile desktop GL context
+* (4.5, falling back to 3.3) and make it current. Uses a surfaceless
+* context when the driver supports it, a 16x16 pbuffer otherwise.
+* Returns: false if no display, config or context could be had.
+*/
+bool createHeadlessContext();
+
+// Release the context, surface and display
+void destroyHeadlessContext();
+
+#endif
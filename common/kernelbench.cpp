@@ -0,0 +1,52 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the kernel benchmark helpers.
+*/
+
+#include <vector>
+#include <functional>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "clock.hpp"
+#include "scenegen.hpp"
+#include "kernelbench.hpp"
+
+// Every benchmark starts from the same state, so runs are comparable
+static const unsigned int kBenchmarkSeed = 0x9E3779B9u;
+
+void fillBenchmarkRandom(unsigned int count, unsigned int components, std::vector<float>& values)
+{
+    values.resize(size_t(count) * components);
+    unsigned int state = kBenchmarkSeed;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        values[i] = nextRandom(state);
+    }
+}
+
+glm::mat4 benchmarkViewProjection()
+{
+    glm::mat4 V = glm::lookAt(glm::vec3(0.0f, -160.0f, 60.0f), glm::vec3(0.0f), glm::vec3(0, 0, 1));
+    glm::mat4 P = glm::perspective(glm::radians(60.0f), 4.0f / 3.0f, 0.1f, 400.0f);
+    return P * V;
+}
+
+double measureThroughput(unsigned int items, const std::function<void()>& pass)
+{
+    unsigned int passes = 0;
+    double start = clockSeconds();
+    double elapsed = 0.0;
+    do
+    {
+        pass();
+        passes++;
+        elapsed = clockSeconds() - start;
+    } while (elapsed < 0.5);
+    return double(items) * passes / elapsed * 1e-6;
+}
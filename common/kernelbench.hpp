@@ -0,0 +1,49 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Shared scaffolding of the CPU kernel benchmarks (--cull-bench,
+* --transform-bench): seeded random input, the fixed camera they view it
+* from, and a timed repeat loop, so every kernel is measured the same way.
+*/
+
+#ifndef KERNELBENCH_HPP
+#define KERNELBENCH_HPP
+
+#include <vector>
+#include <functional>
+
+#include <glm/glm.hpp>
+
+/*
+* fillBenchmarkRandom()
+* ------------------------------------------------------------------
+* Purpose: Fill `values` with count * components uniform floats in [0, 1)
+* from nextRandom() and a fixed seed; object i reads
+* values[i * components .. (i + 1) * components).
+*/
+void fillBenchmarkRandom(unsigned int count, unsigned int components, std::vector<float>& values);
+
+/*
+* benchmarkViewProjection()
+* ------------------------------------------------------------------
+* Purpose: The benchmarks' camera: 60 degree, 4:3 perspective from
+* (0, -160, 60) toward the origin, so a 200-unit cube of objects is
+* partly in view.
+*/
+glm::mat4 benchmarkViewProjection();
+
+/*
+* measureThroughput()
+* ------------------------------------------------------------------
+* Purpose: Repeat pass() for at least half a second of wall time.
+* Returns: millions of items per second, for `items` per pass.
+*/
+double measureThroughput(unsigned int items, const std::function<void()>& pass);
+
+// "agree" / "DISAGREE", for the kernel comparison lines
+inline const char* agreementText(bool agree) { return agree ? "agree" : "DISAGREE"; }
+
+#endif
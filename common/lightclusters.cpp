@@ -0,0 +1,512 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the clustered light assignment (CPU and compute paths)
+* and of the ring light generator.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+#include "glstate.hpp"
+#include "clock.hpp"
+#include "profiler.hpp"
+#include "cpufeatures.hpp"
+#include "scenegen.hpp"
+#include "alignedvector.hpp"
+#include "streambuffer.hpp"
+#include "lightclusters.hpp"
+
+const unsigned int LightClusters::kTilesX;
+const unsigned int LightClusters::kTilesY;
+const unsigned int LightClusters::kSlices;
+const unsigned int LightClusters::kClusterCount;
+const unsigned int LightClusters::kMaxLightsPerCluster;
+
+static const unsigned int kTilesPerSlice = LightClusters::kTilesX * LightClusters::kTilesY;
+
+// Texture buffer order in m_textures / the shader's units
+enum
+{
+    TEXTURE_GRID    = 0,
+    TEXTURE_INDICES = 1,
+    TEXTURE_LIGHTS  = 2
+};
+
+// Binding points used by ClusterLights.computeshader
+enum
+{
+    CLUSTER_BINDING_LIGHTS  = 0,
+    CLUSTER_BINDING_GRID    = 1,
+    CLUSTER_BINDING_INDICES = 2
+};
+
+static const unsigned int kWorkgroupSize = 64;  // local_size_x in the shader
+
+// Padding lights sit this far away with radius 0, so they never pass
+static const float kFarAway = 1e30f;
+
+// Slice 0 ends at this fraction of the clustered depth range
+static const float kSplitRatio = 32.0f;
+
+// Implemented in lightclusters_avx2.cpp
+bool lightClustersAvx2Compiled();
+unsigned int spheresInBoxAvx2(const float* x, const float* y, const float* z, const float* r,
+                              unsigned int count, const float boxMin[3], const float boxMax[3],
+                              unsigned int* hits);
+
+/*
+* spheresInBoxScalar
+* ------------------------------------------------------------------
+* Purpose: Append the index of every sphere [0, count) that overlaps the
+* box: the squared distance from its center to the box is at most r^2.
+* Returns: the number of indices written.
+*/
+static unsigned int spheresInBoxScalar(const float* x, const float* y, const float* z, const float* r,
+                                       unsigned int count, const float boxMin[3], const float boxMax[3],
+                                       unsigned int* hits)
+{
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        float dx = std::max(std::max(boxMin[0] - x[i], x[i] - boxMax[0]), 0.0f);
+        float dy = std::max(std::max(boxMin[1] - y[i], y[i] - boxMax[1]), 0.0f);
+        float dz = std::max(std::max(boxMin[2] - z[i], z[i] - boxMax[2]), 0.0f);
+        if (dx * dx + dy * dy + dz * dz <= r[i] * r[i])
+        {
+            hits[n++] = i;
+        }
+    }
+    return n;
+}
+
+static inline unsigned int spheresInBox(bool avx2, const float* x, const float* y, const float* z,
+                                        const float* r, unsigned int count, const float boxMin[3],
+                                        const float boxMax[3], unsigned int* hits)
+{
+    return avx2 ? spheresInBoxAvx2(x, y, z, r, count, boxMin, boxMax, hits)
+                : spheresInBoxScalar(x, y, z, r, count, boxMin, boxMax, hits);
+}
+
+static void resizePadded(AlignedVector<float>& x, AlignedVector<float>& y, AlignedVector<float>& z,
+                         AlignedVector<float>& r, unsigned int count)
+{
+    unsigned int padded = (count + 7) & ~7u;
+    x.resize(padded);
+    y.resize(padded);
+    z.resize(padded);
+    r.resize(padded);
+    for (unsigned int i = count; i < padded; i++)
+    {
+        x[i] = y[i] = z[i] = kFarAway;
+        r[i] = 0.0f;
+    }
+}
+
+void generateRingLights(unsigned int count, float sceneRadius, std::vector<PointLight>& lights)
+{
+    const float inner = 0.5f * sceneRadius;
+    const float outer = 1.5f * sceneRadius + 1.0f;
+
+    // Radius from the area each light gets: about a dozen lights overlap
+    // any point whatever the count
+    const float area = 3.14159265f * (outer * outer - inner * inner);
+    const float radius = std::max(0.25f, 1.25f * sqrtf(area / float(count)));
+
+    lights.resize(count);
+    unsigned int state = 12345u;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        float u[4];
+        for (int k = 0; k < 4; k++)
+        {
+            u[k] = nextRandom(state);
+        }
+        float angle = 6.2831853f * u[0];
+        float distance = sqrtf(inner * inner + u[1] * (outer * outer - inner * inner)); // uniform over the area
+        float height = 0.3f + 1.7f * u[2];
+        lights[i].positionRadius = glm::vec4(distance * cosf(angle), distance * sinf(angle), height, radius);
+
+        // Saturated hue around the color wheel
+        float h = 6.0f * u[3];
+        glm::vec3 rgb(glm::clamp(fabsf(h - 3.0f) - 1.0f, 0.0f, 1.0f),
+                      glm::clamp(2.0f - fabsf(h - 2.0f), 0.0f, 1.0f),
+                      glm::clamp(2.0f - fabsf(h - 4.0f), 0.0f, 1.0f));
+        float intensity = 0.6f * (0.25f * radius * radius + 1.0f);
+        lights[i].color = glm::vec4(rgb * intensity, 0.0f);
+    }
+}
+
+LightClusters::LightClusters()
+    : m_near(0.0f), m_far(0.0f), m_tanHalfX(0.0f), m_tanHalfY(0.0f), m_split(1.0f), m_sliceFar(1.0f),
+      m_avx2(false), m_lightBuffer(0), m_streamTarget(0), m_computeProgram(0),
+      m_gridBuffer(0), m_indexBuffer(0), m_viewLocation(-1), m_frustumLocation(-1), m_offsets(0u)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        m_textures[i] = 0;
+    }
+    memset(m_sliceDepth, 0, sizeof(m_sliceDepth));
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+static GLuint createBuffer(GLsizeiptr bytes, const void* data, GLenum usage)
+{
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glsBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, bytes, data, usage);
+    glsBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return buffer;
+}
+
+static void pointTexture(GLuint texture, GLenum format, GLuint buffer)
+{
+    glsBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    glsBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+bool LightClusters::init(const std::vector<PointLight>& lights, unsigned int threads,
+                         const char* computeShaderPath)
+{
+    destroy();
+    if (lights.empty())
+    {
+        return false;
+    }
+    m_lights = lights;
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.lights = (unsigned int)lights.size();
+
+    resizePadded(m_viewX, m_viewY, m_viewZ, m_viewR, m_stats.lights);
+    m_lightBuffer = createBuffer(GLsizeiptr(lights.size() * sizeof(PointLight)), &lights[0], GL_STATIC_DRAW);
+    glGenTextures(3, m_textures);
+    pointTexture(m_textures[TEXTURE_LIGHTS], GL_RGBA32F, m_lightBuffer);
+
+    // GPU path: the compute shader writes fixed-size lists in place
+    bool computeSupported = GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object);
+    if (computeShaderPath && computeSupported)
+    {
+        m_computeProgram = LoadComputeShader(computeShaderPath);
+    }
+    if (m_computeProgram)
+    {
+        glUseProgram(m_computeProgram);
+        m_viewLocation = glGetUniformLocation(m_computeProgram, "View");
+        m_frustumLocation = glGetUniformLocation(m_computeProgram, "Frustum");
+        glUniform1ui(glGetUniformLocation(m_computeProgram, "LightCount"), m_stats.lights);
+        glUseProgram(0);
+
+        m_gridBuffer = createBuffer(kClusterCount * 2 * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+        m_indexBuffer = createBuffer(kClusterCount * kMaxLightsPerCluster * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+        pointTexture(m_textures[TEXTURE_GRID], GL_RG32UI, m_gridBuffer);
+        pointTexture(m_textures[TEXTURE_INDICES], GL_R32UI, m_indexBuffer);
+        m_offsets = glm::uvec4(0u);
+        return true;
+    }
+    if (computeShaderPath)
+    {
+        printf("Light assignment shader unavailable, assigning lights on the CPU\n");
+    }
+
+    // CPU path: the grid plus room for ~4 lights per cluster to start
+    m_slices.resize(kSlices);
+    m_avx2 = lightClustersAvx2Compiled() && cpuSupportsAvx2();
+    m_pool.start(threads);
+    m_stream.init(kClusterCount * 2 * sizeof(GLuint) + kClusterCount * 4 * sizeof(GLuint));
+    attachStream();
+    return true;
+}
+
+void LightClusters::destroy()
+{
+    m_pool.stop();
+    m_stream.destroy();
+    m_streamTarget = 0;
+    if (m_textures[0])
+    {
+        glDeleteTextures(3, m_textures);
+        for (int i = 0; i < 3; i++)
+        {
+            m_textures[i] = 0;
+        }
+    }
+    GLuint buffers[3] = { m_lightBuffer, m_gridBuffer, m_indexBuffer };
+    glDeleteBuffers(3, buffers);
+    m_lightBuffer = m_gridBuffer = m_indexBuffer = 0;
+    if (m_computeProgram)
+    {
+        glDeleteProgram(m_computeProgram);
+        m_computeProgram = 0;
+    }
+    m_lights.clear();
+    glsInvalidate();
+}
+
+// The stream's buffer changes name when it grows
+void LightClusters::attachStream()
+{
+    if (m_streamTarget == m_stream.buffer())
+    {
+        return;
+    }
+    m_streamTarget = m_stream.buffer();
+    pointTexture(m_textures[TEXTURE_GRID], GL_RG32UI, m_streamTarget);
+    pointTexture(m_textures[TEXTURE_INDICES], GL_R32UI, m_streamTarget);
+}
+
+/*
+* setView
+* ------------------------------------------------------------------
+* Purpose: Take the camera (glm::perspective: [2][2] = -(f+n)/(f-n),
+* [3][2] = -2fn/(f-n)), move the lights into view space and place the
+* depth slices. The grid only has to reach as deep as the farthest light
+* does: slice 0 spans the camera to a split depth, the others are spaced
+* exponentially from there to that depth. Fragments beyond it fall into
+* the last slice, where no light reaches them anyway.
+*/
+void LightClusters::setView(const glm::mat4& view, const glm::mat4& projection)
+{
+    m_near = projection[3][2] / (projection[2][2] - 1.0f);
+    m_far = projection[3][2] / (projection[2][2] + 1.0f);
+    m_tanHalfX = 1.0f / projection[0][0];
+    m_tanHalfY = 1.0f / projection[1][1];
+
+    float reach = 0.0f;
+    for (unsigned int i = 0; i < m_stats.lights; i++)
+    {
+        const glm::vec4& pr = m_lights[i].positionRadius;
+        glm::vec4 p = view * glm::vec4(pr.x, pr.y, pr.z, 1.0f);
+        m_viewX[i] = p.x;
+        m_viewY[i] = p.y;
+        m_viewZ[i] = -p.z;  // depth, positive in front of the camera
+        m_viewR[i] = pr.w;
+        reach = std::max(reach, m_viewZ[i] + pr.w);
+    }
+    m_sliceFar = glm::clamp(reach, 2.0f * m_near * kSplitRatio, m_far);
+    m_split = m_sliceFar / kSplitRatio;
+
+    m_sliceDepth[0] = 0.0f;
+    for (unsigned int k = 1; k <= kSlices; k++)
+    {
+        m_sliceDepth[k] = m_split * powf(kSplitRatio, float(k - 1) / float(kSlices - 1));
+    }
+}
+
+void LightClusters::update(const glm::mat4& view, const glm::mat4& projection)
+{
+    double start = clockSeconds();
+    setView(view, projection);
+    if (m_computeProgram)
+    {
+        assignOnGpu(view);
+    }
+    else
+    {
+        assignOnCpu();
+    }
+    m_stats.assignMs = (clockSeconds() - start) * 1000.0;
+}
+
+void LightClusters::endFrame()
+{
+    if (!m_computeProgram)
+    {
+        m_stream.endFrame();
+    }
+}
+
+/*
+* assignSlice
+* ------------------------------------------------------------------
+* Purpose: Build the lists of one depth slice: keep the lights that reach
+* the slice at all, then test only those against each of its clusters.
+* Runs on a pool thread; writes nothing but m_slices[slice].
+*/
+void LightClusters::assignSlice(unsigned int slice)
+{
+    SliceLists& s = m_slices[slice];
+    const float d0 = m_sliceDepth[slice];
+    const float d1 = m_sliceDepth[slice + 1];
+
+    // Cluster boxes: a tile's x (y) range at depth d is ndc * d * tanHalf,
+    // so the extremes are found at the slice's near or far depth
+    for (unsigned int j = 0; j < kTilesY; j++)
+    {
+        const float y0 = -1.0f + 2.0f * float(j) / float(kTilesY);
+        const float y1 = -1.0f + 2.0f * float(j + 1) / float(kTilesY);
+        for (unsigned int i = 0; i < kTilesX; i++)
+        {
+            const float x0 = -1.0f + 2.0f * float(i) / float(kTilesX);
+            const float x1 = -1.0f + 2.0f * float(i + 1) / float(kTilesX);
+            ClusterBounds& b = s.bounds[j * kTilesX + i];
+            b.min[0] = std::min(x0 * d0, x0 * d1) * m_tanHalfX;
+            b.max[0] = std::max(x1 * d0, x1 * d1) * m_tanHalfX;
+            b.min[1] = std::min(y0 * d0, y0 * d1) * m_tanHalfY;
+            b.max[1] = std::max(y1 * d0, y1 * d1) * m_tanHalfY;
+            b.min[2] = d0;
+            b.max[2] = d1;
+        }
+    }
+    ClusterBounds sliceBox;
+    sliceBox.min[0] = -d1 * m_tanHalfX;
+    sliceBox.max[0] = d1 * m_tanHalfX;
+    sliceBox.min[1] = -d1 * m_tanHalfY;
+    sliceBox.max[1] = d1 * m_tanHalfY;
+    sliceBox.min[2] = d0;
+    sliceBox.max[2] = d1;
+
+    const unsigned int padded = (unsigned int)m_viewX.size();
+    s.candidates.resize(padded);
+    unsigned int n = spheresInBox(m_avx2, &m_viewX[0], &m_viewY[0], &m_viewZ[0], &m_viewR[0], padded,
+                                  sliceBox.min, sliceBox.max, &s.candidates[0]);
+
+    resizePadded(s.x, s.y, s.z, s.r, n);
+    for (unsigned int c = 0; c < n; c++)
+    {
+        unsigned int light = s.candidates[c];
+        s.x[c] = m_viewX[light];
+        s.y[c] = m_viewY[light];
+        s.z[c] = m_viewZ[light];
+        s.r[c] = m_viewR[light];
+    }
+
+    const unsigned int candidatesPadded = (unsigned int)s.x.size();
+    s.hits.resize(std::max(candidatesPadded, 1u));
+    s.indices.clear();
+    s.longest = 0;
+    s.overflows = 0;
+    const ClusterBounds* bounds = s.bounds;
+    for (unsigned int t = 0; t < kTilesPerSlice; t++)
+    {
+        unsigned int hits = 0;
+        if (n > 0)
+        {
+            hits = spheresInBox(m_avx2, &s.x[0], &s.y[0], &s.z[0], &s.r[0], candidatesPadded,
+                                bounds[t].min, bounds[t].max, &s.hits[0]);
+        }
+        if (hits > kMaxLightsPerCluster)
+        {
+            hits = kMaxLightsPerCluster;
+            s.overflows++;
+        }
+        for (unsigned int h = 0; h < hits; h++)
+        {
+            s.indices.push_back(s.candidates[s.hits[h]]);
+        }
+        s.counts[t] = hits;
+        s.longest = std::max(s.longest, hits);
+    }
+}
+
+void LightClusters::assignOnCpu()
+{
+    {
+        PROFILE_SCOPE("assign slices");
+        m_pool.parallelFor(kSlices, [this](unsigned int slice, unsigned int) { assignSlice(slice); });
+    }
+
+    size_t total = 0;
+    m_stats.maxPerCluster = 0;
+    m_stats.overflows = 0;
+    for (unsigned int k = 0; k < kSlices; k++)
+    {
+        total += m_slices[k].indices.size();
+        m_stats.maxPerCluster = std::max(m_stats.maxPerCluster, m_slices[k].longest);
+        m_stats.overflows += m_slices[k].overflows;
+    }
+    m_stats.listEntries = (unsigned int)total;
+
+    // Grow between frames if this frame's lists would not fit (the stream
+    // gets a new buffer, so the textures are re-pointed)
+    const GLsizeiptr gridBytes = kClusterCount * 2 * sizeof(GLuint);
+    const GLsizeiptr listBytes = GLsizeiptr(std::max<size_t>(total, 1) * sizeof(GLuint));
+    const GLsizeiptr needed = gridBytes + listBytes + 16;
+    if (needed > m_stream.segmentBytes())
+    {
+        m_stream.resize(needed + needed / 2);
+        attachStream();
+    }
+
+    m_stream.beginFrame();
+    StreamAllocation grid = m_stream.allocate(gridBytes);
+    StreamAllocation list = m_stream.allocate(listBytes);
+    if (!grid.data || !list.data)
+    {
+        return;
+    }
+    GLuint* gridOut = (GLuint*)grid.data;
+    GLuint* listOut = (GLuint*)list.data;
+    GLuint first = 0;
+    for (unsigned int k = 0; k < kSlices; k++)
+    {
+        const SliceLists& s = m_slices[k];
+        if (!s.indices.empty())
+        {
+            memcpy(listOut + first, &s.indices[0], s.indices.size() * sizeof(GLuint));
+        }
+        for (unsigned int t = 0; t < kTilesPerSlice; t++)
+        {
+            unsigned int c = k * kTilesPerSlice + t;
+            gridOut[2 * c] = first;
+            gridOut[2 * c + 1] = s.counts[t];
+            first += s.counts[t];
+        }
+    }
+    m_stream.flush();
+    m_offsets = glm::uvec4(GLuint(grid.offset / (2 * sizeof(GLuint))), GLuint(list.offset / sizeof(GLuint)), 0u, 0u);
+}
+
+void LightClusters::assignOnGpu(const glm::mat4& view)
+{
+    glsUseProgram(m_computeProgram);
+    glUniformMatrix4fv(m_viewLocation, 1, GL_FALSE, &view[0][0]);
+    glUniform4f(m_frustumLocation, m_tanHalfX, m_tanHalfY, m_split, m_sliceFar);
+    glsBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_BINDING_LIGHTS, m_lightBuffer);
+    glsBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_BINDING_GRID, m_gridBuffer);
+    glsBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_BINDING_INDICES, m_indexBuffer);
+    glDispatchCompute((kClusterCount + kWorkgroupSize - 1) / kWorkgroupSize, 1, 1);
+
+    // The fragment shader reads the lists through texture buffers
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void LightClusters::bindTextures(unsigned int firstUnit) const
+{
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        glsActiveTexture(GL_TEXTURE0 + firstUnit + i);
+        glsBindTexture(GL_TEXTURE_BUFFER, m_textures[i]);
+    }
+    glsActiveTexture(GL_TEXTURE0);
+}
+
+glm::vec4 LightClusters::shaderParams(int width, int height) const
+{
+    // slice = 1 + (kSlices - 1) * log(depth / split) / log(kSplitRatio),
+    // clamped to [0, kSlices - 1] by the shader
+    const float scale = float(kSlices - 1) / logf(kSplitRatio);
+    return glm::vec4(float(kTilesX) / float(width), float(kTilesY) / float(height),
+                     scale, 1.0f - logf(m_split) * scale);
+}
+
+const char* LightClusters::kernelName() const
+{
+    if (m_computeProgram)
+    {
+        return "compute shader";
+    }
+    return m_avx2 ? "AVX2 kernel" : "scalar kernel";
+}
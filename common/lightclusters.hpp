@@ -0,0 +1,173 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Clustered forward lighting for many point lights. The view frustum is cut
+* into a kTilesX x kTilesY x kSlices grid of clusters ("froxels": screen
+* tiles times depth slices spaced exponentially out to the farthest depth
+* any light reaches). Every frame each cluster gets the list of lights whose sphere
+* of influence overlaps its view-space bounding box, and the fragment
+* shader (CLUSTERED_LIGHTS variant of StandardShading) loops over only the
+* list of the cluster it falls in, so shading cost follows the lights that
+* actually reach a pixel rather than the total light count.
+*
+* Assignment runs on the CPU by default: one worker-pool task per depth
+* slice first narrows the lights down to the ones reaching that slice,
+* then tests them against the slice's clusters eight at a time (AVX2 when
+* the CPU supports it, scalar otherwise). The lists are compacted into one
+* index array and streamed to the GPU with the cluster grid. With GL 4.3
+* an optional compute shader (ClusterLights.computeshader) builds the same
+* grid on the GPU instead, with a fixed-capacity list per cluster.
+*
+* The shader reads everything through texture buffers (GL 3.1 core):
+*   grid     RG32UI  per cluster: first list entry, light count
+*   indices  R32UI   light index per list entry
+*   lights   RGBA32F two texels per light: position + radius, color
+* Grid and index texels are addressed from the bases in shaderOffsets(),
+* because the streamed arrays sit at a different place every frame.
+*/
+
+#ifndef LIGHTCLUSTERS_HPP
+#define LIGHTCLUSTERS_HPP
+
+#include <vector>
+
+#include "workerpool.hpp"
+
+// One point light; the layout is the two texels the shader fetches
+struct PointLight
+{
+    glm::vec4 positionRadius;  // world position, radius of influence
+    glm::vec4 color;           // rgb: color times intensity
+};
+
+struct LightClusterStats
+{
+    unsigned int lights;          // lights in the scene
+    unsigned int listEntries;     // light references over all clusters, last frame
+    unsigned int maxPerCluster;   // longest cluster list, last frame
+    unsigned int overflows;       // clusters that hit kMaxLightsPerCluster, last frame
+    double       assignMs;        // CPU time of the last update()
+};
+
+/*
+* generateRingLights()
+* ------------------------------------------------------------------
+* Purpose: Scatter `count` colored lights (fixed seed) over an annulus
+* around a scene of radius `sceneRadius`, at heights a little above the
+* floor. Radii shrink as the count grows, so every point of the scene is
+* reached by a roughly constant number of lights.
+*/
+void generateRingLights(unsigned int count, float sceneRadius, std::vector<PointLight>& lights);
+
+class LightClusters
+{
+public:
+    static const unsigned int kTilesX = 24;
+    static const unsigned int kTilesY = 16;
+    static const unsigned int kSlices = 32;
+    static const unsigned int kClusterCount = kTilesX * kTilesY * kSlices;
+
+    // Lights kept per cluster; the rest are dropped (and counted)
+    static const unsigned int kMaxLightsPerCluster = 128;
+
+    LightClusters();
+
+    /*
+    * init()
+    * ------------------------------------------------------------------
+    * Purpose: Upload the (static) lights and create the texture buffers.
+    * With a compute shader path and GL 4.3 the clusters are assigned on
+    * the GPU; otherwise `threads` pool threads assign them on the CPU.
+    * Returns: false if no light was given.
+    */
+    bool init(const std::vector<PointLight>& lights, unsigned int threads,
+              const char* computeShaderPath = NULL);
+    void destroy();
+
+    /*
+    * update()
+    * ------------------------------------------------------------------
+    * Purpose: Build this frame's cluster lists for the camera (a symmetric
+    * perspective projection) and make them visible to the shader. Call
+    * before the draws, once per frame, and endFrame() after them.
+    */
+    void update(const glm::mat4& view, const glm::mat4& projection);
+    void endFrame();
+
+    // Bind the grid, index and light texture buffers to units
+    // firstUnit .. firstUnit + 2; GL_TEXTURE0 is active again afterwards
+    void bindTextures(unsigned int firstUnit) const;
+
+    // PerFrame.ClusterParams for a `width` x `height` viewport: xy tiles
+    // per pixel, zw slice = log(depth) * z + w
+    glm::vec4 shaderParams(int width, int height) const;
+
+    // PerFrame.ClusterOffsets: x grid base texel, y index base texel
+    glm::uvec4 shaderOffsets() const { return m_offsets; }
+
+    bool gpuAssignment() const { return m_computeProgram != 0; }
+    const char* kernelName() const;
+    const LightClusterStats& stats() const { return m_stats; }
+
+private:
+    LightClusters(const LightClusters&);
+    LightClusters& operator=(const LightClusters&);
+
+    // View-space box of one cluster (depth is positive away from the camera)
+    struct ClusterBounds
+    {
+        float min[3];
+        float max[3];
+    };
+
+    // Per depth slice work area, only touched by that slice's task
+    struct SliceLists
+    {
+        AlignedVector<float>       x, y, z, r;   // lights reaching the slice, padded to 8
+        std::vector<unsigned int>  candidates;   // their light indices
+        std::vector<unsigned int>  hits;         // kernel output for one cluster
+        std::vector<unsigned int>  indices;      // the slice's compacted lists
+        ClusterBounds              bounds[kTilesX * kTilesY];
+        unsigned int               counts[kTilesX * kTilesY];
+        unsigned int               longest;      // longest list in the slice
+        unsigned int               overflows;    // lists cut at kMaxLightsPerCluster
+    };
+
+    void setView(const glm::mat4& view, const glm::mat4& projection);
+    void assignSlice(unsigned int slice);
+    void assignOnCpu();
+    void assignOnGpu(const glm::mat4& view);
+    void attachStream();
+
+    std::vector<PointLight>     m_lights;
+    float                       m_near;
+    float                       m_far;
+    float                       m_tanHalfX;
+    float                       m_tanHalfY;
+    float                       m_split;        // end of slice 0
+    float                       m_sliceFar;     // end of the last slice
+    float                       m_sliceDepth[kSlices + 1];
+
+    AlignedVector<float>        m_viewX, m_viewY, m_viewZ, m_viewR;  // lights in view space, padded
+    std::vector<SliceLists>     m_slices;
+    bool                        m_avx2;
+    WorkerPool                  m_pool;
+
+    GLuint                      m_lightBuffer;
+    GLuint                      m_textures[3];  // grid, indices, lights
+    StreamBuffer                m_stream;       // CPU path: grid + lists each frame
+    GLuint                      m_streamTarget; // buffer the CPU path's textures point at
+    GLuint                      m_computeProgram;
+    GLuint                      m_gridBuffer;   // GPU path
+    GLuint                      m_indexBuffer;
+    GLint                       m_viewLocation;
+    GLint                       m_frustumLocation;
+    glm::uvec4                  m_offsets;
+
+    LightClusterStats           m_stats;
+};
+
+#endif
@@ -0,0 +1,83 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* AVX2/FMA sphere-box kernel of the light assignment (see cpufeatures.hpp).
+*/
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "cpufeatures.hpp"
+
+#if defined(__AVX2__)
+
+bool lightClustersAvx2Compiled()
+{
+    return true;
+}
+
+/*
+* spheresInBoxAvx2
+* ------------------------------------------------------------------
+* Purpose: Eight spheres per iteration: the per-axis distance from the
+* center to the box is max(min - c, c - max, 0), its squared length is
+* formed with FMAs and compared with r^2; passing lanes are appended to
+* `hits` in order.
+* Inputs: count is a multiple of 8; padding spheres never pass.
+*/
+unsigned int spheresInBoxAvx2(const float* x, const float* y, const float* z, const float* r,
+                              unsigned int count, const float boxMin[3], const float boxMax[3],
+                              unsigned int* hits)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 minX = _mm256_set1_ps(boxMin[0]);
+    const __m256 minY = _mm256_set1_ps(boxMin[1]);
+    const __m256 minZ = _mm256_set1_ps(boxMin[2]);
+    const __m256 maxX = _mm256_set1_ps(boxMax[0]);
+    const __m256 maxY = _mm256_set1_ps(boxMax[1]);
+    const __m256 maxZ = _mm256_set1_ps(boxMax[2]);
+
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < count; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 cz = _mm256_loadu_ps(z + i);
+        __m256 cr = _mm256_loadu_ps(r + i);
+
+        __m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minX, cx), _mm256_sub_ps(cx, maxX)), zero);
+        __m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minY, cy), _mm256_sub_ps(cy, maxY)), zero);
+        __m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minZ, cz), _mm256_sub_ps(cz, maxZ)), zero);
+        __m256 d2 = _mm256_mul_ps(dx, dx);
+        d2 = _mm256_fmadd_ps(dy, dy, d2);
+        d2 = _mm256_fmadd_ps(dz, dz, d2);
+
+        unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_mul_ps(cr, cr), _CMP_LE_OQ));
+        while (mask)
+        {
+            hits[n++] = i + lowestBit(mask);
+            mask &= mask - 1;
+        }
+    }
+    return n;
+}
+
+#else
+
+bool lightClustersAvx2Compiled()
+{
+    return false;
+}
+
+unsigned int spheresInBoxAvx2(const float*, const float*, const float*, const float*,
+                              unsigned int, const float[3], const float[3],
+                              unsigned int*)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Vertex-clustering LOD builder and bounding-sphere helper.
+*/
+
+#include <stdio.h>
+#include <cmath>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "meshlod.hpp"
+
+const float kMeshLodDistance[MESH_LOD_MAX - 1] = { 12.0f, 30.0f, 60.0f };
+
+unsigned int selectMeshLod(float distanceInRadii, unsigned int lodCount)
+{
+    unsigned int lod = 0;
+    for (unsigned int k = 0; k + 1 < lodCount && k < MESH_LOD_MAX - 1; k++)
+    {
+        if (distanceInRadii >= kMeshLodDistance[k])
+        {
+            lod = k + 1;
+        }
+    }
+    return lod;
+}
+
+/*
+* clusterIndices
+* ------------------------------------------------------------------
+* Purpose: One clustered LOD: snap every vertex to the representative of
+* its grid cell and keep only triangles whose three corners stay distinct.
+*/
+static void clusterIndices(const std::vector<unsigned short>& indices,
+                           const std::vector<glm::vec3>& positions,
+                           const glm::vec3& boxMin, float cellSize,
+                           std::vector<unsigned short>& out)
+{
+    std::map<unsigned long long, unsigned short> cellRep;  // cell key -> vertex
+    std::vector<unsigned short> remap(positions.size());
+    for (size_t v = 0; v < positions.size(); v++)
+    {
+        glm::vec3 c = (positions[v] - boxMin) / cellSize;
+        unsigned long long key = ((unsigned long long)(unsigned int)c.x << 42) |
+                                 ((unsigned long long)(unsigned int)c.y << 21) |
+                                  (unsigned long long)(unsigned int)c.z;
+        std::map<unsigned long long, unsigned short>::iterator it = cellRep.find(key);
+        if (it == cellRep.end())
+        {
+            it = cellRep.insert(std::make_pair(key, (unsigned short)v)).first;
+        }
+        remap[v] = it->second;
+    }
+
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        unsigned short a = remap[indices[t]];
+        unsigned short b = remap[indices[t + 1]];
+        unsigned short c = remap[indices[t + 2]];
+        if (a != b && b != c && a != c)
+        {
+            out.push_back(a);
+            out.push_back(b);
+            out.push_back(c);
+        }
+    }
+}
+
+void buildMeshLods(const std::vector<unsigned short>& indices,
+                   const std::vector<glm::vec3>& positions,
+                   const unsigned int* gridResolutions, unsigned int resolutionCount,
+                   std::vector<unsigned short>& outIndices,
+                   std::vector<MeshLod>& outLods)
+{
+    outIndices.clear();
+    outLods.clear();
+
+    MeshLod lod0 = { 0, (unsigned int)indices.size() };
+    outIndices.insert(outIndices.end(), indices.begin(), indices.end());
+    outLods.push_back(lod0);
+    if (positions.empty())
+    {
+        return;
+    }
+
+    glm::vec3 boxMin = positions[0], boxMax = positions[0];
+    for (size_t v = 1; v < positions.size(); v++)
+    {
+        boxMin = glm::min(boxMin, positions[v]);
+        boxMax = glm::max(boxMax, positions[v]);
+    }
+    glm::vec3 extent = boxMax - boxMin;
+    float longest = std::max(extent.x, std::max(extent.y, extent.z));
+
+    for (unsigned int r = 0; r < resolutionCount; r++)
+    {
+        if (gridResolutions[r] == 0)
+        {
+            continue;
+        }
+        MeshLod lod;
+        lod.firstIndex = (unsigned int)outIndices.size();
+        clusterIndices(indices, positions, boxMin, longest / gridResolutions[r] * 1.0001f, outIndices);
+        lod.indexCount = (unsigned int)outIndices.size() - lod.firstIndex;
+        outLods.push_back(lod);
+        printf("Mesh LOD %u: %u triangles (LOD 0: %u)\n", (unsigned int)outLods.size() - 1,
+               lod.indexCount / 3, lod0.indexCount / 3);
+    }
+}
+
+glm::vec4 computeBoundingSphere(const std::vector<glm::vec3>& positions, const glm::mat4& transform)
+{
+    if (positions.empty())
+    {
+        return glm::vec4(0.0f);
+    }
+
+    std::vector<glm::vec3> p(positions.size());
+    for (size_t v = 0; v < positions.size(); v++)
+    {
+        p[v] = glm::vec3(transform * glm::vec4(positions[v], 1.0f));
+    }
+
+    glm::vec3 boxMin = p[0], boxMax = p[0];
+    for (size_t v = 1; v < p.size(); v++)
+    {
+        boxMin = glm::min(boxMin, p[v]);
+        boxMax = glm::max(boxMax, p[v]);
+    }
+    glm::vec3 center = 0.5f * (boxMin + boxMax);
+
+    float radius = 0.0f;
+    for (size_t v = 0; v < p.size(); v++)
+    {
+        radius = std::max(radius, glm::length(p[v] - center));
+    }
+    return glm::vec4(center, radius);
+}
@@ -0,0 +1,59 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Level-of-detail generation for indexed meshes by vertex clustering. The
+* mesh bounding box is divided into a uniform grid, every vertex snaps to
+* the first vertex found in its cell, and triangles that collapse are
+* dropped. Coarser LODs reuse the original vertex buffers and only add
+* index ranges, so all LODs can be drawn from one VAO / element buffer.
+*/
+
+#ifndef MESHLOD_HPP
+#define MESHLOD_HPP
+
+#include <vector>
+
+// Index range of one LOD inside the shared element buffer
+struct MeshLod
+{
+    unsigned int firstIndex;
+    unsigned int indexCount;
+};
+
+enum { MESH_LOD_MAX = 4 };
+
+// LOD n + 1 starts at kMeshLodDistance[n] bounding radii from the camera
+extern const float kMeshLodDistance[MESH_LOD_MAX - 1];
+
+// LOD for an object `distanceInRadii` bounding radii away, below lodCount
+unsigned int selectMeshLod(float distanceInRadii, unsigned int lodCount);
+
+/*
+* buildMeshLods()
+* ------------------------------------------------------------------
+* Purpose: Append LOD 0 (the input indices) followed by one clustered LOD
+* per entry of `gridResolutions` (cells along the longest box axis,
+* decreasing) to `outIndices`, and record their ranges in `outLods`.
+* Inputs:
+* indices / positions - indexed triangle mesh
+* gridResolutions     - e.g. {16, 8}; resolution 0 is skipped
+*/
+void buildMeshLods(const std::vector<unsigned short>& indices,
+                   const std::vector<glm::vec3>& positions,
+                   const unsigned int* gridResolutions, unsigned int resolutionCount,
+                   std::vector<unsigned short>& outIndices,
+                   std::vector<MeshLod>& outLods);
+
+/*
+* computeBoundingSphere()
+* ------------------------------------------------------------------
+* Purpose: Sphere around the axis-aligned box of the positions after
+* applying `transform` (center = box center, radius = farthest vertex).
+* Returns: xyz center, w radius.
+*/
+glm::vec4 computeBoundingSphere(const std::vector<glm::vec3>& positions, const glm::mat4& transform);
+
+#endif
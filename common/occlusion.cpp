@@ -0,0 +1,439 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the binned software occlusion rasterizer and the
+* bounding-sphere occlusion test.
+*/
+
+#include <stdio.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_SSE 1
+#endif
+
+#include <glm/glm.hpp>
+
+#include "frustum.hpp"
+#include "occlusion.hpp"
+
+static const int   kBufferWidth = 256;      // depth buffer width in pixels
+static const int   kTileSize = 8;           // tile edge of the max-depth level
+static const int   kBinsX = 4, kBinsY = 4;  // raster regions, one thread each
+static const float kMinW = 1e-3f;           // vertices nearer than this are not projected
+static const float kGuardBand = 16384.0f;   // larger screen coords lose float precision
+static const unsigned int kOccludersPerTask = 4;
+static const unsigned int kTestsPerTask = 512;
+
+OcclusionCuller::OcclusionCuller()
+    : m_width(0), m_height(0), m_tilesX(0), m_tilesY(0), m_pool(NULL)
+{
+    m_stats.occluders = m_stats.occluderTriangles = m_stats.tested = m_stats.occluded = 0;
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+    shutdown();
+}
+
+void OcclusionCuller::init(float aspect, WorkerPool& pool)
+{
+    m_width = kBufferWidth;
+    m_tilesX = m_width / kTileSize;
+    m_tilesY = std::max(1, int(m_width / aspect / kTileSize + 0.5f));
+    m_height = m_tilesY * kTileSize;
+    m_depth.assign(m_width * m_height, 1.0f);
+    m_tileMax.assign(m_tilesX * m_tilesY, 1.0f);
+
+    // Bin edges on tile boundaries so every tile belongs to one bin
+    m_bins.clear();
+    for (int by = 0; by < kBinsY; by++)
+    {
+        for (int bx = 0; bx < kBinsX; bx++)
+        {
+            Bin bin;
+            bin.x0 = (m_tilesX * bx / kBinsX) * kTileSize;
+            bin.x1 = (m_tilesX * (bx + 1) / kBinsX) * kTileSize;
+            bin.y0 = (m_tilesY * by / kBinsY) * kTileSize;
+            bin.y1 = (m_tilesY * (by + 1) / kBinsY) * kTileSize;
+            if (bin.x0 < bin.x1 && bin.y0 < bin.y1)
+            {
+                m_bins.push_back(bin);
+            }
+        }
+    }
+
+    m_pool = &pool;
+    m_binTriangles.assign(m_pool->workerCount(), std::vector<std::vector<ScreenTriangle> >(m_bins.size()));
+    m_workerTriangles.assign(m_pool->workerCount(), 0);
+    printf("Occlusion buffer %dx%d, %u bins, %u threads\n", m_width, m_height,
+           (unsigned int)m_bins.size(), m_pool->workerCount());
+}
+
+void OcclusionCuller::shutdown()
+{
+    m_pool = NULL;
+    m_binTriangles.clear();
+}
+
+unsigned int OcclusionCuller::addOccluderMesh(const std::vector<glm::vec3>& positions,
+                                              const std::vector<unsigned short>& indices,
+                                              bool doubleSided)
+{
+    // Keep only the vertices the triangles use
+    OccluderMesh mesh;
+    mesh.doubleSided = doubleSided;
+    std::vector<int> remap(positions.size(), -1);
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        unsigned short v = indices[i];
+        if (remap[v] < 0)
+        {
+            remap[v] = (int)mesh.positions.size();
+            mesh.positions.push_back(positions[v]);
+        }
+        mesh.indices.push_back((unsigned short)remap[v]);
+    }
+    m_meshes.push_back(mesh);
+    return (unsigned int)m_meshes.size() - 1;
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4& viewProj)
+{
+    m_viewProj = viewProj;
+    m_occluders.clear();
+    m_stats.occluders = m_stats.occluderTriangles = m_stats.tested = m_stats.occluded = 0;
+}
+
+void OcclusionCuller::addOccluder(unsigned int mesh, const glm::mat4& model)
+{
+    OccluderInstance occluder;
+    occluder.mesh = mesh;
+    occluder.mvp = m_viewProj * model;
+    m_occluders.push_back(occluder);
+}
+
+/*
+* setupTriangles
+* ------------------------------------------------------------------
+* Purpose: Project one occluder, compute edge and depth planes of its
+* front-facing triangles and append them to the worker's bin lists.
+* Triangles touching the near plane are dropped, which only loses
+* occlusion, never adds it.
+*/
+void OcclusionCuller::setupTriangles(const OccluderInstance& occluder, unsigned int worker)
+{
+    const OccluderMesh& mesh = m_meshes[occluder.mesh];
+
+    // Screen-space vertices: x, y in pixels (y up), z = depth [0,1], w < 0 = unusable
+    std::vector<glm::vec4> screen(mesh.positions.size());
+    for (size_t v = 0; v < mesh.positions.size(); v++)
+    {
+        glm::vec4 clip = occluder.mvp * glm::vec4(mesh.positions[v], 1.0f);
+        if (clip.w < kMinW)
+        {
+            screen[v] = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+            continue;
+        }
+        float invW = 1.0f / clip.w;
+        screen[v] = glm::vec4((clip.x * invW * 0.5f + 0.5f) * m_width,
+                              (clip.y * invW * 0.5f + 0.5f) * m_height,
+                              clip.z * invW * 0.5f + 0.5f, 1.0f);
+        if (std::fabs(screen[v].x) > kGuardBand || std::fabs(screen[v].y) > kGuardBand)
+        {
+            screen[v].w = -1.0f;
+        }
+    }
+
+    std::vector<std::vector<ScreenTriangle> >& bins = m_binTriangles[worker];
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        glm::vec4 p[3] = { screen[mesh.indices[i]], screen[mesh.indices[i + 1]], screen[mesh.indices[i + 2]] };
+        if (p[0].w < 0.0f || p[1].w < 0.0f || p[2].w < 0.0f)
+        {
+            continue;
+        }
+
+        // Twice the signed area; counter-clockwise (front facing) is positive
+        float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+        if (area < 0.0f && mesh.doubleSided)
+        {
+            std::swap(p[1], p[2]);
+            area = -area;
+        }
+        if (area <= 0.0f)
+        {
+            continue;
+        }
+
+        ScreenTriangle t;
+        t.za = t.zb = t.zc = 0.0f;
+        for (int k = 0; k < 3; k++)
+        {
+            // Edge opposite vertex k; equals `area` at that vertex
+            const glm::vec4& a = p[(k + 1) % 3];
+            const glm::vec4& b = p[(k + 2) % 3];
+            t.a[k] = a.y - b.y;
+            t.b[k] = b.x - a.x;
+            t.c[k] = -(t.a[k] * a.x + t.b[k] * a.y);
+            t.za += t.a[k] * p[k].z;
+            t.zb += t.b[k] * p[k].z;
+            t.zc += t.c[k] * p[k].z;
+        }
+        float invArea = 1.0f / area;
+        t.za *= invArea;
+        t.zb *= invArea;
+        t.zc *= invArea;
+
+        float minX = std::min(p[0].x, std::min(p[1].x, p[2].x));
+        float maxX = std::max(p[0].x, std::max(p[1].x, p[2].x));
+        float minY = std::min(p[0].y, std::min(p[1].y, p[2].y));
+        float maxY = std::max(p[0].y, std::max(p[1].y, p[2].y));
+        t.minX = std::max(0, (int)std::floor(minX));
+        t.maxX = std::min(m_width, (int)std::ceil(maxX));
+        t.minY = std::max(0, (int)std::floor(minY));
+        t.maxY = std::min(m_height, (int)std::ceil(maxY));
+        if (t.minX >= t.maxX || t.minY >= t.maxY)
+        {
+            continue;
+        }
+
+        m_workerTriangles[worker]++;
+        for (size_t b = 0; b < m_bins.size(); b++)
+        {
+            const Bin& bin = m_bins[b];
+            if (t.minX < bin.x1 && t.maxX > bin.x0 && t.minY < bin.y1 && t.maxY > bin.y0)
+            {
+                bins[b].push_back(t);
+            }
+        }
+    }
+}
+
+/*
+* rasterizeBin
+* ------------------------------------------------------------------
+* Purpose: Clear one bin, rasterize every triangle binned to it (nearest
+* depth wins, pixel centers sampled, four pixels per SSE step), then
+* rebuild the max-depth tiles it covers. Bins never share pixels, so
+* bins run on different threads without locking.
+*/
+void OcclusionCuller::rasterizeBin(unsigned int binIndex)
+{
+    const Bin& bin = m_bins[binIndex];
+    for (int y = bin.y0; y < bin.y1; y++)
+    {
+        std::fill(&m_depth[y * m_width + bin.x0], &m_depth[y * m_width + bin.x0] + (bin.x1 - bin.x0), 1.0f);
+    }
+
+    for (size_t w = 0; w < m_binTriangles.size(); w++)
+    {
+        const std::vector<ScreenTriangle>& triangles = m_binTriangles[w][binIndex];
+        for (size_t i = 0; i < triangles.size(); i++)
+        {
+            const ScreenTriangle& t = triangles[i];
+            int x0 = std::max(t.minX, bin.x0) & ~3;  // bins start on multiples of 4
+            int x1 = std::min(t.maxX, bin.x1);
+            int y0 = std::max(t.minY, bin.y0);
+            int y1 = std::min(t.maxY, bin.y1);
+
+#if defined(OCCLUSION_SSE)
+            const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 a0 = _mm_set1_ps(t.a[0]), a1 = _mm_set1_ps(t.a[1]), a2 = _mm_set1_ps(t.a[2]);
+            const __m128 za = _mm_set1_ps(t.za);
+            for (int y = y0; y < y1; y++)
+            {
+                float fy = float(y) + 0.5f;
+                __m128 r0 = _mm_set1_ps(t.b[0] * fy + t.c[0]);
+                __m128 r1 = _mm_set1_ps(t.b[1] * fy + t.c[1]);
+                __m128 r2 = _mm_set1_ps(t.b[2] * fy + t.c[2]);
+                __m128 rz = _mm_set1_ps(t.zb * fy + t.zc);
+                float* row = &m_depth[y * m_width];
+                for (int x = x0; x < x1; x += 4)
+                {
+                    __m128 px = _mm_add_ps(_mm_set1_ps(float(x)), offsets);
+                    __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), r0), zero);
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), r1), zero));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), r2), zero));
+                    if (_mm_movemask_ps(inside) == 0)
+                    {
+                        continue;
+                    }
+                    __m128 z = _mm_add_ps(_mm_mul_ps(za, px), rz);
+                    __m128 old = _mm_loadu_ps(row + x);
+                    __m128 nearest = _mm_min_ps(old, z);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+                }
+            }
+#else
+            for (int y = y0; y < y1; y++)
+            {
+                float fy = float(y) + 0.5f;
+                float* row = &m_depth[y * m_width];
+                for (int x = x0; x < x1; x++)
+                {
+                    float fx = float(x) + 0.5f;
+                    if (t.a[0] * fx + t.b[0] * fy + t.c[0] >= 0.0f &&
+                        t.a[1] * fx + t.b[1] * fy + t.c[1] >= 0.0f &&
+                        t.a[2] * fx + t.b[2] * fy + t.c[2] >= 0.0f)
+                    {
+                        row[x] = std::min(row[x], t.za * fx + t.zb * fy + t.zc);
+                    }
+                }
+            }
+#endif
+        }
+    }
+
+    // Max-depth level over the bin's tiles
+    for (int ty = bin.y0 / kTileSize; ty < bin.y1 / kTileSize; ty++)
+    {
+        for (int tx = bin.x0 / kTileSize; tx < bin.x1 / kTileSize; tx++)
+        {
+            float farthest = 0.0f;
+            for (int y = ty * kTileSize; y < (ty + 1) * kTileSize; y++)
+            {
+                const float* row = &m_depth[y * m_width + tx * kTileSize];
+                for (int x = 0; x < kTileSize; x++)
+                {
+                    farthest = std::max(farthest, row[x]);
+                }
+            }
+            m_tileMax[ty * m_tilesX + tx] = farthest;
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeOccluders()
+{
+    for (size_t w = 0; w < m_binTriangles.size(); w++)
+    {
+        m_workerTriangles[w] = 0;
+        for (size_t b = 0; b < m_binTriangles[w].size(); b++)
+        {
+            m_binTriangles[w][b].clear();
+        }
+    }
+
+    // Transform + bin, a few occluders per task
+    unsigned int occluderTasks = ((unsigned int)m_occluders.size() + kOccludersPerTask - 1) / kOccludersPerTask;
+    m_pool->parallelFor(occluderTasks, [this](unsigned int task, unsigned int worker)
+    {
+        size_t end = std::min(m_occluders.size(), size_t(task + 1) * kOccludersPerTask);
+        for (size_t i = size_t(task) * kOccludersPerTask; i < end; i++)
+        {
+            setupTriangles(m_occluders[i], worker);
+        }
+    });
+
+    // Rasterize, one bin per task
+    m_pool->parallelFor((unsigned int)m_bins.size(), [this](unsigned int bin, unsigned int)
+    {
+        rasterizeBin(bin);
+    });
+
+    m_stats.occluders = (unsigned int)m_occluders.size();
+    for (size_t w = 0; w < m_workerTriangles.size(); w++)
+    {
+        m_stats.occluderTriangles += m_workerTriangles[w];
+    }
+}
+
+/*
+* sphereOccluded
+* ------------------------------------------------------------------
+* Purpose: Project the sphere's bounding box; the object is hidden if the
+* occluders are nearer than the box's nearest depth everywhere inside its
+* screen rectangle. Boxes crossing the near plane or leaving the screen
+* are kept.
+*/
+bool OcclusionCuller::sphereOccluded(const glm::vec3& center, float radius) const
+{
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, minZ = 1e30f;
+    for (int c = 0; c < 8; c++)
+    {
+        glm::vec3 corner = center + radius * glm::vec3((c & 1) ? 1.0f : -1.0f,
+                                                       (c & 2) ? 1.0f : -1.0f,
+                                                       (c & 4) ? 1.0f : -1.0f);
+        glm::vec4 clip = m_viewProj * glm::vec4(corner, 1.0f);
+        if (clip.w < kMinW)
+        {
+            return false;
+        }
+        float invW = 1.0f / clip.w;
+        float x = (clip.x * invW * 0.5f + 0.5f) * m_width;
+        float y = (clip.y * invW * 0.5f + 0.5f) * m_height;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        minZ = std::min(minZ, clip.z * invW * 0.5f + 0.5f);
+    }
+
+    int x0 = (int)std::floor(minX), x1 = (int)std::ceil(maxX);
+    int y0 = (int)std::floor(minY), y1 = (int)std::ceil(maxY);
+    if (x0 < 0 || y0 < 0 || x1 > m_width || y1 > m_height || x0 >= x1 || y0 >= y1)
+    {
+        return false; // partly off screen: there is nothing to test against
+    }
+
+    for (int ty = y0 / kTileSize; ty <= (y1 - 1) / kTileSize; ty++)
+    {
+        for (int tx = x0 / kTileSize; tx <= (x1 - 1) / kTileSize; tx++)
+        {
+            if (m_tileMax[ty * m_tilesX + tx] < minZ)
+            {
+                continue; // the whole tile is covered by nearer occluders
+            }
+            int px0 = std::max(x0, tx * kTileSize), px1 = std::min(x1, (tx + 1) * kTileSize);
+            int py0 = std::max(y0, ty * kTileSize), py1 = std::min(y1, (ty + 1) * kTileSize);
+            for (int y = py0; y < py1; y++)
+            {
+                const float* row = &m_depth[y * m_width];
+                for (int x = px0; x < px1; x++)
+                {
+                    if (row[x] >= minZ)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+unsigned int OcclusionCuller::filterOccluded(const SphereSoA& spheres, unsigned int* list, unsigned int count)
+{
+    m_occludedFlags.resize(count);
+    unsigned int tasks = (count + kTestsPerTask - 1) / kTestsPerTask;
+    m_pool->parallelFor(tasks, [&](unsigned int task, unsigned int)
+    {
+        unsigned int end = std::min(count, (task + 1) * kTestsPerTask);
+        for (unsigned int k = task * kTestsPerTask; k < end; k++)
+        {
+            unsigned int i = list[k];
+            glm::vec3 center(spheres.x[i], spheres.y[i], spheres.z[i]);
+            m_occludedFlags[k] = sphereOccluded(center, spheres.r[i]) ? 1 : 0;
+        }
+    });
+
+    unsigned int kept = 0;
+    for (unsigned int k = 0; k < count; k++)
+    {
+        if (!m_occludedFlags[k])
+        {
+            list[kept++] = list[k];
+        }
+    }
+    m_stats.tested += count;
+    m_stats.occluded += count - kept;
+    return kept;
+}
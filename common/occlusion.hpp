@@ -0,0 +1,130 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* CPU occlusion culling against a low-resolution software depth buffer.
+* Each frame a small set of occluders (coarse Suzanne proxies of the
+* nearest heads, the floor) is transformed and binned into screen regions
+* by the worker pool, every region is rasterized by one thread with SSE
+* (four pixels per step), and an 8x8-tile max-depth level is built on top.
+* Objects are then tested with the screen rectangle and nearest depth of
+* their bounding sphere: a tile whose farthest occluder depth is nearer
+* than the object rejects it outright, other tiles fall back to per-pixel
+* depths.
+*
+* Occluders must lie inside the geometry they stand for (see the shrunk
+* proxies in main), otherwise visible objects could be rejected.
+*/
+
+#ifndef OCCLUSION_HPP
+#define OCCLUSION_HPP
+
+#include <vector>
+
+#include "workerpool.hpp"
+
+struct OcclusionStats
+{
+    unsigned int occluders;          // occluder instances this frame
+    unsigned int occluderTriangles;  // triangles that reached the rasterizer
+    unsigned int tested;             // objects tested
+    unsigned int occluded;           // objects rejected
+};
+
+class OcclusionCuller
+{
+public:
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    /*
+    * init()
+    * ------------------------------------------------------------------
+    * Purpose: Size the depth buffer for the viewport aspect (width 256,
+    * height rounded to whole 8x8 tiles) and bin/rasterize on `pool`, which
+    * must already be started. The pool is shared with the frame
+    * preparation that drives the culler (both run from the same thread,
+    * one after the other), so it must outlive the culler's use of it.
+    */
+    void init(float aspect, WorkerPool& pool);
+    void shutdown();
+
+    /*
+    * addOccluderMesh()
+    * ------------------------------------------------------------------
+    * Purpose: Register occluder geometry; only the referenced vertices
+    * are kept. Double-sided meshes (the floor) occlude from both sides.
+    * Returns: mesh id for addOccluder().
+    */
+    unsigned int addOccluderMesh(const std::vector<glm::vec3>& positions,
+                                 const std::vector<unsigned short>& indices,
+                                 bool doubleSided);
+
+    // Start a frame for this view and queue occluder instances
+    void beginFrame(const glm::mat4& viewProj);
+    void addOccluder(unsigned int mesh, const glm::mat4& model);
+
+    // Bin + rasterize the queued occluders and build the tile level
+    void rasterizeOccluders();
+
+    /*
+    * filterOccluded()
+    * ------------------------------------------------------------------
+    * Purpose: Test spheres list[0 .. count) and compact the list in place
+    * to the ones that may be visible (order is preserved).
+    * Returns: the number of entries left.
+    */
+    unsigned int filterOccluded(const SphereSoA& spheres, unsigned int* list, unsigned int count);
+
+    const OcclusionStats& stats() const { return m_stats; }
+
+private:
+    OcclusionCuller(const OcclusionCuller&);
+    OcclusionCuller& operator=(const OcclusionCuller&);
+
+    struct OccluderMesh
+    {
+        std::vector<glm::vec3>      positions;
+        std::vector<unsigned short> indices;
+        bool                        doubleSided;
+    };
+    struct OccluderInstance
+    {
+        unsigned int mesh;
+        glm::mat4    mvp;
+    };
+    // Set-up triangle in depth-buffer pixels: inside where all three edge
+    // functions a*x + b*y + c are >= 0, depth = za*x + zb*y + zc
+    struct ScreenTriangle
+    {
+        float a[3], b[3], c[3];
+        float za, zb, zc;
+        int   minX, minY, maxX, maxY;  // pixel bounds, max exclusive
+    };
+    struct Bin
+    {
+        int x0, y0, x1, y1;  // pixel rectangle, multiples of the tile size
+    };
+
+    void setupTriangles(const OccluderInstance& occluder, unsigned int worker);
+    void rasterizeBin(unsigned int bin);
+    bool sphereOccluded(const glm::vec3& center, float radius) const;
+
+    int                             m_width, m_height;
+    int                             m_tilesX, m_tilesY;
+    std::vector<float>              m_depth;     // [0,1], 1 = far; row 0 at the bottom
+    std::vector<float>              m_tileMax;   // farthest depth per 8x8 tile
+    std::vector<Bin>                m_bins;
+    std::vector<OccluderMesh>       m_meshes;
+    std::vector<OccluderInstance>   m_occluders;
+    std::vector<std::vector<std::vector<ScreenTriangle> > > m_binTriangles;  // [worker][bin]
+    std::vector<unsigned int>       m_workerTriangles;  // triangles set up per worker
+    std::vector<unsigned char>      m_occludedFlags;
+    glm::mat4                       m_viewProj;
+    OcclusionStats                  m_stats;
+    WorkerPool*                     m_pool;      // not owned
+};
+
+#endif
@@ -0,0 +1,409 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Command-line and config-file parsing for AppOptions.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "scenegen.hpp"
+#include "framecapture.hpp"
+#include "options.hpp"
+
+// Keys that are switches: no value on the command line, optional in files
+struct FlagOption
+{
+    const char*      key;
+    bool AppOptions::* member;
+};
+
+static const FlagOption kFlagOptions[] =
+{
+    { "instanced",   &AppOptions::instanced },
+    { "gpu-driven",  &AppOptions::gpuDriven },
+    { "verify-cull", &AppOptions::verifyCulling },
+    { "no-cull",     &AppOptions::disableCulling },
+    { "occlusion",   &AppOptions::occlusion },
+    { "shadows",     &AppOptions::shadows },
+    { "gpu-lights",  &AppOptions::gpuLightAssignment },
+    { "depth-prepass", &AppOptions::depthPrepass },
+    { "validate-gl", &AppOptions::validateGLState },
+    { "no-overlap",  &AppOptions::noOverlap },
+    { "on-demand",   &AppOptions::onDemand },
+    { "headless",    &AppOptions::headless },
+};
+
+static const FlagOption* findFlag(const std::string& key)
+{
+    for (size_t i = 0; i < sizeof(kFlagOptions) / sizeof(kFlagOptions[0]); i++)
+    {
+        if (key == kFlagOptions[i].key)
+        {
+            return &kFlagOptions[i];
+        }
+    }
+    return NULL;
+}
+
+void setDefaultOptions(AppOptions& options)
+{
+    setDefaultSceneConfig(options.scene);
+    options.instanced       = false;
+    options.gpuDriven       = false;
+    options.verifyCulling   = false;
+    options.disableCulling  = false;
+    options.occlusion       = false;
+    options.occluderCount   = 32;
+    options.animatedHeads   = 0;
+    options.shadows         = false;
+    options.shadowSize      = 1024;
+    options.pointLights     = 0;
+    options.gpuLightAssignment = false;
+    options.depthPrepass    = false;
+    options.frameBudgetMs   = 0.0f;
+    options.minRenderScale  = 0.5f;
+    options.validateGLState = false;
+    options.prepThreads     = -1;
+    options.noOverlap       = false;
+    options.onDemand        = false;
+    options.cullBenchmarkSpheres = 0;
+    options.transformBenchmarkObjects = 0;
+    options.benchmarkFrames = 0;
+    options.headless        = false;
+    options.benchmarkOutput = "benchmark";
+    options.capturePrefix   = "";
+    options.captureFormat   = CAPTURE_BMP;
+    options.tracePath       = "";
+    options.width           = 1024;
+    options.height          = 768;
+}
+
+/*
+* parseFlagValue
+* ------------------------------------------------------------------
+* Purpose: Interpret an optional switch value ("1", "true", "yes", "on").
+* A missing value means "on".
+*/
+static bool parseFlagValue(const char* value)
+{
+    if (value == NULL || value[0] == '\0')
+    {
+        return true;
+    }
+    return strcmp(value, "1") == 0 || strcmp(value, "true") == 0 ||
+           strcmp(value, "yes") == 0 || strcmp(value, "on") == 0;
+}
+
+/*
+* applyOption
+* ------------------------------------------------------------------
+* Purpose: Set one option from its key and textual value.
+* Returns: false if the key is unknown or the value is invalid.
+*/
+static bool applyOption(const std::string& key, const char* value, AppOptions& options)
+{
+    if (const FlagOption* flag = findFlag(key))
+    {
+        options.*(flag->member) = parseFlagValue(value);
+        return true;
+    }
+    if (value == NULL)
+    {
+        fprintf(stderr, "Option '%s' needs a value\n", key.c_str());
+        return false;
+    }
+
+    if (key == "heads")
+    {
+        int n = atoi(value);
+        if (n < 1) { fprintf(stderr, "heads must be >= 1\n"); return false; }
+        options.scene.count = (unsigned int)n;
+    }
+    else if (key == "layout")
+    {
+        if (!parseSceneLayout(value, options.scene.layout))
+        {
+            fprintf(stderr, "Unknown layout '%s' (ring, rings, grid, scatter)\n", value);
+            return false;
+        }
+    }
+    else if (key == "spacing")
+    {
+        float s = (float)atof(value);
+        if (s <= 0.0f) { fprintf(stderr, "spacing must be > 0\n"); return false; }
+        options.scene.spacing = s;
+    }
+    else if (key == "seed")
+    {
+        options.scene.seed = (unsigned int)strtoul(value, NULL, 10);
+    }
+    else if (key == "benchmark")
+    {
+        int n = atoi(value);
+        if (n < 1) { fprintf(stderr, "benchmark needs a frame count >= 1\n"); return false; }
+        options.benchmarkFrames = (unsigned int)n;
+    }
+    else if (key == "occluders")
+    {
+        int n = atoi(value);
+        if (n < 0) { fprintf(stderr, "occluders must be >= 0\n"); return false; }
+        options.occluderCount = (unsigned int)n;
+    }
+    else if (key == "animate")
+    {
+        int n = atoi(value);
+        if (n < 0) { fprintf(stderr, "animate must be >= 0\n"); return false; }
+        options.animatedHeads = (unsigned int)n;
+    }
+    else if (key == "shadow-size")
+    {
+        int n = atoi(value);
+        if (n < 16 || n > 8192) { fprintf(stderr, "shadow-size must be in [16, 8192]\n"); return false; }
+        options.shadowSize = (unsigned int)n;
+    }
+    else if (key == "lights")
+    {
+        int n = atoi(value);
+        if (n < 0 || n > 65536) { fprintf(stderr, "lights must be in [0, 65536]\n"); return false; }
+        options.pointLights = (unsigned int)n;
+    }
+    else if (key == "dynamic-res")
+    {
+        float ms = (float)atof(value);
+        if (ms <= 0.0f || ms > 1000.0f) { fprintf(stderr, "dynamic-res needs a budget in (0, 1000] ms\n"); return false; }
+        options.frameBudgetMs = ms;
+    }
+    else if (key == "min-scale")
+    {
+        float s = (float)atof(value);
+        if (s < 0.1f || s > 1.0f) { fprintf(stderr, "min-scale must be in [0.1, 1]\n"); return false; }
+        options.minRenderScale = s;
+    }
+    else if (key == "prep-threads")
+    {
+        int n = atoi(value);
+        if (n < 0) { fprintf(stderr, "prep-threads must be >= 0\n"); return false; }
+        options.prepThreads = n;
+    }
+    else if (key == "cull-bench")
+    {
+        int n = atoi(value);
+        if (n < 1) { fprintf(stderr, "cull-bench needs a sphere count >= 1\n"); return false; }
+        options.cullBenchmarkSpheres = (unsigned int)n;
+    }
+    else if (key == "transform-bench")
+    {
+        int n = atoi(value);
+        if (n < 1) { fprintf(stderr, "transform-bench needs an object count >= 1\n"); return false; }
+        options.transformBenchmarkObjects = (unsigned int)n;
+    }
+    else if (key == "bench-out")
+    {
+        options.benchmarkOutput = value;
+    }
+    else if (key == "capture")
+    {
+        options.capturePrefix = value;
+    }
+    else if (key == "capture-format")
+    {
+        if (!parseCaptureFormat(value, options.captureFormat))
+        {
+            fprintf(stderr, "Unknown capture format '%s' (bmp, png, raw)\n", value);
+            return false;
+        }
+    }
+    else if (key == "trace")
+    {
+        options.tracePath = value;
+    }
+    else if (key == "size")
+    {
+        int w = 0, h = 0;
+        if (sscanf(value, "%dx%d", &w, &h) != 2 || w < 1 || h < 1)
+        {
+            fprintf(stderr, "size must look like 1024x768\n");
+            return false;
+        }
+        options.width = w;
+        options.height = h;
+    }
+    else if (key == "config")
+    {
+        return loadOptionsFile(value, options);
+    }
+    else
+    {
+        fprintf(stderr, "Unknown option '%s'\n", key.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool parseCommandLine(int argc, char* argv[], AppOptions& options)
+{
+    for (int a = 1; a < argc; a++)
+    {
+        if (strncmp(argv[a], "--", 2) != 0)
+        {
+            fprintf(stderr, "Unexpected argument '%s'\n", argv[a]);
+            printUsage(argv[0]);
+            return false;
+        }
+
+        std::string key = argv[a] + 2;
+        const char* value = NULL;
+        if (!findFlag(key) && a + 1 < argc)
+        {
+            value = argv[++a];
+        }
+        if (!applyOption(key, value, options))
+        {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+* trim
+* ------------------------------------------------------------------
+* Purpose: Strip leading/trailing whitespace (and a trailing '\r' from
+* files saved on Windows).
+*/
+static std::string trim(const std::string& s)
+{
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos)
+    {
+        return std::string();
+    }
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+// Config files being read, outermost first. A `config` line inside a
+// file nests another load; the chain catches a file that (directly or
+// through others) includes itself, and the depth cap catches cycles the
+// path strings do not reveal (e.g. "a.cfg" vs "./a.cfg").
+static std::vector<std::string> g_configChain;
+static const size_t kMaxConfigDepth = 16;
+
+bool loadOptionsFile(const char* path, AppOptions& options)
+{
+    for (size_t i = 0; i < g_configChain.size(); i++)
+    {
+        if (g_configChain[i] == path)
+        {
+            fprintf(stderr, "Config file %s includes itself\n", path);
+            return false;
+        }
+    }
+    if (g_configChain.size() >= kMaxConfigDepth)
+    {
+        fprintf(stderr, "Config files nested more than %u deep at %s\n", (unsigned int)kMaxConfigDepth, path);
+        return false;
+    }
+
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        fprintf(stderr, "Impossible to open config file %s\n", path);
+        return false;
+    }
+
+    g_configChain.push_back(path);
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos)
+        {
+            line.erase(comment);
+        }
+        line = trim(line);
+        if (line.empty())
+        {
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        std::string key = trim(line.substr(0, eq));
+        std::string value = (eq == std::string::npos) ? std::string() : trim(line.substr(eq + 1));
+        if (!applyOption(key, eq == std::string::npos ? NULL : value.c_str(), options))
+        {
+            fprintf(stderr, "  in %s line %d\n", path, lineNumber);
+            g_configChain.pop_back();
+            return false;
+        }
+    }
+    g_configChain.pop_back();
+    return true;
+}
+
+void printUsage(const char* exeName)
+{
+    printf("Usage: %s [options]\n"
+           "  --heads N          number of heads (default 8)\n"
+           "  --layout L         ring | rings | grid | scatter (default ring)\n"
+           "  --spacing S        distance between neighbouring heads\n"
+           "  --seed N           random seed for the scatter layout\n"
+           "  --instanced        draw all heads with one instanced call\n"
+           "  --gpu-driven       cull and pick LODs in a compute shader, draw with\n"
+           "                     one multi-draw indirect call (GL 4.3+)\n"
+           "  --verify-cull      compare the GPU culling against the CPU reference\n"
+           "  --no-cull          submit every head (disable CPU frustum culling)\n"
+           "  --occlusion        reject heads hidden behind nearer heads (CPU)\n"
+           "  --occluders N      nearest heads used as occluders (default 32)\n"
+           "  --animate N        spin the first N heads (the rest stay static)\n"
+           "  --shadows          shadows from the light's cube map, re-rendered only\n"
+           "                     where casters moved (needs diffuse + specular on)\n"
+           "  --shadow-size N    shadow cube face resolution (default 1024)\n"
+           "  --lights N         add N point lights around the scene, shaded per\n"
+           "                     froxel cluster (needs diffuse + specular on)\n"
+           "  --gpu-lights       assign lights to clusters in a compute shader (GL 4.3+)\n"
+           "  --depth-prepass    lay down depth with a position-only pass, then shade\n"
+           "                     each pixel once (GL_EQUAL); default: front to back\n"
+           "  --dynamic-res MS   render the scene at the resolution that keeps GPU\n"
+           "                     time near MS per frame (e.g. 16.6), upscaled to\n"
+           "                     the window; the HUD stays at native resolution\n"
+           "  --min-scale S      lowest render scale for --dynamic-res (default 0.5)\n"
+           "  --validate-gl      check the GL state shadow against the driver (slow)\n"
+           "  --prep-threads N   worker threads preparing each frame (default: cores - 1)\n"
+           "  --no-overlap       prepare each frame right before it is submitted\n"
+           "                     (default: one frame ahead, overlapping submission)\n"
+           "  --on-demand        redraw only on input, window events or animation and\n"
+           "                     sleep otherwise (windowed runs; implies --no-overlap)\n"
+           "  --size WxH         window / offscreen size (default 1024x768)\n"
+           "  --benchmark N      run N scripted frames offscreen and report\n"
+           "  --bench-out PATH   report prefix; writes PATH.csv and PATH.json\n"
+           "  --headless         benchmark without a window through EGL (no display\n"
+           "                     server needed; --benchmark N defaults to 300)\n"
+           "  --capture PREFIX   write every frame to PREFIX_NNNNNN.bmp (read back\n"
+           "                     asynchronously, encoded on a background thread)\n"
+           "  --capture-format F bmp | png | raw (raw: all frames in PREFIX.raw, BGRA)\n"
+           "  --trace PATH       profile CPU and GPU scopes, write a Chrome trace\n"
+           "                     (chrome://tracing) and print a summary at exit\n"
+           "  --cull-bench N     time the frustum culling kernels on N spheres and exit\n"
+           "  --transform-bench N  time the model/MVP transform kernels on N objects and exit\n"
+           "  --config FILE      read 'key = value' lines with the keys above\n"
+           "The on-screen HUD needs the font atlas Holstein.DDS (from opengl-tutorial's\n"
+           "tutorial11_2d_fonts) in the working directory; without it the HUD is off.\n",
+           exeName);
+}
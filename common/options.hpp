@@ -0,0 +1,79 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Run-time options for the scene executable. The same keys are accepted on
+* the command line (`--key value`, or `--flag`) and in a config file passed
+* with `--config` (`key = value` per line, `#` starts a comment), so a
+* benchmark setup can be checked in and replayed.
+*/
+
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "scenegen.hpp"     // SceneConfig
+#include "framecapture.hpp" // CaptureFormat
+
+struct AppOptions
+{
+    SceneConfig  scene;             // layout, count, spacing, seed
+    bool         instanced;         // one instanced draw for all heads
+    bool         gpuDriven;         // compute culling + multi-draw indirect
+    bool         verifyCulling;     // check GPU culling against the CPU reference
+    bool         disableCulling;    // submit every head (no CPU frustum culling)
+    bool         occlusion;         // CPU occlusion culling against nearby heads
+    unsigned int occluderCount;     // nearest heads rasterized as occluders
+    unsigned int animatedHeads;     // heads spinning in place; the rest never move
+    bool         shadows;           // cached shadow cube map for the point light
+    unsigned int shadowSize;        // shadow cube face resolution
+    unsigned int pointLights;       // > 0: clustered point lights around the scene
+    bool         gpuLightAssignment; // assign lights to clusters in a compute shader
+    bool         depthPrepass;      // depth-only pass first, then shade with GL_EQUAL
+    float        frameBudgetMs;     // > 0: scale the render resolution to this GPU time per frame
+    float        minRenderScale;    // lowest scale dynamic resolution may pick
+    bool         validateGLState;   // read back GL state after every tracked call
+    int          prepThreads;       // frame preparation pool threads, < 0 = automatic
+    bool         noOverlap;         // prepare each frame right before submitting it
+    bool         onDemand;          // sleep until input, window events or animation need a frame
+    unsigned int cullBenchmarkSpheres; // > 0: run the culling kernel benchmark and exit
+    unsigned int transformBenchmarkObjects; // > 0: run the transform kernel benchmark and exit
+    unsigned int benchmarkFrames;   // > 0: scripted offscreen benchmark run
+    bool         headless;          // EGL context, no window or display server (implies a benchmark run)
+    std::string  benchmarkOutput;   // report path prefix (.csv / .json added)
+    std::string  capturePrefix;     // non-empty: capture every frame to files with this prefix
+    CaptureFormat captureFormat;    // bmp, png or raw
+    std::string  tracePath;         // non-empty: record CPU/GPU scopes, write a Chrome trace here
+    int          width;             // window / offscreen target size
+    int          height;
+};
+
+void setDefaultOptions(AppOptions& options);
+
+/*
+* parseCommandLine()
+* ------------------------------------------------------------------
+* Purpose: Apply argv on top of the current options. `--config file` is
+* loaded at the point it appears, so later flags override it.
+* Returns: false on an unknown key or bad value (usage is printed).
+*/
+bool parseCommandLine(int argc, char* argv[], AppOptions& options);
+
+/*
+* loadOptionsFile()
+* ------------------------------------------------------------------
+* Purpose: Apply `key = value` lines from a config file.
+* Returns: false if the file cannot be read or contains a bad entry.
+*/
+bool loadOptionsFile(const char* path, AppOptions& options);
+
+void printUsage(const char* exeName);
+
+#endif
@@ -0,0 +1,406 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Profiler: per-thread CPU event buffers, the two GL_TIMESTAMP query sets,
+* Chrome trace export and the summary table.
+*/
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include "profiler.hpp"
+
+// Events each thread can record; later ones are dropped (and counted)
+static const unsigned int kEventsPerThread = 1u << 17;
+
+// GPU scopes per frame; later ones in the same frame are not timed
+static const unsigned int kGpuScopesPerFrame = 64;
+
+struct ProfileEvent
+{
+    const char* name;
+    long long   start, end;  // ns since profilerInit
+};
+
+// One thread's events. Only the owning thread writes; `count` is
+// published with release order, so readers see complete events.
+struct ThreadTrack
+{
+    ThreadTrack() : id(0), count(0), dropped(0) {}
+
+    std::string                     name;
+    unsigned int                    id;
+    std::unique_ptr<ProfileEvent[]> events;
+    std::atomic<unsigned int>       count;
+    unsigned int                    dropped;
+};
+
+// GPU scopes recorded during one frame
+struct GpuQuerySet
+{
+    GLuint       queries[2 * kGpuScopesPerFrame];  // begin / end timestamp per scope
+    const char*  names[kGpuScopesPerFrame];
+    unsigned int count;
+};
+
+static bool g_enabled = false;
+static std::chrono::steady_clock::time_point g_origin;
+
+static std::mutex              g_tracksMutex;  // registration and export only
+static std::deque<ThreadTrack> g_tracks;
+static thread_local ThreadTrack* t_track = NULL;
+
+static bool         g_gpuReady = false;
+static GpuQuerySet  g_gpuSets[2];
+static unsigned int g_gpuFrame = 0;        // current set = g_gpuFrame % 2
+static long long    g_gpuToCpu = 0;        // add to a GPU timestamp to get profiler time
+static unsigned int g_gpuSetsDropped = 0;  // sets not ready when their turn came
+static ThreadTrack  g_gpuTrack;
+
+static long long nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_origin).count();
+}
+
+static ThreadTrack* newTrack(const char* name)
+{
+    std::lock_guard<std::mutex> lock(g_tracksMutex);
+    g_tracks.emplace_back();
+    ThreadTrack& track = g_tracks.back();
+    track.id = (unsigned int)g_tracks.size();
+    track.events.reset(new ProfileEvent[kEventsPerThread]);
+    if (name)
+    {
+        track.name = name;
+    }
+    else
+    {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "thread %u", track.id);
+        track.name = buffer;
+    }
+    return &track;
+}
+
+static void record(ThreadTrack& track, const char* name, long long start, long long end)
+{
+    unsigned int n = track.count.load(std::memory_order_relaxed);
+    if (n >= kEventsPerThread)
+    {
+        track.dropped++;
+        return;
+    }
+    ProfileEvent& event = track.events[n];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    track.count.store(n + 1, std::memory_order_release);
+}
+
+void profilerInit(bool enabled)
+{
+    g_origin = std::chrono::steady_clock::now();
+    g_enabled = enabled;
+    if (enabled && !g_gpuTrack.events)
+    {
+        g_gpuTrack.name = "GPU";
+        g_gpuTrack.id = 0;
+        g_gpuTrack.events.reset(new ProfileEvent[kEventsPerThread]);
+    }
+}
+
+bool profilerEnabled()
+{
+    return g_enabled;
+}
+
+void profilerSetThreadName(const char* name)
+{
+    if (!g_enabled)
+    {
+        return;
+    }
+    if (!t_track)
+    {
+        t_track = newTrack(name);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(g_tracksMutex);
+    t_track->name = name;
+}
+
+ProfileScope::ProfileScope(const char* name)
+    : m_name(name), m_start(g_enabled ? nowNs() : -1)
+{
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (m_start < 0)
+    {
+        return;
+    }
+    if (!t_track)
+    {
+        t_track = newTrack(NULL);
+    }
+    record(*t_track, m_name, m_start, nowNs());
+}
+
+bool profilerInitGpu()
+{
+    if (!g_enabled)
+    {
+        return false;
+    }
+    // Core since 3.3; older contexts may still expose the extension
+    if (!GLEW_VERSION_3_3 && !GLEW_ARB_timer_query)
+    {
+        printf("Profiler: timer queries not available, GPU scopes disabled\n");
+        return false;
+    }
+    for (int s = 0; s < 2; s++)
+    {
+        glGenQueries(2 * kGpuScopesPerFrame, g_gpuSets[s].queries);
+        g_gpuSets[s].count = 0;
+    }
+
+    // Line the GPU clock up with the profiler's
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    g_gpuToCpu = nowNs() - (long long)gpuNow;
+    g_gpuFrame = 0;
+    g_gpuReady = true;
+    return true;
+}
+
+/*
+* collectGpuSet
+* ------------------------------------------------------------------
+* Purpose: Move a set's timestamps into the GPU track. Without `wait`, a
+* set whose last query isn't available yet is dropped instead of read, so
+* the call never blocks.
+*/
+static void collectGpuSet(GpuQuerySet& set, bool wait)
+{
+    if (set.count == 0)
+    {
+        return;
+    }
+    if (!wait)
+    {
+        // Queries complete in order: the last end timestamp covers the set
+        GLint available = 0;
+        glGetQueryObjectiv(set.queries[2 * set.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            g_gpuSetsDropped++;
+            set.count = 0;
+            return;
+        }
+    }
+    for (unsigned int i = 0; i < set.count; i++)
+    {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(set.queries[2 * i], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(set.queries[2 * i + 1], GL_QUERY_RESULT, &end);
+        record(g_gpuTrack, set.names[i], (long long)begin + g_gpuToCpu, (long long)end + g_gpuToCpu);
+    }
+    set.count = 0;
+}
+
+void profilerBeginFrame()
+{
+    if (!g_gpuReady)
+    {
+        return;
+    }
+    // The set about to be reused was filled two frames ago
+    g_gpuFrame++;
+    collectGpuSet(g_gpuSets[g_gpuFrame % 2], false);
+}
+
+void profilerShutdown()
+{
+    if (!g_gpuReady)
+    {
+        return;
+    }
+    collectGpuSet(g_gpuSets[(g_gpuFrame + 1) % 2], true);
+    collectGpuSet(g_gpuSets[g_gpuFrame % 2], true);
+    for (int s = 0; s < 2; s++)
+    {
+        glDeleteQueries(2 * kGpuScopesPerFrame, g_gpuSets[s].queries);
+    }
+    g_gpuReady = false;
+}
+
+GpuProfileScope::GpuProfileScope(const char* name)
+    : m_index(-1)
+{
+    if (!g_gpuReady)
+    {
+        return;
+    }
+    GpuQuerySet& set = g_gpuSets[g_gpuFrame % 2];
+    if (set.count >= kGpuScopesPerFrame)
+    {
+        return;
+    }
+    m_index = (int)set.count++;
+    set.names[m_index] = name;
+    glQueryCounter(set.queries[2 * m_index], GL_TIMESTAMP);
+}
+
+GpuProfileScope::~GpuProfileScope()
+{
+    if (m_index < 0 || !g_gpuReady)
+    {
+        return;
+    }
+    glQueryCounter(g_gpuSets[g_gpuFrame % 2].queries[2 * m_index + 1], GL_TIMESTAMP);
+}
+
+// Scope names are literals from this codebase; escape just in case
+static void writeJsonString(FILE* file, const char* s)
+{
+    fputc('"', file);
+    for (; *s; s++)
+    {
+        if (*s == '"' || *s == '\\')
+        {
+            fputc('\\', file);
+        }
+        fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+static void writeTrackEvents(FILE* file, const ThreadTrack& track, bool& first)
+{
+    fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+            first ? "" : ",", track.id);
+    writeJsonString(file, track.name.c_str());
+    fprintf(file, "}}");
+    first = false;
+
+    unsigned int count = track.count.load(std::memory_order_acquire);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const ProfileEvent& event = track.events[i];
+        fprintf(file, ",\n{\"name\":");
+        writeJsonString(file, event.name);
+        fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                track.id, event.start * 1e-3, (event.end - event.start) * 1e-3);
+    }
+}
+
+bool profilerWriteTrace(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file)
+    {
+        printf("Profiler: cannot write %s\n", path);
+        return false;
+    }
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> lock(g_tracksMutex);
+        for (size_t t = 0; t < g_tracks.size(); t++)
+        {
+            writeTrackEvents(file, g_tracks[t], first);
+        }
+    }
+    if (g_gpuTrack.events)
+    {
+        writeTrackEvents(file, g_gpuTrack, first);
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    printf("Profiler: trace written to %s\n", path);
+    return true;
+}
+
+struct ScopeTotals
+{
+    ScopeTotals() : calls(0), totalNs(0) {}
+    unsigned int calls;
+    long long    totalNs;
+};
+
+static void addTotals(const ThreadTrack& track, std::map<std::string, ScopeTotals>& totals)
+{
+    unsigned int count = track.count.load(std::memory_order_acquire);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        ScopeTotals& t = totals[track.events[i].name];
+        t.calls++;
+        t.totalNs += track.events[i].end - track.events[i].start;
+    }
+}
+
+static void printTotals(const char* title, const std::map<std::string, ScopeTotals>& totals)
+{
+    // Largest total first
+    std::vector<std::pair<long long, std::string> > order;
+    for (std::map<std::string, ScopeTotals>::const_iterator it = totals.begin(); it != totals.end(); ++it)
+    {
+        order.push_back(std::make_pair(-it->second.totalNs, it->first));
+    }
+    std::sort(order.begin(), order.end());
+
+    printf("%-28s %8s %12s %10s\n", title, "calls", "total ms", "mean ms");
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const ScopeTotals& t = totals.find(order[i].second)->second;
+        printf("  %-26s %8u %12.3f %10.4f\n", order[i].second.c_str(), t.calls,
+               t.totalNs * 1e-6, t.totalNs * 1e-6 / t.calls);
+    }
+}
+
+void profilerPrintSummary()
+{
+    if (!g_enabled)
+    {
+        return;
+    }
+    std::map<std::string, ScopeTotals> cpu, gpu;
+    unsigned int dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_tracksMutex);
+        for (size_t t = 0; t < g_tracks.size(); t++)
+        {
+            addTotals(g_tracks[t], cpu);
+            dropped += g_tracks[t].dropped;
+        }
+    }
+    if (g_gpuTrack.events)
+    {
+        addTotals(g_gpuTrack, gpu);
+        dropped += g_gpuTrack.dropped;
+    }
+    printTotals("CPU scope", cpu);
+    if (!gpu.empty())
+    {
+        printTotals("GPU scope", gpu);
+    }
+    if (dropped > 0 || g_gpuSetsDropped > 0)
+    {
+        printf("  (%u events dropped for full buffers, %u GPU frames not ready in time)\n",
+               dropped, g_gpuSetsDropped);
+    }
+}
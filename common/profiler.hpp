@@ -0,0 +1,81 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* CPU and GPU profiler with Chrome trace export (chrome://tracing,
+* ui.perfetto.dev).
+*
+* CPU: PROFILE_SCOPE("name") times the enclosing block. Each thread
+* appends to its own fixed-size event buffer (no locks after the thread's
+* first event; a full buffer drops events and counts them).
+*
+* GPU: GPU_PROFILE_SCOPE("name") brackets the GL commands of a block with
+* GL_TIMESTAMP queries (timestamps, unlike GL_TIME_ELAPSED, nest and don't
+* conflict with the benchmark's frame query). Queries alternate between two
+* sets; a frame's set is read back two frames later, and only if the
+* results are already available, so the profiler never stalls the GPU.
+*
+* Everything is off until profilerInit(true); a disabled scope costs one
+* branch. Scope names must be string literals (only the pointer is kept).
+*/
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+// Enable or disable recording (call before any scope you want recorded)
+void profilerInit(bool enabled);
+bool profilerEnabled();
+
+// Track name of the calling thread in the trace
+void profilerSetThreadName(const char* name);
+
+// GPU scopes: needs a current GL context with timer queries
+bool profilerInitGpu();
+
+// Render thread, once per frame: collects the GPU scopes of two frames ago
+void profilerBeginFrame();
+
+// Wait for the outstanding GPU results and release the queries
+void profilerShutdown();
+
+/*
+* profilerWriteTrace()
+* ------------------------------------------------------------------
+* Purpose: Write every recorded CPU and GPU scope as Chrome trace-event
+* JSON ("X" events, one track per thread plus one for the GPU).
+* Returns: false if the file cannot be written.
+*/
+bool profilerWriteTrace(const char* path);
+
+// Per-scope call count, total and mean time, CPU and GPU, to stdout
+void profilerPrintSummary();
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+
+private:
+    const char* m_name;
+    long long   m_start;  // ns since profilerInit, < 0 when disabled
+};
+
+class GpuProfileScope
+{
+public:
+    explicit GpuProfileScope(const char* name);
+    ~GpuProfileScope();
+
+private:
+    int m_index;  // slot in the current query set, < 0 when not recording
+};
+
+#define PROFILE_JOIN2(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_JOIN(profileScope_, __LINE__)(name)
+#define GPU_PROFILE_SCOPE(name) GpuProfileScope PROFILE_JOIN(gpuProfileScope_, __LINE__)(name)
+
+#endif
@@ -0,0 +1,250 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Render queue: key packing, LSD radix sort and redundant-state skipping.
+*/
+
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "uniformblocks.hpp"
+#include "glstate.hpp"
+#include "renderqueue.hpp"
+
+// State categories counted per packet: program, texture, VAO, cull,
+// polygon offset, color mask, depth test, per-object block
+static const unsigned int kStateCategories = 8;
+
+RenderQueue::RenderQueue()
+{
+    m_stats.packets = m_stats.naiveStateChanges = m_stats.stateChanges = 0;
+}
+
+void RenderQueue::clear()
+{
+    m_packets.clear();
+    m_order.clear();
+}
+
+uint64_t RenderQueue::makeKey(RenderPass pass, GLuint program, GLuint texture, GLuint vao,
+                              unsigned int renderState, float depth01, SortOrder order)
+{
+    const uint64_t depthMax = (uint64_t(1) << 26) - 1;
+    float d = std::min(std::max(depth01, 0.0f), 1.0f);
+    // In double: float(depthMax) rounds up to 2^26, which would carry
+    // depth 1 into the next field
+    const uint64_t depth = uint64_t(double(d) * double(depthMax));
+    if (order == SORT_FRONT_TO_BACK)
+    {
+        return (uint64_t(pass & 0xF)          << 60) |
+               (depth                         << 34) |
+               (uint64_t(program & 0x3FF)     << 24) |
+               (uint64_t(texture & 0x3FF)     << 14) |
+               (uint64_t(vao & 0x3FF)         << 4) |
+               uint64_t(renderState & 0xF);
+    }
+    return (uint64_t(pass & 0xF)          << 60) |
+           (uint64_t(program & 0x3FF)     << 50) |
+           (uint64_t(texture & 0x3FF)     << 40) |
+           (uint64_t(vao & 0x3FF)         << 30) |
+           (uint64_t(renderState & 0xF)   << 26) |
+           depth;
+}
+
+void RenderQueue::push(const DrawPacket& packet)
+{
+    SortEntry entry;
+    entry.key = packet.key;
+    entry.packet = (unsigned int)m_packets.size();
+    m_packets.push_back(packet);
+    m_order.push_back(entry);
+}
+
+unsigned int RenderQueue::allocate(unsigned int count)
+{
+    unsigned int first = (unsigned int)m_packets.size();
+    m_packets.resize(first + count);
+    m_order.resize(first + count);
+    return first;
+}
+
+void RenderQueue::set(unsigned int index, const DrawPacket& packet)
+{
+    m_packets[index] = packet;
+    m_order[index].key = packet.key;
+    m_order[index].packet = index;
+}
+
+/*
+* sort
+* ------------------------------------------------------------------
+* Purpose: LSD radix sort of (key, packet) pairs, one byte per pass.
+* Passes where every key has the same byte (common for the high state
+* bytes) are skipped after the histogram. Stable, so equal keys keep
+* submission order.
+*/
+void RenderQueue::sort()
+{
+    const size_t n = m_order.size();
+    if (n < 2)
+    {
+        return;
+    }
+    m_scratch.resize(n);
+
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        unsigned int offsets[256];
+        memset(offsets, 0, sizeof(offsets));
+        for (size_t i = 0; i < n; i++)
+        {
+            offsets[(m_order[i].key >> shift) & 0xFF]++;
+        }
+        if (offsets[(m_order[0].key >> shift) & 0xFF] == n)
+        {
+            continue;
+        }
+
+        unsigned int sum = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            unsigned int count = offsets[b];
+            offsets[b] = sum;
+            sum += count;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            m_scratch[offsets[(m_order[i].key >> shift) & 0xFF]++] = m_order[i];
+        }
+        m_order.swap(m_scratch);
+    }
+}
+
+void RenderQueue::submit(GLuint shadedSamplesQuery)
+{
+    m_stats.packets = (unsigned int)m_order.size();
+    m_stats.naiveStateChanges = m_stats.packets * kStateCategories;
+    m_stats.stateChanges = 0;
+
+    // Nothing is assumed current at the start of the queue
+    bool first = true;
+    GLuint program = 0, texture = 0, vao = 0;
+    unsigned int renderState = 0, uniformSlot = 0;
+    bool slotBound = false;
+
+    glsActiveTexture(GL_TEXTURE0);
+    glsPolygonOffset(1.0f, 1.0f);
+
+    // Sorted by pass, so the opaque packets are one contiguous range
+    bool counting = false;
+
+    for (size_t i = 0; i < m_order.size(); i++)
+    {
+        const DrawPacket& p = m_packets[m_order[i].packet];
+
+        if (shadedSamplesQuery && !counting && (m_order[i].key >> 60) == PASS_OPAQUE)
+        {
+            glBeginQuery(GL_SAMPLES_PASSED, shadedSamplesQuery);
+            counting = true;
+        }
+
+        if (first || p.program != program)
+        {
+            glsUseProgram(p.program);
+            program = p.program;
+            m_stats.stateChanges++;
+        }
+        if (first || p.texture != texture)
+        {
+            glsBindTexture(GL_TEXTURE_2D, p.texture);
+            texture = p.texture;
+            m_stats.stateChanges++;
+        }
+        if (first || p.vao != vao)
+        {
+            glsBindVertexArray(p.vao);
+            vao = p.vao;
+            m_stats.stateChanges++;
+        }
+        unsigned int changed = first ? 0xF : (p.renderState ^ renderState);
+        if (changed & RS_CULL_BACK)
+        {
+            glsSetEnabled(GL_CULL_FACE, (p.renderState & RS_CULL_BACK) != 0);
+            m_stats.stateChanges++;
+        }
+        if (changed & RS_POLYGON_OFFSET)
+        {
+            glsSetEnabled(GL_POLYGON_OFFSET_FILL, (p.renderState & RS_POLYGON_OFFSET) != 0);
+            m_stats.stateChanges++;
+        }
+        if (changed & RS_DEPTH_ONLY)
+        {
+            glsColorMask((p.renderState & RS_DEPTH_ONLY) ? GL_FALSE : GL_TRUE);
+            m_stats.stateChanges++;
+        }
+        if (changed & RS_DEPTH_EQUAL)
+        {
+            // The pre-pass already wrote the nearest depth; only the
+            // fragments that produced it pass
+            bool equal = (p.renderState & RS_DEPTH_EQUAL) != 0;
+            glsDepthFunc(equal ? GL_EQUAL : GL_LESS);
+            glsDepthMask(equal ? GL_FALSE : GL_TRUE);
+            m_stats.stateChanges++;
+        }
+        renderState = p.renderState;
+        if (first || p.uniformSlot != uniformSlot)
+        {
+            slotBound = bindObjectUniforms(p.uniformSlot);
+            uniformSlot = p.uniformSlot;
+            m_stats.stateChanges++;
+        }
+        first = false;
+        if (!slotBound)
+        {
+            continue; // its block was never staged: don't draw with another's
+        }
+
+        if (p.customDraw)
+        {
+            p.customDraw();
+            vao = GLuint(-1); // custom draws may bind their own VAO
+        }
+        else if (p.instanceCount != 1)
+        {
+            glDrawElementsInstanced(GL_TRIANGLES, p.indexCount, p.indexType, p.indexOffset, p.instanceCount);
+        }
+        else
+        {
+            glDrawElements(GL_TRIANGLES, p.indexCount, p.indexType, p.indexOffset);
+        }
+    }
+
+    // An empty opaque range still completes the query (0 samples)
+    if (shadedSamplesQuery)
+    {
+        if (!counting)
+        {
+            glBeginQuery(GL_SAMPLES_PASSED, shadedSamplesQuery);
+        }
+        glEndQuery(GL_SAMPLES_PASSED);
+    }
+
+    // Leave the defaults the rest of the frame expects
+    if (!first)
+    {
+        glsEnable(GL_CULL_FACE);
+        glsDisable(GL_POLYGON_OFFSET_FILL);
+        glsColorMask(GL_TRUE);
+        glsDepthFunc(GL_LESS);
+        glsDepthMask(GL_TRUE);
+        glsBindVertexArray(0);
+    }
+}
@@ -0,0 +1,143 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Sorted render queue. Every draw is recorded as a packet holding the state
+* it needs (program, texture, VAO, raster state, per-object UBO slot) and
+* the draw arguments, plus a 64-bit sort key:
+*
+*   SORT_BY_STATE               SORT_FRONT_TO_BACK
+*   63..60  pass                63..60  pass
+*   59..50  program             59..34  depth
+*   49..40  texture             33..24  program
+*   39..30  VAO                 23..14  texture
+*   29..26  raster state        13..4   VAO
+*   25..0   depth               3..0    raster state
+*
+* (programs, textures and VAOs by the low bits of their GL names, raster
+* state as RenderStateBits, depth front to back). State-major keys make
+* packets sharing state adjacent; depth-major keys draw near objects first
+* so the depth test rejects what they hide before it is shaded, at the
+* price of more state changes.
+*
+* The queue is radix sorted once per frame, and submit() only issues the state that actually changes
+* between consecutive packets (through the glstate.hpp shadow, so state
+* left over from earlier passes is skipped too). Names that collide in their low bits only
+* affect ordering, never correctness.
+*/
+
+#ifndef RENDERQUEUE_HPP
+#define RENDERQUEUE_HPP
+
+#include <vector>
+#include <stdint.h>
+
+enum RenderPass
+{
+    PASS_DEPTH_PREPASS = 0,  // depth only, ahead of everything it hides
+    PASS_OPAQUE        = 1
+};
+
+enum RenderStateBits
+{
+    RS_CULL_BACK      = 1 << 0,  // GL_CULL_FACE enabled
+    RS_POLYGON_OFFSET = 1 << 1,  // GL_POLYGON_OFFSET_FILL with offset (1, 1)
+    RS_DEPTH_ONLY     = 1 << 2,  // color writes off (pre-pass)
+    RS_DEPTH_EQUAL    = 1 << 3   // GL_EQUAL, no depth writes (after a pre-pass)
+};
+
+enum SortOrder
+{
+    SORT_BY_STATE,       // fewest state changes
+    SORT_FRONT_TO_BACK   // least overdraw
+};
+
+struct DrawPacket
+{
+    uint64_t     key;
+    GLuint       program;
+    GLuint       texture;       // bound to unit 0
+    GLuint       vao;
+    unsigned int renderState;   // RenderStateBits
+    unsigned int uniformSlot;   // per-object block (see uniformblocks.hpp)
+
+    // Draw: an indexed (instanced) draw, or `customDraw` if set
+    GLsizei      indexCount;
+    GLenum       indexType;
+    const void*  indexOffset;
+    GLsizei      instanceCount;  // 1 = plain glDrawElements, 0 draws nothing
+    void       (*customDraw)();
+};
+
+struct RenderQueueStats
+{
+    unsigned int packets;
+    unsigned int naiveStateChanges;  // every packet setting all of its state
+    unsigned int stateChanges;       // what submit() actually issued
+};
+
+class RenderQueue
+{
+public:
+    RenderQueue();
+
+    // Empty the queue for a new frame
+    void clear();
+
+    /*
+    * makeKey()
+    * ------------------------------------------------------------------
+    * Purpose: Build the sort key of a packet; `depth01` is the normalized
+    * view depth of the object (0 = near plane, 1 = far plane).
+    */
+    static uint64_t makeKey(RenderPass pass, GLuint program, GLuint texture, GLuint vao,
+                            unsigned int renderState, float depth01, SortOrder order = SORT_BY_STATE);
+
+    // Append a packet; `packet.key` must already be set
+    void push(const DrawPacket& packet);
+
+    /*
+    * allocate() / set()
+    * ------------------------------------------------------------------
+    * Purpose: Append `count` packets at once and fill them by index, so
+    * worker threads can write disjoint ranges without locking.
+    * allocate() returns the index of the first new packet; every one of
+    * them must be set() before sort().
+    */
+    unsigned int allocate(unsigned int count);
+    void set(unsigned int index, const DrawPacket& packet);
+
+    unsigned int size() const { return (unsigned int)m_packets.size(); }
+
+    // Radix sort the packets by key
+    void sort();
+
+    /*
+    * submit()
+    * ------------------------------------------------------------------
+    * Purpose: Issue every packet in sorted order, skipping state that is
+    * already current. Leaves culling on, polygon offset off, color and
+    * depth writes on with GL_LESS, and no VAO bound.
+    * Inputs: shadedSamplesQuery - if not 0, a GL_SAMPLES_PASSED query
+    * that counts the samples the PASS_OPAQUE packets shade.
+    */
+    void submit(GLuint shadedSamplesQuery = 0);
+
+    const RenderQueueStats& stats() const { return m_stats; }
+
+private:
+    struct SortEntry
+    {
+        uint64_t     key;
+        unsigned int packet;
+    };
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<SortEntry>  m_order;
+    std::vector<SortEntry>  m_scratch;
+    RenderQueueStats        m_stats;
+};
+
+#endif
@@ -0,0 +1,58 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the offscreen framebuffer target.
+*/
+
+#include <stdio.h>
+
+#include <GL/glew.h>
+
+#include "rendertarget.hpp"
+#include "glstate.hpp"
+
+bool createRenderTarget(RenderTarget& target, int width, int height)
+{
+    target.width  = width;
+    target.height = height;
+
+    glGenRenderbuffers(1, &target.colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &target.depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &target.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depthBuffer);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        printf("Offscreen framebuffer %dx%d incomplete (0x%x)\n", width, height, status);
+        return false;
+    }
+    return true;
+}
+
+void bindRenderTarget(const RenderTarget& target)
+{
+    glsBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glViewport(0, 0, target.width, target.height);
+}
+
+void destroyRenderTarget(RenderTarget& target)
+{
+    glDeleteFramebuffers(1, &target.framebuffer);
+    glDeleteRenderbuffers(1, &target.colorBuffer);
+    glDeleteRenderbuffers(1, &target.depthBuffer);
+    target.framebuffer = target.colorBuffer = target.depthBuffer = 0;
+}
@@ -0,0 +1,37 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Minimal offscreen render target: a framebuffer object with an RGBA8
+* color renderbuffer and a 24-bit depth renderbuffer. Used when frames are
+* rendered without presenting them (benchmark runs).
+*/
+
+#ifndef RENDERTARGET_HPP
+#define RENDERTARGET_HPP
+
+struct RenderTarget
+{
+    GLuint framebuffer;
+    GLuint colorBuffer;
+    GLuint depthBuffer;
+    int    width;
+    int    height;
+};
+
+/*
+* createRenderTarget()
+* ------------------------------------------------------------------
+* Purpose: Allocate an FBO of the given size.
+* Returns: true if the framebuffer is complete.
+*/
+bool createRenderTarget(RenderTarget& target, int width, int height);
+
+// Bind the target for drawing and set the viewport to its size
+void bindRenderTarget(const RenderTarget& target);
+
+void destroyRenderTarget(RenderTarget& target);
+
+#endif
@@ -0,0 +1,140 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the ring / rings / grid / scatter scene layouts.
+*/
+
+#include <string.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "scenegen.hpp"
+
+// Spacing of the original 8-head ring: arc length between neighbours
+static const float kLabRingRadius = 3.7416574f; // sqrt(14)
+
+void setDefaultSceneConfig(SceneConfig& config)
+{
+    config.layout  = LAYOUT_RING;
+    config.count   = 8;
+    config.spacing = kLabRingRadius * glm::pi<float>() / 4.0f;
+    config.seed    = 1;
+}
+
+bool parseSceneLayout(const char* name, SceneLayout& layout)
+{
+    if      (strcmp(name, "ring") == 0)    layout = LAYOUT_RING;
+    else if (strcmp(name, "rings") == 0)   layout = LAYOUT_RINGS;
+    else if (strcmp(name, "grid") == 0)    layout = LAYOUT_GRID;
+    else if (strcmp(name, "scatter") == 0) layout = LAYOUT_SCATTER;
+    else return false;
+    return true;
+}
+
+const char* sceneLayoutName(SceneLayout layout)
+{
+    switch (layout)
+    {
+        case LAYOUT_RINGS:   return "rings";
+        case LAYOUT_GRID:    return "grid";
+        case LAYOUT_SCATTER: return "scatter";
+        default:             return "ring";
+    }
+}
+
+float nextRandom(unsigned int& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+/*
+* placeOnRing
+* ------------------------------------------------------------------
+* Purpose: Append `count` heads on a ring of radius r, starting at -90
+* degrees, each facing radially outward.
+*/
+static void placeOnRing(unsigned int count, float r, float lift, std::vector<glm::vec4>& out)
+{
+    const float start = -glm::half_pi<float>();
+    const float step  = glm::two_pi<float>() / count;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        float theta = start + i * step;
+        out.push_back(glm::vec4(r * std::cos(theta), r * std::sin(theta), lift, theta + glm::half_pi<float>()));
+    }
+}
+
+float generateScene(const SceneConfig& config, float liftToGround, std::vector<glm::vec4>& placements)
+{
+    placements.clear();
+    placements.reserve(config.count);
+    const unsigned int n = std::max(config.count, 1u);
+    const float spacing = config.spacing;
+    float extent = 0.0f;
+
+    switch (config.layout)
+    {
+    case LAYOUT_RING:
+    {
+        // Eight heads reproduce radius sqrt(14); more heads grow the ring
+        float r = std::max(kLabRingRadius, n * spacing / glm::two_pi<float>());
+        placeOnRing(n, r, liftToGround, placements);
+        extent = r;
+        break;
+    }
+    case LAYOUT_RINGS:
+    {
+        // Ring k has radius sqrt(14) + k * spacing and as many heads as fit
+        unsigned int placed = 0;
+        for (unsigned int k = 0; placed < n; k++)
+        {
+            float r = kLabRingRadius + k * spacing;
+            unsigned int fit = std::max(1u, (unsigned int)(glm::two_pi<float>() * r / spacing));
+            unsigned int take = std::min(fit, n - placed);
+            placeOnRing(take, r, liftToGround, placements);
+            placed += take;
+            extent = r;
+        }
+        break;
+    }
+    case LAYOUT_GRID:
+    {
+        unsigned int side = (unsigned int)std::ceil(std::sqrt(float(n)));
+        float half = 0.5f * (side - 1) * spacing;
+        for (unsigned int i = 0; i < n; i++)
+        {
+            float x = (i % side) * spacing - half;
+            float y = (i / side) * spacing - half;
+            placements.push_back(glm::vec4(x, y, liftToGround, 0.0f));
+        }
+        extent = half * std::sqrt(2.0f);
+        break;
+    }
+    case LAYOUT_SCATTER:
+    {
+        // Same average density as the grid, random yaw
+        float half = 0.5f * std::sqrt(float(n)) * spacing;
+        unsigned int state = config.seed ? config.seed : 1u;
+        for (unsigned int i = 0; i < n; i++)
+        {
+            float x = (nextRandom(state) * 2.0f - 1.0f) * half;
+            float y = (nextRandom(state) * 2.0f - 1.0f) * half;
+            float yaw = nextRandom(state) * glm::two_pi<float>();
+            placements.push_back(glm::vec4(x, y, liftToGround, yaw));
+        }
+        extent = half * std::sqrt(2.0f);
+        break;
+    }
+    }
+    return extent;
+}
@@ -0,0 +1,69 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Parameterized stress-scene generator. Produces head placements (xyz
+* translation + yaw about +Z) for a single ring (the original lab scene),
+* concentric rings, a square grid, or a seeded random scatter. Placement is
+* deterministic for a given configuration so benchmark runs are comparable.
+*/
+
+#ifndef SCENEGEN_HPP
+#define SCENEGEN_HPP
+
+#include <vector>
+
+enum SceneLayout
+{
+    LAYOUT_RING,     // one ring, radius grows with the head count
+    LAYOUT_RINGS,    // concentric rings at constant spacing
+    LAYOUT_GRID,     // square grid, all heads facing +Y
+    LAYOUT_SCATTER   // uniform random positions and yaw (seeded)
+};
+
+struct SceneConfig
+{
+    SceneLayout  layout;
+    unsigned int count;    // number of heads
+    float        spacing;  // distance between neighbours (world units)
+    unsigned int seed;     // LAYOUT_SCATTER only
+};
+
+// Lab defaults: 8 heads on a ring of radius sqrt(14)
+void setDefaultSceneConfig(SceneConfig& config);
+
+/*
+* parseSceneLayout() / sceneLayoutName()
+* ------------------------------------------------------------------
+* Purpose: Convert between the layout enum and "ring", "rings", "grid",
+* "scatter". parseSceneLayout returns false for unknown names.
+*/
+bool parseSceneLayout(const char* name, SceneLayout& layout);
+const char* sceneLayoutName(SceneLayout layout);
+
+/*
+* generateScene()
+* ------------------------------------------------------------------
+* Purpose: Fill `placements` with one vec4 per head (xyz translation,
+* w yaw) for the given configuration.
+* Inputs:
+* config - layout parameters
+* liftToGround - z translation that rests the model on z = 0
+* Returns: radius of a circle around the origin containing every head
+* center (used to size the benchmark camera path).
+*/
+float generateScene(const SceneConfig& config, float liftToGround, std::vector<glm::vec4>& placements);
+
+/*
+* nextRandom()
+* ------------------------------------------------------------------
+* Purpose: xorshift32 step, the one source of seeded randomness in the
+* repo. Used instead of rand() so a seed produces the same scene on every
+* platform. `state` must not be 0.
+* Returns: uniform float in [0, 1).
+*/
+float nextRandom(unsigned int& state);
+
+#endif
@@ -13,8 +13,35 @@ using namespace std;
 #include <GL/glew.h>
 
 #include "shader.hpp"
+#include "profiler.hpp"
+
+// Insert the permutation #defines after the #version line (which must stay
+// first), then reset the line counter so compiler errors match the file.
+static void InjectDefines(std::string & code, const char * defines){
+	if ( defines == NULL || defines[0] == '\0' )
+		return;
+
+	size_t insertAt = 0;
+	size_t versionPos = code.find("#version");
+	if ( versionPos != std::string::npos ){
+		size_t eol = code.find('\n', versionPos);
+		insertAt = ( eol == std::string::npos ) ? code.size() : eol + 1;
+	}
+	std::string block = defines;
+	if ( block[block.size()-1] != '\n' )
+		block += '\n';
+	std::ostringstream line;
+	line << "#line " << std::count(code.begin(), code.begin() + insertAt, '\n') + 1 << "\n";
+	block += line.str();
+	code.insert(insertAt, block);
+}
 
 GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
+	return LoadShadersWithDefines(vertex_file_path, fragment_file_path, NULL);
+}
+
+GLuint LoadShadersWithDefines(const char * vertex_file_path,const char * fragment_file_path, const char * defines){
+	PROFILE_SCOPE("LoadShaders");
 
 	// Create the shaders
 	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
@@ -44,6 +71,9 @@ GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path
 		FragmentShaderStream.close();
 	}
 
+	InjectDefines(VertexShaderCode, defines);
+	InjectDefines(FragmentShaderCode, defines);
+
 	GLint Result = GL_FALSE;
 	int InfoLogLength;
 
@@ -109,3 +139,64 @@ GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path
 }
 
 
+GLuint LoadComputeShader(const char * compute_file_path){
+
+	// Read the Compute Shader code from the file
+	std::string ComputeShaderCode;
+	std::ifstream ComputeShaderStream(compute_file_path, std::ios::in);
+	if(ComputeShaderStream.is_open()){
+		std::stringstream sstr;
+		sstr << ComputeShaderStream.rdbuf();
+		ComputeShaderCode = sstr.str();
+		ComputeShaderStream.close();
+	}else{
+		printf("Impossible to open %s. Are you in the right directory ?\n", compute_file_path);
+		return 0;
+	}
+
+	GLint Result = GL_FALSE;
+	int InfoLogLength;
+
+	// Compile Compute Shader
+	printf("Compiling shader : %s\n", compute_file_path);
+	GLuint ComputeShaderID = glCreateShader(GL_COMPUTE_SHADER);
+	char const * ComputeSourcePointer = ComputeShaderCode.c_str();
+	glShaderSource(ComputeShaderID, 1, &ComputeSourcePointer , NULL);
+	glCompileShader(ComputeShaderID);
+
+	// Check Compute Shader
+	glGetShaderiv(ComputeShaderID, GL_COMPILE_STATUS, &Result);
+	glGetShaderiv(ComputeShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 0 ){
+		std::vector<char> ComputeShaderErrorMessage(InfoLogLength+1);
+		glGetShaderInfoLog(ComputeShaderID, InfoLogLength, NULL, &ComputeShaderErrorMessage[0]);
+		printf("%s\n", &ComputeShaderErrorMessage[0]);
+	}
+
+	// Link the program
+	printf("Linking program\n");
+	GLuint ProgramID = glCreateProgram();
+	glAttachShader(ProgramID, ComputeShaderID);
+	glLinkProgram(ProgramID);
+
+	// Check the program; unlike LoadShaders a failed link returns 0 so the
+	// caller can fall back to a CPU path
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+	glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 0 ){
+		std::vector<char> ProgramErrorMessage(InfoLogLength+1);
+		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
+		printf("%s\n", &ProgramErrorMessage[0]);
+	}
+
+	glDetachShader(ProgramID, ComputeShaderID);
+	glDeleteShader(ComputeShaderID);
+
+	if ( Result != GL_TRUE ){
+		glDeleteProgram(ProgramID);
+		return 0;
+	}
+	return ProgramID;
+}
+
+
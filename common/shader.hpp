@@ -3,4 +3,11 @@
 
 GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path);
 
+// Same as LoadShaders, but `defines` (e.g. "#define USE_TINT\n") is inserted
+// right after the #version line of both sources. Used for shader permutations.
+GLuint LoadShadersWithDefines(const char * vertex_file_path,const char * fragment_file_path, const char * defines);
+
+// Compile and link a compute-only program (GL 4.3+). Returns 0 on failure.
+GLuint LoadComputeShader(const char * compute_file_path);
+
 #endif
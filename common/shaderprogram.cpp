@@ -0,0 +1,334 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the ShaderProgram wrapper: link-time reflection of
+* active uniforms/attributes into hash-sorted tables (names kept to resolve
+* collisions) and cached typed uniform setters that elide redundant
+* glUniform* uploads.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+#include "shaderprogram.hpp"
+#include "glstate.hpp"
+
+UniformStats ShaderProgram::s_frameStats = { 0, 0 };
+
+/*
+* nameLength
+* ------------------------------------------------------------------
+* Purpose: Length of a GLSL identifier without a trailing "[0]" (reported
+* by the driver for arrays), so "lights[0]" and "lights" resolve to the
+* same entry.
+*/
+static size_t nameLength(const char* name)
+{
+    size_t len = strlen(name);
+    if (len > 3 && strcmp(name + len - 3, "[0]") == 0)
+    {
+        len -= 3;
+    }
+    return len;
+}
+
+/*
+* hashName
+* ------------------------------------------------------------------
+* Purpose: 32-bit FNV-1a hash of the first `len` characters of a name.
+*/
+static unsigned int hashName(const char* name, size_t len)
+{
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*
+* uniformTypeBytes
+* ------------------------------------------------------------------
+* Purpose: Size in bytes of one element of a uniform of the given type,
+* used to reserve its slot in the shadow cache.
+*/
+static unsigned int uniformTypeBytes(GLenum type)
+{
+    switch (type)
+    {
+        case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_BOOL_VEC2: return 8;
+        case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_BOOL_VEC3: return 12;
+        case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_BOOL_VEC4: return 16;
+        case GL_FLOAT_MAT2: return 16;
+        case GL_FLOAT_MAT3: return 36;
+        case GL_FLOAT_MAT4: return 64;
+        default:            return 4;   // float, int, bool, samplers
+    }
+}
+
+static bool hashLess(const ShaderVariable& a, const ShaderVariable& b)
+{
+    return a.nameHash < b.nameHash;
+}
+
+/*
+* makeVariable
+* ------------------------------------------------------------------
+* Purpose: Table row for a reflected name, keyed by its hash.
+*/
+static ShaderVariable makeVariable(const char* name)
+{
+    ShaderVariable v;
+    size_t len = nameLength(name);
+    v.nameHash = hashName(name, len);
+    v.name.assign(name, len);
+    return v;
+}
+
+/*
+* findByName
+* ------------------------------------------------------------------
+* Purpose: Binary search a hash-sorted table, then compare the names of
+* the entries sharing the hash (more than one only on a collision).
+* Returns: index of the entry, or -1 if the name is not active.
+*/
+static int findByName(const std::vector<ShaderVariable>& table, const char* name)
+{
+    size_t len = nameLength(name);
+    ShaderVariable key;
+    key.nameHash = hashName(name, len);
+    std::vector<ShaderVariable>::const_iterator it =
+        std::lower_bound(table.begin(), table.end(), key, hashLess);
+    for (; it != table.end() && it->nameHash == key.nameHash; ++it)
+    {
+        if (it->name.size() == len && it->name.compare(0, len, name, len) == 0)
+        {
+            return int(it - table.begin());
+        }
+    }
+    return -1;
+}
+
+ShaderProgram::ShaderProgram()
+    : m_programID(0)
+{
+}
+
+bool ShaderProgram::load(const char* vertex_file_path, const char* fragment_file_path)
+{
+    return adopt(LoadShaders(vertex_file_path, fragment_file_path));
+}
+
+bool ShaderProgram::adopt(GLuint programID)
+{
+    destroy();
+    if (programID == 0)
+    {
+        return false;
+    }
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(programID, GL_LINK_STATUS, &linked);
+    m_programID = programID;
+    if (linked != GL_TRUE)
+    {
+        return false;
+    }
+
+    reflect();
+    return true;
+}
+
+void ShaderProgram::destroy()
+{
+    if (m_programID != 0)
+    {
+        glDeleteProgram(m_programID);
+    }
+    m_programID = 0;
+    m_uniforms.clear();
+    m_attributes.clear();
+    m_cache.clear();
+}
+
+void ShaderProgram::use() const
+{
+    glsUseProgram(m_programID);
+}
+
+/*
+* reflect
+* ------------------------------------------------------------------
+* Purpose: Enumerate GL_ACTIVE_UNIFORMS and GL_ACTIVE_ATTRIBUTES once and
+* build the lookup tables. Uniforms that live in a uniform block have no
+* location and are skipped; they are updated through their buffer.
+*/
+void ShaderProgram::reflect()
+{
+    GLint count = 0, maxLen = 0;
+    glGetProgramiv(m_programID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+
+    std::vector<char> name(maxLen > 0 ? maxLen : 1);
+    unsigned int cacheBytes = 0;
+    for (GLint i = 0; i < count; i++)
+    {
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_programID, (GLuint)i, (GLsizei)name.size(), NULL, &size, &type, &name[0]);
+
+        GLint location = glGetUniformLocation(m_programID, &name[0]);
+        if (location < 0)
+        {
+            continue; // block member
+        }
+
+        ShaderVariable v = makeVariable(&name[0]);
+        v.location    = location;
+        v.type        = type;
+        v.arraySize   = size;
+        v.cacheOffset = cacheBytes;
+        v.cacheValid  = false;
+        cacheBytes   += uniformTypeBytes(type) * (unsigned int)size;
+        m_uniforms.push_back(v);
+    }
+
+    glGetProgramiv(m_programID, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(m_programID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLen);
+    name.resize(maxLen > 0 ? maxLen : 1);
+    for (GLint i = 0; i < count; i++)
+    {
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveAttrib(m_programID, (GLuint)i, (GLsizei)name.size(), NULL, &size, &type, &name[0]);
+
+        ShaderVariable v = makeVariable(&name[0]);
+        v.location    = glGetAttribLocation(m_programID, &name[0]);
+        v.type        = type;
+        v.arraySize   = size;
+        v.cacheOffset = 0;
+        v.cacheValid  = false;
+        m_attributes.push_back(v);
+    }
+
+    // Colliding names end up next to each other; findByName tells them apart
+    std::sort(m_uniforms.begin(), m_uniforms.end(), hashLess);
+    std::sort(m_attributes.begin(), m_attributes.end(), hashLess);
+
+    m_cache.assign(cacheBytes, 0);
+}
+
+UniformHandle ShaderProgram::uniform(const char* name) const
+{
+    return findByName(m_uniforms, name);
+}
+
+GLint ShaderProgram::attribute(const char* name) const
+{
+    int i = findByName(m_attributes, name);
+    return i < 0 ? -1 : m_attributes[i].location;
+}
+
+GLint ShaderProgram::uniformLocation(UniformHandle h) const
+{
+    return h < 0 ? -1 : m_uniforms[h].location;
+}
+
+GLenum ShaderProgram::uniformType(UniformHandle h) const
+{
+    return h < 0 ? 0 : m_uniforms[h].type;
+}
+
+/*
+* changed
+* ------------------------------------------------------------------
+* Purpose: Compare a new value against the shadow copy of handle h and
+* update the copy and the frame counters.
+* Returns: true if the caller must issue the glUniform* call.
+*/
+bool ShaderProgram::changed(UniformHandle h, const void* data, unsigned int bytes)
+{
+    ShaderVariable& v = m_uniforms[h];
+    unsigned char* shadow = &m_cache[v.cacheOffset];
+    if (v.cacheValid && memcmp(shadow, data, bytes) == 0)
+    {
+        s_frameStats.avoided++;
+        return false;
+    }
+    memcpy(shadow, data, bytes);
+    v.cacheValid = true;
+    s_frameStats.issued++;
+    return true;
+}
+
+void ShaderProgram::setInt(UniformHandle h, int v)
+{
+    if (h >= 0 && changed(h, &v, sizeof(v)))
+    {
+        glUniform1i(m_uniforms[h].location, v);
+    }
+}
+
+void ShaderProgram::setFloat(UniformHandle h, float v)
+{
+    if (h >= 0 && changed(h, &v, sizeof(v)))
+    {
+        glUniform1f(m_uniforms[h].location, v);
+    }
+}
+
+void ShaderProgram::setVec3(UniformHandle h, const glm::vec3& v)
+{
+    if (h >= 0 && changed(h, &v[0], sizeof(float) * 3))
+    {
+        glUniform3f(m_uniforms[h].location, v.x, v.y, v.z);
+    }
+}
+
+void ShaderProgram::setVec4(UniformHandle h, const glm::vec4& v)
+{
+    if (h >= 0 && changed(h, &v[0], sizeof(float) * 4))
+    {
+        glUniform4f(m_uniforms[h].location, v.x, v.y, v.z, v.w);
+    }
+}
+
+void ShaderProgram::setMat4(UniformHandle h, const glm::mat4& m)
+{
+    if (h >= 0 && changed(h, &m[0][0], sizeof(float) * 16))
+    {
+        glUniformMatrix4fv(m_uniforms[h].location, 1, GL_FALSE, &m[0][0]);
+    }
+}
+
+void ShaderProgram::invalidateCache()
+{
+    for (size_t i = 0; i < m_uniforms.size(); i++)
+    {
+        m_uniforms[i].cacheValid = false;
+    }
+}
+
+void ShaderProgram::beginFrame()
+{
+    s_frameStats.issued  = 0;
+    s_frameStats.avoided = 0;
+}
+
+UniformStats ShaderProgram::frameStats()
+{
+    return s_frameStats;
+}
@@ -0,0 +1,118 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Program wrapper built on top of `LoadShaders()`. After the program links,
+* every active uniform and vertex attribute is enumerated once and stored in
+* a compact table (name hash, name, location, GL type, array size). Lookups
+* binary search the hash and confirm the name, so a hash collision can
+* never return another variable's location. The renderer
+* resolves a uniform to a small integer handle at setup time and then uses
+* the typed setters every frame; each setter keeps a shadow copy of the last
+* uploaded value and skips the `glUniform*` call when nothing changed. A
+* per-frame counter reports how many uploads were avoided.
+*/
+
+#ifndef SHADERPROGRAM_HPP
+#define SHADERPROGRAM_HPP
+
+#include <string>
+#include <vector>
+
+// Handle returned by ShaderProgram::uniform(); -1 means "not active".
+typedef int UniformHandle;
+
+// One row of the reflection table (uniforms and attributes share the layout)
+struct ShaderVariable
+{
+    unsigned int nameHash;     // FNV-1a hash of the name (array suffix removed)
+    std::string  name;         // the name hashed, compared on lookup
+    GLint        location;     // glGetUniformLocation / glGetAttribLocation
+    GLenum       type;         // GL_FLOAT_MAT4, GL_SAMPLER_2D, ...
+    GLint        arraySize;    // 1 for non-arrays
+    unsigned int cacheOffset;  // byte offset of the shadow value (uniforms)
+    bool         cacheValid;   // false until the first upload
+};
+
+// Uniform upload statistics, shared by all programs
+struct UniformStats
+{
+    unsigned int issued;   // glUniform* calls forwarded to the driver
+    unsigned int avoided;  // calls skipped because the value was unchanged
+};
+
+class ShaderProgram
+{
+public:
+    ShaderProgram();
+
+    /*
+    * load()
+    * ------------------------------------------------------------------
+    * Purpose: Compile and link the two shader files with LoadShaders(),
+    * then reflect the active uniforms and attributes.
+    * Returns: true if the program linked.
+    */
+    bool load(const char* vertex_file_path, const char* fragment_file_path);
+
+    /*
+    * adopt()
+    * ------------------------------------------------------------------
+    * Purpose: Take ownership of an already linked program object and
+    * reflect it (used when the program was built some other way).
+    * Returns: true if programID is a linked program.
+    */
+    bool adopt(GLuint programID);
+
+    // Delete the GL program and clear the reflection tables
+    void destroy();
+
+    GLuint id() const { return m_programID; }
+    void use() const;
+
+    /*
+    * uniform() / attribute()
+    * ------------------------------------------------------------------
+    * Purpose: Resolve a name against the reflection table. Call once at
+    * setup; the handle/location is stable for the lifetime of the program.
+    * Returns: uniform handle (-1 if inactive) / attribute location (-1).
+    */
+    UniformHandle uniform(const char* name) const;
+    GLint attribute(const char* name) const;
+    GLint uniformLocation(UniformHandle h) const;
+    GLenum uniformType(UniformHandle h) const;
+
+    // Typed setters. The program must be current (use()). Inactive handles
+    // (-1) are ignored, matching glUniform* with location -1.
+    void setInt  (UniformHandle h, int v);
+    void setBool (UniformHandle h, bool v) { setInt(h, v ? 1 : 0); }
+    void setFloat(UniformHandle h, float v);
+    void setVec3 (UniformHandle h, const glm::vec3& v);
+    void setVec4 (UniformHandle h, const glm::vec4& v);
+    void setMat4 (UniformHandle h, const glm::mat4& m);
+
+    // Forget every shadow value (e.g. after outside code touched the program)
+    void invalidateCache();
+
+    size_t uniformCount() const   { return m_uniforms.size(); }
+    size_t attributeCount() const { return m_attributes.size(); }
+
+    // Per-frame upload counters; reset once at the top of every frame
+    static void beginFrame();
+    static UniformStats frameStats();
+
+private:
+    void reflect();
+    bool changed(UniformHandle h, const void* data, unsigned int bytes);
+
+    GLuint m_programID;
+    std::vector<ShaderVariable> m_uniforms;    // sorted by nameHash
+    std::vector<ShaderVariable> m_attributes;  // sorted by nameHash
+    std::vector<unsigned char>  m_cache;       // shadow copies of uniform values
+
+    static UniformStats s_frameStats;
+};
+
+#endif
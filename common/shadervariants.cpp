@@ -0,0 +1,110 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the lazily compiled shader permutation cache.
+*/
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+#include "shaderprogram.hpp"
+#include "shadervariants.hpp"
+
+const char* const kStandardShadingDefines[SHADING_FEATURE_COUNT] =
+{
+    "USE_TINT",
+    "ENABLE_DIFFUSE_SPEC",
+    "INSTANCED",
+    "SHADOWS",
+    "CLUSTERED_LIGHTS"
+};
+
+ShaderVariantCache::ShaderVariantCache()
+    : m_onLink(NULL)
+{
+}
+
+void ShaderVariantCache::init(const char* vertex_file_path, const char* fragment_file_path,
+                              const char* const* featureNames, unsigned int featureCount,
+                              LinkCallback onLink)
+{
+    destroy();
+    m_vertexPath   = vertex_file_path;
+    m_fragmentPath = fragment_file_path;
+    m_featureNames.assign(featureNames, featureNames + featureCount);
+    m_variants.assign(size_t(1) << featureCount, ShaderProgram());
+    m_built.assign(size_t(1) << featureCount, false);
+    m_onLink = onLink;
+}
+
+/*
+* definesFor
+* ------------------------------------------------------------------
+* Purpose: Build the "#define A\n#define B\n" block for a feature mask.
+*/
+std::string ShaderVariantCache::definesFor(unsigned int mask) const
+{
+    std::string defines;
+    for (size_t i = 0; i < m_featureNames.size(); i++)
+    {
+        if (mask & (1u << i))
+        {
+            defines += "#define " + m_featureNames[i] + "\n";
+        }
+    }
+    return defines;
+}
+
+ShaderProgram& ShaderVariantCache::get(unsigned int mask)
+{
+    mask &= unsigned(m_variants.size() - 1);
+    if (!m_built[mask])
+    {
+        printf("Building shader variant 0x%x\n", mask);
+        std::string defines = definesFor(mask);
+        m_variants[mask].adopt(LoadShadersWithDefines(m_vertexPath.c_str(), m_fragmentPath.c_str(), defines.c_str()));
+        m_built[mask] = true;
+        if (m_onLink)
+        {
+            m_onLink(m_variants[mask]);
+        }
+    }
+    return m_variants[mask];
+}
+
+void ShaderVariantCache::precompile(const unsigned int* masks, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        get(masks[i]);
+    }
+}
+
+unsigned int ShaderVariantCache::compiledCount() const
+{
+    unsigned int n = 0;
+    for (size_t i = 0; i < m_built.size(); i++)
+    {
+        n += m_built[i] ? 1 : 0;
+    }
+    return n;
+}
+
+void ShaderVariantCache::destroy()
+{
+    for (size_t i = 0; i < m_variants.size(); i++)
+    {
+        m_variants[i].destroy();
+    }
+    m_variants.clear();
+    m_built.clear();
+}
@@ -0,0 +1,79 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Compile-time shader permutations. A ShaderVariantCache owns one vertex /
+* fragment file pair and a list of feature names. Each feature bit in a mask
+* becomes a `#define <name>` injected after the #version line, so a feature
+* that is off costs nothing per fragment instead of being masked by a
+* uniform branch. Variants are compiled lazily on first use (or up front via
+* precompile()) and selected by bitmask at draw time.
+*/
+
+#ifndef SHADERVARIANTS_HPP
+#define SHADERVARIANTS_HPP
+
+#include <string>
+#include <vector>
+
+// Feature bits understood by StandardShading.*shader
+enum StandardShadingFeature
+{
+    SHADING_USE_TINT          = 1 << 0,  // flat Tint.rgb instead of the texture
+    SHADING_DIFFUSE_SPECULAR  = 1 << 1,  // diffuse + specular terms ('L' key)
+    SHADING_INSTANCED         = 1 << 2,  // per-instance position+yaw attribute
+    SHADING_SHADOWS           = 1 << 3,  // cube shadow map lookup (with DIFFUSE_SPECULAR)
+    SHADING_CLUSTERED_LIGHTS  = 1 << 4,  // per-cluster point light loop (with DIFFUSE_SPECULAR)
+    SHADING_FEATURE_COUNT     = 5
+};
+
+// Names matching the bits above, in bit order
+extern const char* const kStandardShadingDefines[SHADING_FEATURE_COUNT];
+
+class ShaderVariantCache
+{
+public:
+    // Called once for every freshly linked variant (e.g. to bind UBOs)
+    typedef void (*LinkCallback)(ShaderProgram& program);
+
+    ShaderVariantCache();
+
+    /*
+    * init()
+    * ------------------------------------------------------------------
+    * Purpose: Remember the shader files and feature names. Nothing is
+    * compiled yet.
+    * Inputs: featureNames[i] is the #define emitted for bit (1 << i).
+    */
+    void init(const char* vertex_file_path, const char* fragment_file_path,
+              const char* const* featureNames, unsigned int featureCount,
+              LinkCallback onLink = NULL);
+
+    /*
+    * get()
+    * ------------------------------------------------------------------
+    * Purpose: Return the program for a feature mask, compiling it on the
+    * first request.
+    */
+    ShaderProgram& get(unsigned int mask);
+
+    // Compile the given masks now (avoids a hitch when a toggle is first hit)
+    void precompile(const unsigned int* masks, unsigned int count);
+
+    unsigned int compiledCount() const;
+    void destroy();
+
+private:
+    std::string definesFor(unsigned int mask) const;
+
+    std::string m_vertexPath;
+    std::string m_fragmentPath;
+    std::vector<std::string> m_featureNames;
+    std::vector<ShaderProgram> m_variants;  // indexed by mask
+    std::vector<bool> m_built;
+    LinkCallback m_onLink;
+};
+
+#endif
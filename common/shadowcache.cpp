@@ -0,0 +1,369 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the cached shadow cube map.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "shaderprogram.hpp"
+#include "frustum.hpp"
+#include "streambuffer.hpp"
+#include "glstate.hpp"
+#include "shadowcache.hpp"
+
+const unsigned int ShadowCache::kFaces;
+
+// Look direction and up vector of each face, in GL_TEXTURE_CUBE_MAP_POSITIVE_X
+// + i order, matching the face selection and orientation of cube lookups
+static const float kFaceAxes[ShadowCache::kFaces][2][3] =
+{
+    { { 1, 0, 0 }, { 0, -1, 0 } },
+    { { -1, 0, 0 }, { 0, -1, 0 } },
+    { { 0, 1, 0 }, { 0, 0, 1 } },
+    { { 0, -1, 0 }, { 0, 0, -1 } },
+    { { 0, 0, 1 }, { 0, -1, 0 } },
+    { { 0, 0, -1 }, { 0, -1, 0 } },
+};
+
+ShadowCache::ShadowCache()
+    : m_resolution(0), m_near(0.05f), m_far(1.0f), m_light(0.0f), m_lightSet(false),
+      m_texture(0), m_vao(0), m_baseHandle(-1), m_viewProjHandle(-1), m_indexCount(0),
+      m_indexType(GL_UNSIGNED_SHORT)
+{
+    for (unsigned int f = 0; f < kFaces; f++)
+    {
+        m_framebuffers[f] = 0;
+        m_dirty[f].x0 = m_dirty[f].y0 = m_dirty[f].x1 = m_dirty[f].y1 = 0;
+    }
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+bool ShadowCache::init(unsigned int resolution, float nearPlane, float farPlane,
+                       const char* vertex_file_path, const char* fragment_file_path,
+                       const ShadowCasterMesh& mesh, const std::vector<glm::vec4>& casterSpheres)
+{
+    m_resolution = resolution;
+    m_near = nearPlane;
+    m_far = farPlane;
+    m_projection = glm::perspective(glm::half_pi<float>(), 1.0f, m_near, m_far);
+    m_indexCount = mesh.indexCount;
+    m_indexType = mesh.indexType;
+    buildSphereSoA(casterSpheres, m_spheres);
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    if (!m_program.load(vertex_file_path, fragment_file_path))
+    {
+        return false;
+    }
+    m_baseHandle = m_program.uniform("M");
+    m_viewProjHandle = m_program.uniform("FaceViewProj");
+    m_program.use();
+    m_program.setMat4(m_baseHandle, mesh.base);
+
+    // Hardware 2x2 PCF: linear filtering with depth comparison
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, m_texture);
+    for (unsigned int f = 0; f < kFaces; f++)
+    {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, 0, GL_DEPTH_COMPONENT24, resolution, resolution, 0,
+                     GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS); // filter across face edges
+
+    glGenFramebuffers(kFaces, m_framebuffers);
+    for (unsigned int f = 0; f < kFaces; f++)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[f]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + f,
+                               m_texture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            printf("Shadow cube face %u framebuffer incomplete (0x%x)\n", f, status);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            destroy();
+            return false;
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Room for every caster in one face; update() grows it when needed
+    m_instances.init(GLsizeiptr(std::max<size_t>(casterSpheres.size(), 1) * sizeof(glm::vec4)));
+
+    // Positions from the mesh, placement per instance (the pointer of
+    // attribute 3 is set per face in update())
+    glGenVertexArrays(1, &m_vao);
+    glBindVertexArray(m_vao);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.positionBuffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glEnableVertexAttribArray(3);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instances.buffer());
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glVertexAttribDivisor(3, 1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.elementBuffer);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glsInvalidate();
+    invalidateAll();
+    return true;
+}
+
+void ShadowCache::destroy()
+{
+    m_instances.destroy();
+    if (m_vao)
+    {
+        glDeleteVertexArrays(1, &m_vao);
+        m_vao = 0;
+    }
+    if (m_framebuffers[0])
+    {
+        glDeleteFramebuffers(kFaces, m_framebuffers);
+        for (unsigned int f = 0; f < kFaces; f++)
+        {
+            m_framebuffers[f] = 0;
+        }
+    }
+    if (m_texture)
+    {
+        glDeleteTextures(1, &m_texture);
+        m_texture = 0;
+    }
+    m_program.destroy();
+    glsInvalidate();
+}
+
+void ShadowCache::setLight(const glm::vec3& position)
+{
+    if (m_lightSet && position == m_light)
+    {
+        return;
+    }
+    m_light = position;
+    m_lightSet = true;
+    for (unsigned int f = 0; f < kFaces; f++)
+    {
+        glm::vec3 axis(kFaceAxes[f][0][0], kFaceAxes[f][0][1], kFaceAxes[f][0][2]);
+        glm::vec3 up(kFaceAxes[f][1][0], kFaceAxes[f][1][1], kFaceAxes[f][1][2]);
+        m_faceView[f] = glm::lookAt(m_light, m_light + axis, up);
+    }
+    invalidateAll();
+}
+
+void ShadowCache::addRegion(unsigned int face, int x0, int y0, int x1, int y1)
+{
+    FaceRegion& r = m_dirty[face];
+    if (r.x0 >= r.x1)
+    {
+        r.x0 = x0; r.y0 = y0; r.x1 = x1; r.y1 = y1;
+        return;
+    }
+    r.x0 = std::min(r.x0, x0);
+    r.y0 = std::min(r.y0, y0);
+    r.x1 = std::max(r.x1, x1);
+    r.y1 = std::max(r.y1, y1);
+}
+
+void ShadowCache::invalidateAll()
+{
+    for (unsigned int f = 0; f < kFaces; f++)
+    {
+        addRegion(f, 0, 0, int(m_resolution), int(m_resolution));
+    }
+}
+
+/*
+* invalidateSphere
+* ------------------------------------------------------------------
+* Purpose: Dirty the pixels of each face the sphere can project to. With
+* a 90 degree face, ndc = view.xy / depth; over the sphere's box of x, y
+* in [c - r, c + r] and depth in [max(c - r, near), c + r] the ratio is
+* monotonic in each variable, so its extremes are at the box corners.
+*/
+void ShadowCache::invalidateSphere(const glm::vec4& sphere)
+{
+    const float res = float(m_resolution);
+    for (unsigned int f = 0; f < kFaces; f++)
+    {
+        glm::vec3 c = glm::vec3(m_faceView[f] * glm::vec4(glm::vec3(sphere), 1.0f));
+        float depth = -c.z;
+        float r = sphere.w;
+        if (depth + r <= m_near || depth - r >= m_far)
+        {
+            continue;
+        }
+        float depths[2] = { std::max(depth - r, m_near), depth + r };
+        float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f;
+        for (int d = 0; d < 2; d++)
+        {
+            for (int s = -1; s <= 1; s += 2)
+            {
+                float x = (c.x + s * r) / depths[d];
+                float y = (c.y + s * r) / depths[d];
+                minX = std::min(minX, x); maxX = std::max(maxX, x);
+                minY = std::min(minY, y); maxY = std::max(maxY, y);
+            }
+        }
+        if (minX >= 1.0f || maxX <= -1.0f || minY >= 1.0f || maxY <= -1.0f)
+        {
+            continue;
+        }
+        // One pixel of slack for rasterization at the edge
+        int x0 = std::max(int(floorf((std::max(minX, -1.0f) * 0.5f + 0.5f) * res)) - 1, 0);
+        int y0 = std::max(int(floorf((std::max(minY, -1.0f) * 0.5f + 0.5f) * res)) - 1, 0);
+        int x1 = std::min(int(ceilf((std::min(maxX, 1.0f) * 0.5f + 0.5f) * res)) + 1, int(m_resolution));
+        int y1 = std::min(int(ceilf((std::min(maxY, 1.0f) * 0.5f + 0.5f) * res)) + 1, int(m_resolution));
+        addRegion(f, x0, y0, x1, y1);
+    }
+}
+
+bool ShadowCache::dirty() const
+{
+    for (unsigned int f = 0; f < kFaces; f++)
+    {
+        if (m_dirty[f].x0 < m_dirty[f].x1)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+glm::vec2 ShadowCache::depthParams() const
+{
+    return glm::vec2(m_far / (m_far - m_near), -m_far * m_near / (m_far - m_near));
+}
+
+unsigned int ShadowCache::update(const glm::vec4* placements, GLuint framebuffer, int width, int height)
+{
+    m_stats.lastFaces = 0;
+    if (!dirty())
+    {
+        return 0;
+    }
+
+    // Cull first, for every dirty region: the casters of all faces go into
+    // one allocation. The cull frustum is the face frustum cropped to the
+    // region, so a small region only redraws the casters that reach it.
+    const float res = float(m_resolution);
+    unsigned int faces[kFaces];
+    unsigned int faceCount = 0;
+    m_faceFirst.clear();
+    m_faceCasters.clear();
+    for (unsigned int f = 0; f < kFaces; f++)
+    {
+        const FaceRegion& r = m_dirty[f];
+        if (r.x0 >= r.x1)
+        {
+            continue;
+        }
+        float nx0 = 2.0f * r.x0 / res - 1.0f, nx1 = 2.0f * r.x1 / res - 1.0f;
+        float ny0 = 2.0f * r.y0 / res - 1.0f, ny1 = 2.0f * r.y1 / res - 1.0f;
+        glm::mat4 crop(1.0f);
+        crop[0][0] = 2.0f / (nx1 - nx0);
+        crop[1][1] = 2.0f / (ny1 - ny0);
+        crop[3][0] = -(nx1 + nx0) / (nx1 - nx0);
+        crop[3][1] = -(ny1 + ny0) / (ny1 - ny0);
+        glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+        extractFrustumPlanes(crop * m_projection * m_faceView[f], planes);
+        unsigned int n = cullSpheres(planes, m_spheres, m_visible);
+
+        faces[faceCount++] = f;
+        m_faceFirst.push_back((unsigned int)m_faceCasters.size());
+        m_faceCasters.insert(m_faceCasters.end(), m_visible.begin(), m_visible.begin() + n);
+    }
+    m_faceFirst.push_back((unsigned int)m_faceCasters.size());
+
+    GLsizeiptr bytes = GLsizeiptr(m_faceCasters.size() * sizeof(glm::vec4));
+    if (bytes > m_instances.segmentBytes())
+    {
+        m_instances.resize(bytes + bytes / 2);
+    }
+    m_instances.beginFrame();
+    StreamAllocation instances = m_instances.allocate(std::max<GLsizeiptr>(bytes, sizeof(glm::vec4)));
+    glm::vec4* out = (glm::vec4*)instances.data;
+    for (size_t i = 0; i < m_faceCasters.size(); i++)
+    {
+        out[i] = placements[m_faceCasters[i]];
+    }
+    m_instances.flush();
+
+    // Depth only, both sides (the mesh is not closed), with a slope-scaled
+    // offset against acne on surfaces facing the light
+    m_program.use();
+    glsBindVertexArray(m_vao);
+    glsBindBuffer(GL_ARRAY_BUFFER, m_instances.buffer());
+    glsDisable(GL_CULL_FACE);
+    glsEnable(GL_DEPTH_TEST);
+    glsDepthMask(GL_TRUE);
+    glsDepthFunc(GL_LESS);
+    glsEnable(GL_POLYGON_OFFSET_FILL);
+    glsPolygonOffset(2.0f, 4.0f);
+    glsEnable(GL_SCISSOR_TEST);
+    glViewport(0, 0, m_resolution, m_resolution);
+
+    for (unsigned int i = 0; i < faceCount; i++)
+    {
+        const unsigned int f = faces[i];
+        FaceRegion& r = m_dirty[f];
+        glsBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[f]);
+        glScissor(r.x0, r.y0, r.x1 - r.x0, r.y1 - r.y0);
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        GLsizei casters = GLsizei(m_faceFirst[i + 1] - m_faceFirst[i]);
+        if (casters > 0)
+        {
+            m_program.setMat4(m_viewProjHandle, m_projection * m_faceView[f]);
+            GLintptr offset = instances.offset + GLintptr(m_faceFirst[i] * sizeof(glm::vec4));
+            glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, (void*)offset);
+            glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, m_indexType, (void*)0, casters);
+        }
+
+        m_stats.facesRendered++;
+        m_stats.pixelsRendered += double(r.x1 - r.x0) * double(r.y1 - r.y0);
+        if (r.x1 - r.x0 == int(m_resolution) && r.y1 - r.y0 == int(m_resolution))
+        {
+            m_stats.fullFaces++;
+        }
+        m_stats.castersDrawn += casters;
+        r.x0 = r.y0 = r.x1 = r.y1 = 0;
+    }
+    m_instances.endFrame();
+
+    glsDisable(GL_SCISSOR_TEST);
+    glsDisable(GL_POLYGON_OFFSET_FILL);
+    glsEnable(GL_CULL_FACE);
+    glsBindVertexArray(0);
+    glsBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+
+    m_stats.updates++;
+    m_stats.lastFaces = faceCount;
+    return faceCount;
+}
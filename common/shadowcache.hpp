@@ -0,0 +1,138 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Cached omnidirectional shadow map for the point light. The six faces of
+* a depth cube map are rendered once and then kept: each face carries a
+* dirty rectangle, and only that rectangle of only the dirty faces is
+* cleared and redrawn. Moving the light dirties every face; a caster that
+* moved (or spins in place) dirties the region its bounding sphere covers
+* on each face, and only the casters whose spheres reach into that region
+* are drawn again. A static scene with a fixed light renders the map once
+* and pays nothing afterwards, however the camera moves.
+*
+* Casters share one mesh and are drawn instanced from their placements
+* (xyz position, w yaw, as in the INSTANCED shader variant). Receivers
+* sample the map through a samplerCubeShadow in the SHADOWS variant of
+* StandardShading, comparing against the depth the face projection would
+* have stored for them (depthParams()).
+*/
+
+#ifndef SHADOWCACHE_HPP
+#define SHADOWCACHE_HPP
+
+#include <vector>
+
+// The shared caster mesh: positions only, the instanced model matrix is
+// translate(xyz) * rotateZ(yaw) * base
+struct ShadowCasterMesh
+{
+    GLuint    positionBuffer;  // vec3 per vertex
+    GLuint    elementBuffer;
+    GLsizei   indexCount;
+    GLenum    indexType;
+    glm::mat4 base;
+};
+
+struct ShadowStats
+{
+    unsigned int updates;        // update() calls that rendered something
+    unsigned int facesRendered;  // face (region) renders, all frames
+    unsigned int fullFaces;      // of those, renders of a whole face
+    double       pixelsRendered; // face pixels cleared and redrawn, all frames
+    unsigned int castersDrawn;   // caster instances drawn, all frames
+    unsigned int lastFaces;      // faces rendered by the latest update()
+};
+
+class ShadowCache
+{
+public:
+    static const unsigned int kFaces = 6;
+
+    ShadowCache();
+
+    /*
+    * init()
+    * ------------------------------------------------------------------
+    * Purpose: Create a `resolution`^2 depth cube map and the depth-only
+    * program, and take the casters' bounding spheres (which must cover
+    * every pose a caster takes, e.g. all yaws of a spinning one). Depth
+    * is stored for distances along a face axis in [nearPlane, farPlane].
+    * Returns: false if the shaders or the framebuffer cannot be built.
+    */
+    bool init(unsigned int resolution, float nearPlane, float farPlane,
+              const char* vertex_file_path, const char* fragment_file_path,
+              const ShadowCasterMesh& mesh, const std::vector<glm::vec4>& casterSpheres);
+    void destroy();
+
+    // Move the light; every face is dirty if it actually moved
+    void setLight(const glm::vec3& position);
+
+    // Something inside this sphere changed (a caster's old or new pose)
+    void invalidateSphere(const glm::vec4& sphere);
+    void invalidateAll();
+
+    bool dirty() const;
+
+    /*
+    * update()
+    * ------------------------------------------------------------------
+    * Purpose: Redraw the dirty region of every dirty face with the
+    * casters at `placements` (one per caster sphere) and mark the map
+    * clean. When anything was rendered, `framebuffer` (`width` x `height`,
+    * 0 = the window) is bound again with its viewport; the caller names
+    * its target so no GL state has to be read back.
+    * Returns: the number of face regions rendered (0 when clean).
+    */
+    unsigned int update(const glm::vec4* placements, GLuint framebuffer, int width, int height);
+
+    GLuint texture() const { return m_texture; }
+
+    // (x, y): depth01 = x + y / axisDistance for a point whose largest
+    // light-space coordinate magnitude is axisDistance
+    glm::vec2 depthParams() const;
+
+    const ShadowStats& stats() const { return m_stats; }
+
+private:
+    ShadowCache(const ShadowCache&);
+    ShadowCache& operator=(const ShadowCache&);
+
+    // Pixel rectangle [x0, x1) x [y0, y1); empty when x0 >= x1
+    struct FaceRegion
+    {
+        int x0, y0, x1, y1;
+    };
+
+    void addRegion(unsigned int face, int x0, int y0, int x1, int y1);
+
+    unsigned int   m_resolution;
+    float          m_near;
+    float          m_far;
+    glm::vec3      m_light;
+    bool           m_lightSet;
+    glm::mat4      m_faceView[kFaces];
+    glm::mat4      m_projection;
+    FaceRegion     m_dirty[kFaces];
+
+    GLuint         m_texture;
+    GLuint         m_framebuffers[kFaces];  // one per face, so no re-attaching
+    GLuint         m_vao;
+    ShaderProgram  m_program;
+    UniformHandle  m_baseHandle;
+    UniformHandle  m_viewProjHandle;
+    GLsizei        m_indexCount;
+    GLenum         m_indexType;
+
+    SphereSoA                  m_spheres;
+    std::vector<unsigned int>  m_visible;      // cull output for one face
+    std::vector<unsigned int>  m_faceFirst;    // per rendered face: first entry in m_faceCasters
+    std::vector<unsigned int>  m_faceCasters;  // caster indices of every face this update
+    StreamBuffer               m_instances;
+
+    ShadowStats    m_stats;
+};
+
+#endif
@@ -0,0 +1,195 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the fenced streaming ring.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "glstate.hpp"
+#include "clock.hpp"
+#include "streambuffer.hpp"
+
+const unsigned int StreamBuffer::kFrames;
+const GLsizeiptr StreamBuffer::kSegmentAlignment;
+
+// Binding point used only to create, map and fill the buffer, so the
+// array / element / uniform bindings of the callers are left alone
+static const GLenum kStreamTarget = GL_COPY_WRITE_BUFFER;
+
+StreamBuffer::StreamBuffer()
+    : m_buffer(0), m_segmentBytes(0), m_mapped(NULL), m_segment(0), m_used(0), m_flushed(0)
+{
+    for (unsigned int i = 0; i < kFrames; i++)
+    {
+        m_fences[i] = 0;
+    }
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    // GL objects are released by destroy(), while the context is current
+}
+
+void StreamBuffer::init(GLsizeiptr segmentBytes)
+{
+    destroy();
+    m_segmentBytes = (segmentBytes + kSegmentAlignment - 1) / kSegmentAlignment * kSegmentAlignment;
+    createStorage();
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_segment = 0;
+    m_used = m_flushed = 0;
+}
+
+void StreamBuffer::createStorage()
+{
+    const GLsizeiptr totalBytes = m_segmentBytes * kFrames;
+    glGenBuffers(1, &m_buffer);
+    glsBindBuffer(kStreamTarget, m_buffer);
+    m_mapped = NULL;
+    if (GLEW_ARB_buffer_storage)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(kStreamTarget, totalBytes, NULL, flags);
+        m_mapped = (unsigned char*)glMapBufferRange(kStreamTarget, 0, totalBytes, flags);
+    }
+    else
+    {
+        glBufferData(kStreamTarget, totalBytes, NULL, GL_STREAM_DRAW);
+    }
+    if (!m_mapped)
+    {
+        m_staging.assign(size_t(m_segmentBytes), 0);
+    }
+    glsBindBuffer(kStreamTarget, 0);
+}
+
+void StreamBuffer::releaseStorage()
+{
+    for (unsigned int i = 0; i < kFrames; i++)
+    {
+        waitSegment(i, false);
+    }
+    if (m_mapped)
+    {
+        glsBindBuffer(kStreamTarget, m_buffer);
+        glUnmapBuffer(kStreamTarget);
+        m_mapped = NULL;
+    }
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+    std::vector<unsigned char>().swap(m_staging);
+    glsInvalidate();
+}
+
+void StreamBuffer::destroy()
+{
+    if (m_buffer)
+    {
+        releaseStorage();
+    }
+    m_segmentBytes = 0;
+}
+
+void StreamBuffer::resize(GLsizeiptr segmentBytes)
+{
+    GLsizeiptr rounded = (segmentBytes + kSegmentAlignment - 1) / kSegmentAlignment * kSegmentAlignment;
+    if (rounded <= m_segmentBytes)
+    {
+        return;
+    }
+    if (m_buffer)
+    {
+        releaseStorage();
+    }
+    m_segmentBytes = rounded;
+    createStorage();
+    m_used = m_flushed = 0;
+}
+
+void StreamBuffer::waitSegment(unsigned int segment, bool countStall)
+{
+    GLsync& fence = m_fences[segment];
+    if (!fence)
+    {
+        return;
+    }
+    // Normally signaled long ago: the segment was used kFrames frames back
+    if (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+    {
+        double start = clockSeconds();
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(-1));
+        if (countStall)
+        {
+            m_stats.stalls++;
+            m_stats.stallMs += (clockSeconds() - start) * 1000.0;
+        }
+    }
+    glDeleteSync(fence);
+    fence = 0;
+}
+
+void StreamBuffer::beginFrame()
+{
+    m_segment = (m_segment + 1) % kFrames;
+    waitSegment(m_segment, true);
+    m_used = m_flushed = 0;
+    m_stats.frameBytes = 0;
+}
+
+StreamAllocation StreamBuffer::allocate(GLsizeiptr bytes, GLsizeiptr alignment)
+{
+    StreamAllocation allocation = { NULL, 0 };
+    GLsizeiptr offset = (m_used + alignment - 1) & ~(alignment - 1);
+    if (offset + bytes > m_segmentBytes)
+    {
+        m_stats.overflows++;
+        return allocation;
+    }
+    m_used = offset + bytes;
+    m_stats.frameBytes = m_used;
+    if (m_used > m_stats.peakBytes)
+    {
+        m_stats.peakBytes = m_used;
+    }
+
+    allocation.offset = m_segmentBytes * m_segment + offset;
+    allocation.data = m_mapped ? (void*)(m_mapped + allocation.offset) : (void*)&m_staging[size_t(offset)];
+    return allocation;
+}
+
+void StreamBuffer::flush()
+{
+    if (m_mapped || m_flushed == m_used)
+    {
+        return;
+    }
+    // Alignment gaps are copied along; they are never read
+    glsBindBuffer(kStreamTarget, m_buffer);
+    void* dst = glMapBufferRange(kStreamTarget, m_segmentBytes * m_segment + m_flushed, m_used - m_flushed,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (dst)
+    {
+        memcpy(dst, &m_staging[size_t(m_flushed)], size_t(m_used - m_flushed));
+        glUnmapBuffer(kStreamTarget);
+    }
+    glsBindBuffer(kStreamTarget, 0);
+    m_flushed = m_used;
+}
+
+void StreamBuffer::endFrame()
+{
+    if (m_fences[m_segment])
+    {
+        glDeleteSync(m_fences[m_segment]);
+    }
+    m_fences[m_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,112 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Streaming allocator for per-frame GPU data (vertices, indices, instance
+* streams, uniform blocks). One buffer holds kFrames segments; each frame
+* sub-allocates aligned ranges from its own segment, writes them through
+* a CPU pointer and draws from buffer() at the returned offsets. A fence
+* per segment keeps the CPU from overwriting data the GPU may still read;
+* a frame that has to wait for one is counted as a stall.
+*
+* With GL 4.4 / ARB_buffer_storage the storage is immutable and stays
+* persistently, coherently mapped: allocate() hands out pointers straight
+* into it. Otherwise the pointers point into a CPU copy of the segment and
+* flush() writes the new bytes with one unsynchronized map (the fence
+* already guarantees the range is free). Neither path reallocates storage
+* per frame; only resize() does.
+*/
+
+#ifndef STREAMBUFFER_HPP
+#define STREAMBUFFER_HPP
+
+#include <vector>
+
+struct StreamAllocation
+{
+    void*    data;    // write the data here; NULL when the segment is full
+    GLintptr offset;  // byte offset in buffer() for binds and attribute pointers
+};
+
+struct StreamStats
+{
+    unsigned int stalls;       // beginFrame() calls that waited on the GPU
+    double       stallMs;      // time spent in those waits
+    unsigned int overflows;    // allocations refused for lack of space
+    GLsizeiptr   frameBytes;   // bytes allocated in the current / last frame
+    GLsizeiptr   peakBytes;    // most bytes any frame allocated
+};
+
+class StreamBuffer
+{
+public:
+    static const unsigned int kFrames = 3;
+
+    // Segment sizes are rounded to this, so every segment starts at an
+    // offset any allocate() alignment up to this value divides
+    static const GLsizeiptr kSegmentAlignment = 256;
+
+    StreamBuffer();
+    ~StreamBuffer();
+
+    // Allocate the ring with `segmentBytes` of space per frame
+    void init(GLsizeiptr segmentBytes);
+    void destroy();
+
+    /*
+    * resize()
+    * ------------------------------------------------------------------
+    * Purpose: Replace the storage with larger segments. Waits until the
+    * GPU is done with every segment and creates a new buffer name, so
+    * callers must re-point anything that captured buffer() (VAOs). Call
+    * between frames.
+    */
+    void resize(GLsizeiptr segmentBytes);
+
+    // Move to the next segment, waiting for the GPU to release it
+    void beginFrame();
+
+    /*
+    * allocate()
+    * ------------------------------------------------------------------
+    * Purpose: Reserve `bytes` in this frame's segment at an offset that is
+    * a multiple of `alignment` (a power of two <= kSegmentAlignment, e.g.
+    * GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT).
+    * Returns: data == NULL if the segment has no room left.
+    */
+    StreamAllocation allocate(GLsizeiptr bytes, GLsizeiptr alignment = 16);
+
+    // Make the bytes written since the last flush visible to GL; call
+    // before the draws that read them (a no-op when persistently mapped)
+    void flush();
+
+    // Fence this frame's segment after its last draw
+    void endFrame();
+
+    GLuint buffer() const { return m_buffer; }
+    GLsizeiptr segmentBytes() const { return m_segmentBytes; }
+    bool persistent() const { return m_mapped != NULL; }
+    const StreamStats& stats() const { return m_stats; }
+
+private:
+    StreamBuffer(const StreamBuffer&);
+    StreamBuffer& operator=(const StreamBuffer&);
+
+    void createStorage();
+    void releaseStorage();
+    void waitSegment(unsigned int segment, bool countStall);
+
+    GLuint         m_buffer;
+    GLsizeiptr     m_segmentBytes;
+    unsigned char* m_mapped;        // whole ring, when persistent
+    std::vector<unsigned char> m_staging;  // current segment, when not persistent
+    GLsync         m_fences[kFrames];
+    unsigned int   m_segment;       // segment of the current frame
+    GLsizeiptr     m_used;          // bytes allocated in it
+    GLsizeiptr     m_flushed;       // bytes of it already written to GL
+    StreamStats    m_stats;
+};
+
+#endif
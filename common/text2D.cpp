@@ -1,5 +1,6 @@
 #include <vector>
 #include <cstring>
+#include <stdio.h>
 
 #include <GL/glew.h>
 
@@ -11,110 +12,196 @@ using namespace glm;
 #include "texture.hpp"
 
 #include "text2D.hpp"
+#include "glstate.hpp"
+#include "streambuffer.hpp"
+
+// Strings are not drawn by printText2D() any more. Each character becomes
+// one 4-byte glyph record appended to a ring buffer, and the whole frame's
+// text is drawn by flushText2D() as instanced quads: the vertex shader builds
+// the 6 corners from gl_VertexID and the 16x16 atlas UVs from the character
+// code (same math as the old character%16 code), so the CPU writes 4 bytes
+// per glyph instead of 6 positions + 6 UVs (96 bytes).
+// The records live in a StreamBuffer (streambuffer.hpp): one segment per
+// frame in flight, fenced, persistently mapped where the driver allows it.
+// Nothing is allocated per string.
+
+// Glyph record: bits 0-7 character code, bits 8-19 pixel column (x),
+// bits 20-31 pixel line (y) of the glyph's lower-left corner.
+typedef unsigned int GlyphRecord;
+static const int kGlyphCoordMax = 4095;
+
+// Consecutive glyphs sharing one size; the size is a uniform, so each run
+// is one instanced draw (a HUD with a single font size is one draw).
+struct GlyphRun {
+	unsigned int first;
+	unsigned int count;
+	int size;
+};
+
+static const unsigned int kMaxGlyphsPerSegment = 8192;  // per frame
+static const unsigned int kMaxRunsPerFrame     = 16;
 
 unsigned int Text2DTextureID;
-unsigned int Text2DVertexBufferID;
-unsigned int Text2DUVBufferID;
+unsigned int Text2DVertexArrayID;
 unsigned int Text2DShaderID;
 unsigned int Text2DUniformID;
+unsigned int Text2DGlyphSizeID;
+
+static StreamBuffer  Text2DStream;
+static GlyphRecord * Text2DWrite = NULL;             // this frame's records, NULL between frames
+static GLintptr      Text2DWriteOffset = 0;          // their offset in the stream buffer
+static unsigned int  Text2DGlyphCount = 0;           // glyphs queued this frame
+static GlyphRun      Text2DRuns[kMaxRunsPerFrame];
+static unsigned int  Text2DRunCount = 0;
+static bool         Text2DOverflowReported = false;
 
 void initText2D(const char * texturePath){
 
 	// Initialize texture
 	Text2DTextureID = loadDDS(texturePath);
 
-	// Initialize VBO
-	glGenBuffers(1, &Text2DVertexBufferID);
-	glGenBuffers(1, &Text2DUVBufferID);
+	// Initialize the glyph stream and the VAO reading one record per instance
+	Text2DStream.init(GLsizeiptr(sizeof(GlyphRecord)) * kMaxGlyphsPerSegment);
+
+	glGenVertexArrays(1, &Text2DVertexArrayID);
+	glBindVertexArray(Text2DVertexArrayID);
+	glBindBuffer(GL_ARRAY_BUFFER, Text2DStream.buffer());
+
+	// 1rst attribute : packed glyph record, advanced once per instance
+	// (the pointer offset is set per run in flushText2D)
+	glEnableVertexAttribArray(0);
+	glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(GlyphRecord), (void*)0 );
+	glVertexAttribDivisor(0, 1);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	// Initialize Shader
 	Text2DShaderID = LoadShaders( "TextVertexShader.vertexshader", "TextVertexShader.fragmentshader" );
 
 	// Initialize uniforms' IDs
 	Text2DUniformID = glGetUniformLocation( Text2DShaderID, "myTextureSampler" );
+	Text2DGlyphSizeID = glGetUniformLocation( Text2DShaderID, "GlyphSize" );
 
 }
 
+// Start this frame's segment (waits until the GPU released it) and point
+// Text2DWrite at room for a full frame of glyphs.
+static void beginTextSegment(){
+
+	Text2DStream.beginFrame();
+	StreamAllocation records = Text2DStream.allocate(GLsizeiptr(sizeof(GlyphRecord)) * kMaxGlyphsPerSegment,
+		sizeof(GlyphRecord));
+	Text2DWrite = (GlyphRecord*)records.data;
+	Text2DWriteOffset = records.offset;
+	Text2DGlyphCount = 0;
+	Text2DRunCount = 0;
+}
+
 void printText2D(const char * text, int x, int y, int size){
 
+	if ( Text2DWrite == NULL ){
+		beginTextSegment();
+		if ( Text2DWrite == NULL )
+			return;
+	}
+
 	unsigned int length = strlen(text);
+	if ( Text2DGlyphCount + length > kMaxGlyphsPerSegment ){
+		if ( !Text2DOverflowReported )
+			printf("printText2D: more than %u glyphs this frame, extra text dropped\n", kMaxGlyphsPerSegment);
+		Text2DOverflowReported = true;
+		length = kMaxGlyphsPerSegment - Text2DGlyphCount;
+	}
+	if ( length == 0 || y < 0 || y > kGlyphCoordMax )
+		return;
+
+	// Start a new run when the glyph size changes
+	if ( Text2DRunCount == 0 || Text2DRuns[Text2DRunCount-1].size != size ){
+		if ( Text2DRunCount == kMaxRunsPerFrame ){
+			if ( !Text2DOverflowReported )
+				printf("printText2D: more than %u font sizes this frame, extra text dropped\n", kMaxRunsPerFrame);
+			Text2DOverflowReported = true;
+			return;
+		}
+		GlyphRun run = { Text2DGlyphCount, 0, size };
+		Text2DRuns[Text2DRunCount++] = run;
+	}
 
-	// Fill buffers
-	std::vector<glm::vec2> vertices;
-	std::vector<glm::vec2> UVs;
+	// Fill the mapped segment directly: one record per visible character
+	GlyphRecord * out = Text2DWrite + Text2DGlyphCount;
+	unsigned int written = 0;
 	for ( unsigned int i=0 ; i<length ; i++ ){
-		
-		glm::vec2 vertex_up_left    = glm::vec2( x+i*size     , y+size );
-		glm::vec2 vertex_up_right   = glm::vec2( x+i*size+size, y+size );
-		glm::vec2 vertex_down_right = glm::vec2( x+i*size+size, y      );
-		glm::vec2 vertex_down_left  = glm::vec2( x+i*size     , y      );
-
-		vertices.push_back(vertex_up_left   );
-		vertices.push_back(vertex_down_left );
-		vertices.push_back(vertex_up_right  );
-
-		vertices.push_back(vertex_down_right);
-		vertices.push_back(vertex_up_right);
-		vertices.push_back(vertex_down_left);
-
-		char character = text[i];
-		float uv_x = (character%16)/16.0f;
-		float uv_y = (character/16)/16.0f;
-
-		glm::vec2 uv_up_left    = glm::vec2( uv_x           , uv_y );
-		glm::vec2 uv_up_right   = glm::vec2( uv_x+1.0f/16.0f, uv_y );
-		glm::vec2 uv_down_right = glm::vec2( uv_x+1.0f/16.0f, (uv_y + 1.0f/16.0f) );
-		glm::vec2 uv_down_left  = glm::vec2( uv_x           , (uv_y + 1.0f/16.0f) );
-		UVs.push_back(uv_up_left   );
-		UVs.push_back(uv_down_left );
-		UVs.push_back(uv_up_right  );
-
-		UVs.push_back(uv_down_right);
-		UVs.push_back(uv_up_right);
-		UVs.push_back(uv_down_left);
+		int column = x + int(i) * size;
+		if ( column < 0 || column > kGlyphCoordMax )
+			continue;
+		unsigned char character = (unsigned char)text[i];
+		out[written++] = GlyphRecord(character) | (GlyphRecord(column) << 8) | (GlyphRecord(y) << 20);
 	}
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), &vertices[0], GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DUVBufferID);
-	glBufferData(GL_ARRAY_BUFFER, UVs.size() * sizeof(glm::vec2), &UVs[0], GL_STATIC_DRAW);
+	Text2DGlyphCount += written;
+	Text2DRuns[Text2DRunCount-1].count += written;
+}
 
-	// Bind shader
-	glUseProgram(Text2DShaderID);
+void flushText2D(){
 
-	// Bind texture
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, Text2DTextureID);
-	// Set our "myTextureSampler" sampler to use Texture Unit 0
-	glUniform1i(Text2DUniformID, 0);
+	if ( Text2DWrite == NULL )
+		return;
 
-	// 1rst attribute buffer : vertices
-	glEnableVertexAttribArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
+	// The segment is fenced even when empty, so the next frame's wait is
+	// on this frame's commands
+	Text2DWrite = NULL;
+	if ( Text2DGlyphCount == 0 ){
+		Text2DStream.endFrame();
+		return;
+	}
+	Text2DStream.flush();
 
-	// 2nd attribute buffer : UVs
-	glEnableVertexAttribArray(1);
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DUVBufferID);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
+	// Bind shader (through the state shadow: the HUD state is normally
+	// still current from the last frame except for what the scene changed)
+	glsUseProgram(Text2DShaderID);
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// Bind texture
+	glsActiveTexture(GL_TEXTURE0);
+	glsBindTexture(GL_TEXTURE_2D, Text2DTextureID);
+	// Set our "myTextureSampler" sampler to use Texture Unit 0
+	glUniform1i(Text2DUniformID, 0);
 
-	// Draw call
-	glDrawArrays(GL_TRIANGLES, 0, vertices.size() );
+	glsBindVertexArray(Text2DVertexArrayID);
+
+	// The HUD always sits on top of the scene (the shadow answers the
+	// depth-test query without a driver round trip)
+	bool depthWasEnabled = glsIsEnabled(GL_DEPTH_TEST);
+	glsDisable(GL_DEPTH_TEST);
+	glsEnable(GL_BLEND);
+	glsBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// One instanced draw per glyph size (normally one for the whole frame):
+	// 6 vertices per glyph, one glyph record per instance
+	glsBindBuffer(GL_ARRAY_BUFFER, Text2DStream.buffer());
+	for ( unsigned int r=0 ; r<Text2DRunCount ; r++ ){
+		size_t offset = size_t(Text2DWriteOffset) + sizeof(GlyphRecord) * Text2DRuns[r].first;
+		glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(GlyphRecord), (void*)offset );
+		glUniform1f(Text2DGlyphSizeID, float(Text2DRuns[r].size));
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, Text2DRuns[r].count);
+	}
 
-	glDisable(GL_BLEND);
+	glsDisable(GL_BLEND);
+	if ( depthWasEnabled )
+		glsEnable(GL_DEPTH_TEST);
 
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
+	glsBindVertexArray(0);
 
+	// The segment may be reused once the GPU has consumed this draw
+	Text2DStream.endFrame();
+	Text2DGlyphCount = 0;
+	Text2DRunCount = 0;
 }
 
 void cleanupText2D(){
 
 	// Delete buffers
-	glDeleteBuffers(1, &Text2DVertexBufferID);
-	glDeleteBuffers(1, &Text2DUVBufferID);
+	Text2DStream.destroy();
+	glDeleteVertexArrays(1, &Text2DVertexArrayID);
 
 	// Delete texture
 	glDeleteTextures(1, &Text2DTextureID);
@@ -2,7 +2,10 @@
 #define TEXT2D_HPP
 
 void initText2D(const char * texturePath);
+// Queue a string; nothing is drawn until flushText2D()
 void printText2D(const char * text, int x, int y, int size);
+// Draw every string queued since the last flush (once per frame, last)
+void flushText2D();
 void cleanupText2D();
 
 #endif
\ No newline at end of file
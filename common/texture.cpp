@@ -6,6 +6,8 @@
 
 #include <GLFW/glfw3.h>
 
+#include "profiler.hpp"
+
 
 GLuint loadBMP_custom(const char * imagepath){
 
@@ -125,6 +127,7 @@ GLuint loadBMP_custom(const char * imagepath){
 #define FOURCC_DXT5 0x35545844 // Equivalent to "DXT5" in ASCII
 
 GLuint loadDDS(const char * imagepath){
+	PROFILE_SCOPE("loadDDS");
 
 	unsigned char header[124];
 
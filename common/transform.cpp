@@ -0,0 +1,209 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Scalar transform kernel, kernel dispatch and the transform benchmark.
+*/
+
+#include <stdio.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "cpufeatures.hpp"
+#include "kernelbench.hpp"
+#include "transform.hpp"
+
+// AVX2 kernel, built in transform_avx2.cpp with AVX2/FMA code generation
+bool transformAvx2Compiled();
+void transformObjectsAvx2(const TransformSoA& objects, const unsigned int* indices, unsigned int count,
+                          const glm::mat4& base, const glm::mat4& viewProj,
+                          glm::mat4* models, glm::mat4* mvps);
+
+void buildTransformSoA(const std::vector<glm::vec4>& placements, TransformSoA& soa)
+{
+    soa.count = (unsigned int)placements.size();
+    soa.x.resize(soa.count);
+    soa.y.resize(soa.count);
+    soa.z.resize(soa.count);
+    soa.yaw.resize(soa.count);
+    soa.scale.assign(soa.count, 1.0f);
+    for (unsigned int i = 0; i < soa.count; i++)
+    {
+        soa.x[i] = placements[i].x;
+        soa.y[i] = placements[i].y;
+        soa.z[i] = placements[i].z;
+        soa.yaw[i] = placements[i].w;
+    }
+}
+
+TransformKernel bestTransformKernel()
+{
+    return (transformAvx2Compiled() && cpuSupportsAvx2()) ? TRANSFORM_AVX2 : TRANSFORM_SCALAR;
+}
+
+const char* transformKernelName(TransformKernel kernel)
+{
+    return kernel == TRANSFORM_AVX2 ? "AVX2" : "scalar";
+}
+
+/*
+* transformObjectsScalar
+* ------------------------------------------------------------------
+* Purpose: Reference kernel: the closed form of T * Rz * S applied to each
+* column of `base`, then one matrix product for the MVP. Handles entries
+* [first, end) of the same index space as transformObjects().
+*/
+static void transformObjectsScalar(const TransformSoA& objects, const unsigned int* indices,
+                                   unsigned int first, unsigned int end,
+                                   const glm::mat4& base, const glm::mat4& viewProj,
+                                   glm::mat4* models, glm::mat4* mvps)
+{
+    for (unsigned int i = first; i < end; i++)
+    {
+        unsigned int o = indices ? indices[i] : i;
+        float c = std::cos(objects.yaw[o]) * objects.scale[o];
+        float s = std::sin(objects.yaw[o]) * objects.scale[o];
+        glm::mat4 M;
+        for (int j = 0; j < 4; j++)
+        {
+            const glm::vec4& b = base[j];
+            M[j] = glm::vec4(c * b.x - s * b.y + objects.x[o] * b.w,
+                             s * b.x + c * b.y + objects.y[o] * b.w,
+                             objects.scale[o] * b.z + objects.z[o] * b.w,
+                             b.w);
+        }
+        if (models)
+        {
+            models[i] = M;
+        }
+        if (mvps)
+        {
+            mvps[i] = viewProj * M;
+        }
+    }
+}
+
+void transformObjects(const TransformSoA& objects, const unsigned int* indices, unsigned int count,
+                      const glm::mat4& base, const glm::mat4& viewProj,
+                      glm::mat4* models, glm::mat4* mvps, TransformKernel kernel)
+{
+    unsigned int done = 0;
+    if (kernel == TRANSFORM_AVX2 && transformAvx2Compiled() && cpuSupportsAvx2())
+    {
+        // Whole groups of 8; the tail goes through the scalar kernel
+        done = count & ~7u;
+        transformObjectsAvx2(objects, indices, done, base, viewProj, models, mvps);
+    }
+    transformObjectsScalar(objects, indices, done, count, base, viewProj, models, mvps);
+}
+
+// Largest element difference, relative to the size of the reference matrix
+static float matrixError(const glm::mat4& a, const glm::mat4& reference)
+{
+    float diff = 0.0f, size = 1.0f;
+    for (int j = 0; j < 4; j++)
+    {
+        for (int k = 0; k < 4; k++)
+        {
+            diff = std::max(diff, std::fabs(a[j][k] - reference[j][k]));
+            size = std::max(size, std::fabs(reference[j][k]));
+        }
+    }
+    return diff / size;
+}
+
+bool benchmarkTransforms(unsigned int count)
+{
+    // Random objects in a 200-unit square, any yaw, scale 0.5 .. 2
+    std::vector<float> random;
+    fillBenchmarkRandom(count, 5, random);
+    std::vector<glm::vec4> placements(count);
+    std::vector<float> scales(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const float* v = &random[5 * i];
+        placements[i] = glm::vec4(200.0f * v[0] - 100.0f, 200.0f * v[1] - 100.0f, 4.0f * v[2],
+                                  50.0f * v[3] - 25.0f);
+        scales[i] = 0.5f + 1.5f * v[4];
+    }
+    TransformSoA soa;
+    buildTransformSoA(placements, soa);
+    soa.scale.assign(scales.begin(), scales.end());
+
+    // Same shape as the scene: a chin fix as the base, a perspective view
+    glm::mat4 base = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.2f, 0.9f));
+    base = glm::rotate(base, glm::radians(90.0f), glm::vec3(1, 0, 0));
+    glm::mat4 viewProj = benchmarkViewProjection();
+
+    // glm reference: the three chained calls, then VP * M
+    std::vector<glm::mat4> refModels(count), refMvps(count);
+    double rate = measureThroughput(count, [&]()
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            glm::mat4 M = glm::translate(glm::mat4(1.0f), glm::vec3(placements[i]));
+            M = glm::rotate(M, placements[i].w, glm::vec3(0, 0, 1));
+            M = glm::scale(M, glm::vec3(scales[i]));
+            refModels[i] = M * base;
+            refMvps[i] = viewProj * refModels[i];
+        }
+    });
+
+    printf("Transforming %u objects (%s kernel available)\n", count, transformKernelName(bestTransformKernel()));
+    printf("  %-6s %8.1f M model+MVP/s\n", "glm", rate);
+
+    // Every third object through an index list, to cover the gather path
+    std::vector<unsigned int> subset;
+    for (unsigned int i = 0; i < count; i += 3)
+    {
+        subset.push_back(i);
+    }
+
+    const TransformKernel kernels[2] = { TRANSFORM_SCALAR, TRANSFORM_AVX2 };
+    const int kernelCount = bestTransformKernel() == TRANSFORM_AVX2 ? 2 : 1;
+    std::vector<glm::mat4> models(count), mvps(count);
+    bool agree = true;
+    for (int k = 0; k < kernelCount; k++)
+    {
+        for (int withMvp = 0; withMvp < 2; withMvp++)
+        {
+            rate = measureThroughput(count, [&]()
+            {
+                transformObjects(soa, NULL, count, base, viewProj, &models[0], withMvp ? &mvps[0] : NULL, kernels[k]);
+            });
+            printf("  %-6s %8.1f M %s/s\n", transformKernelName(kernels[k]), rate, withMvp ? "model+MVP" : "models");
+        }
+
+        // Float tolerance: the closed form, vectorized sin/cos and FMAs
+        // round differently from glm's chain but stay within a few ulps
+        float worst = 0.0f;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            worst = std::max(worst, std::max(matrixError(models[i], refModels[i]), matrixError(mvps[i], refMvps[i])));
+        }
+        if (!subset.empty())
+        {
+            std::vector<glm::mat4> subsetModels(subset.size()), subsetMvps(subset.size());
+            transformObjects(soa, &subset[0], (unsigned int)subset.size(), base, viewProj,
+                             &subsetModels[0], &subsetMvps[0], kernels[k]);
+            for (size_t i = 0; i < subset.size(); i++)
+            {
+                worst = std::max(worst, std::max(matrixError(subsetModels[i], refModels[subset[i]]),
+                                                 matrixError(subsetMvps[i], refMvps[subset[i]])));
+            }
+        }
+        bool ok = worst <= 1e-5f;
+        printf("  %-6s max relative error vs glm %.2e: %s\n", transformKernelName(kernels[k]), worst,
+               agreementText(ok));
+        agree = agree && ok;
+    }
+    return agree;
+}
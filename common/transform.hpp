@@ -0,0 +1,68 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Batched object transforms. Every head's model matrix has the same shape,
+* M = T(position) * Rz(yaw) * S(scale) * base, so instead of three chained
+* glm calls (and a separate VP * M) per object, the inputs are kept in
+* structure-of-arrays form and eight objects at a time are expanded
+* straight into model and, optionally, MVP matrices with AVX2/FMA
+* (vectorized sin/cos included). A scalar kernel over the same arrays is
+* the fallback and the reference for the equivalence check.
+*/
+
+#ifndef TRANSFORM_HPP
+#define TRANSFORM_HPP
+
+#include <vector>
+
+#include "alignedvector.hpp"
+
+enum TransformKernel
+{
+    TRANSFORM_SCALAR,
+    TRANSFORM_AVX2     // 8 objects per iteration
+};
+
+// Per-object transform inputs in structure-of-arrays form
+struct TransformSoA
+{
+    AlignedVector<float> x, y, z;  // position
+    AlignedVector<float> yaw;      // rotation about +z, radians
+    AlignedVector<float> scale;    // uniform scale
+    unsigned int count;
+};
+
+// Fill `soa` from placements (xyz = position, w = yaw) with scale 1
+void buildTransformSoA(const std::vector<glm::vec4>& placements, TransformSoA& soa);
+
+// Fastest kernel the CPU (and the build) supports
+TransformKernel bestTransformKernel();
+const char* transformKernelName(TransformKernel kernel);
+
+/*
+* transformObjects()
+* ------------------------------------------------------------------
+* Purpose: For i in [0, count), with object o = indices ? indices[i] : i,
+* write models[i] = T * Rz * S * base and, if `mvps` is not NULL,
+* mvps[i] = viewProj * models[i]. `models` may be NULL when only MVPs
+* are wanted.
+*/
+void transformObjects(const TransformSoA& objects, const unsigned int* indices, unsigned int count,
+                      const glm::mat4& base, const glm::mat4& viewProj,
+                      glm::mat4* models, glm::mat4* mvps,
+                      TransformKernel kernel = bestTransformKernel());
+
+/*
+* benchmarkTransforms()
+* ------------------------------------------------------------------
+* Purpose: Check every available kernel against glm (translate / rotate /
+* scale, then VP * M) on `count` random objects and print matrices per
+* second for each.
+* Returns: false if a kernel differs from glm beyond float tolerance.
+*/
+bool benchmarkTransforms(unsigned int count);
+
+#endif
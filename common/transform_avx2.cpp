@@ -0,0 +1,184 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* AVX2/FMA model/MVP transform kernel (see cpufeatures.hpp).
+*/
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "transform.hpp"
+
+#if defined(__AVX2__)
+
+bool transformAvx2Compiled()
+{
+    return true;
+}
+
+/*
+* sinCos8
+* ------------------------------------------------------------------
+* Purpose: sin and cos of eight angles. The angle is reduced to
+* r in [-pi/4, pi/4] with quadrant q = round(x * 2/pi) (pi/2 split in three
+* parts, Cody-Waite), both minimax polynomials are evaluated on r, and the
+* quadrant swaps them and picks the signs. Accurate to a few ulps for
+* |x| well beyond any yaw the scene uses.
+*/
+static inline void sinCos8(__m256 x, __m256* sinOut, __m256* cosOut)
+{
+    __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.636619772367581f)),
+                               _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(q, _mm256_set1_ps(1.5703125f), x);
+    r = _mm256_fnmadd_ps(q, _mm256_set1_ps(4.837512969970703125e-4f), r);
+    r = _mm256_fnmadd_ps(q, _mm256_set1_ps(7.54978995489188216e-8f), r);
+    __m256 r2 = _mm256_mul_ps(r, r);
+
+    __m256 s = _mm256_fmadd_ps(r2, _mm256_set1_ps(-1.9515295891e-4f), _mm256_set1_ps(8.3321608736e-3f));
+    s = _mm256_fmadd_ps(r2, s, _mm256_set1_ps(-1.6666654611e-1f));
+    s = _mm256_fmadd_ps(_mm256_mul_ps(r2, r), s, r);
+
+    __m256 c = _mm256_fmadd_ps(r2, _mm256_set1_ps(2.443315711809948e-5f), _mm256_set1_ps(-1.388731625493765e-3f));
+    c = _mm256_fmadd_ps(r2, c, _mm256_set1_ps(4.166664568298827e-2f));
+    c = _mm256_fmadd_ps(_mm256_mul_ps(r2, r2), c, _mm256_fnmadd_ps(r2, _mm256_set1_ps(0.5f), _mm256_set1_ps(1.0f)));
+
+    // Odd quadrants swap sin and cos; sin is negated in quadrants 2 and 3,
+    // cos in quadrants 1 and 2
+    __m256i quadrant = _mm256_cvtps_epi32(q);
+    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+        _mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+    __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+    __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+
+    *sinOut = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sinSign);
+    *cosOut = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cosSign);
+}
+
+/*
+* storeColumn8
+* ------------------------------------------------------------------
+* Purpose: Column `column` of eight matrices, given as one register per
+* row (lane l = matrix l), transposed and stored into out[0..7].
+*/
+static inline void storeColumn8(glm::mat4* out, int column, __m256 r0, __m256 r1, __m256 r2, __m256 r3)
+{
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1);   // x0 y0 x1 y1 | x4 y4 x5 y5
+    __m256 t1 = _mm256_unpackhi_ps(r0, r1);   // x2 y2 x3 y3 | x6 y6 x7 y7
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3);   // z0 w0 z1 w1 | ...
+    __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    __m256 c0 = _mm256_shuffle_ps(t0, t2, 0x44);  // matrices 0 | 4
+    __m256 c1 = _mm256_shuffle_ps(t0, t2, 0xEE);  // 1 | 5
+    __m256 c2 = _mm256_shuffle_ps(t1, t3, 0x44);  // 2 | 6
+    __m256 c3 = _mm256_shuffle_ps(t1, t3, 0xEE);  // 3 | 7
+    _mm_storeu_ps(&out[0][column][0], _mm256_castps256_ps128(c0));
+    _mm_storeu_ps(&out[1][column][0], _mm256_castps256_ps128(c1));
+    _mm_storeu_ps(&out[2][column][0], _mm256_castps256_ps128(c2));
+    _mm_storeu_ps(&out[3][column][0], _mm256_castps256_ps128(c3));
+    _mm_storeu_ps(&out[4][column][0], _mm256_extractf128_ps(c0, 1));
+    _mm_storeu_ps(&out[5][column][0], _mm256_extractf128_ps(c1, 1));
+    _mm_storeu_ps(&out[6][column][0], _mm256_extractf128_ps(c2, 1));
+    _mm_storeu_ps(&out[7][column][0], _mm256_extractf128_ps(c3, 1));
+}
+
+/*
+* transformObjectsAvx2
+* ------------------------------------------------------------------
+* Purpose: Eight objects per iteration. Inputs are loaded (or gathered
+* through `indices`) one register per field, sin/cos are vectorized, and
+* each base column expands to a model column with FMAs; the MVP column is
+* four more FMAs against the broadcast view-projection. Columns are
+* transposed back to per-matrix order on store.
+* Inputs: `count` is a multiple of 8.
+*/
+void transformObjectsAvx2(const TransformSoA& objects, const unsigned int* indices, unsigned int count,
+                          const glm::mat4& base, const glm::mat4& viewProj,
+                          glm::mat4* models, glm::mat4* mvps)
+{
+    const float* xs = &objects.x[0];
+    const float* ys = &objects.y[0];
+    const float* zs = &objects.z[0];
+    const float* yaws = &objects.yaw[0];
+    const float* scales = &objects.scale[0];
+
+    for (unsigned int i = 0; i < count; i += 8)
+    {
+        __m256 px, py, pz, yaw, k;
+        if (indices)
+        {
+            __m256i index = _mm256_loadu_si256((const __m256i*)(indices + i));
+            px = _mm256_i32gather_ps(xs, index, 4);
+            py = _mm256_i32gather_ps(ys, index, 4);
+            pz = _mm256_i32gather_ps(zs, index, 4);
+            yaw = _mm256_i32gather_ps(yaws, index, 4);
+            k = _mm256_i32gather_ps(scales, index, 4);
+        }
+        else
+        {
+            px = _mm256_loadu_ps(xs + i);
+            py = _mm256_loadu_ps(ys + i);
+            pz = _mm256_loadu_ps(zs + i);
+            yaw = _mm256_loadu_ps(yaws + i);
+            k = _mm256_loadu_ps(scales + i);
+        }
+
+        __m256 s, c;
+        sinCos8(yaw, &s, &c);
+        s = _mm256_mul_ps(s, k);
+        c = _mm256_mul_ps(c, k);
+
+        for (int j = 0; j < 4; j++)
+        {
+            __m256 bx = _mm256_set1_ps(base[j].x);
+            __m256 by = _mm256_set1_ps(base[j].y);
+            __m256 bz = _mm256_set1_ps(base[j].z);
+            __m256 bw = _mm256_set1_ps(base[j].w);
+
+            // Rz * S * b, then the translation scaled by b.w
+            __m256 mx = _mm256_fmadd_ps(px, bw, _mm256_fmsub_ps(c, bx, _mm256_mul_ps(s, by)));
+            __m256 my = _mm256_fmadd_ps(py, bw, _mm256_fmadd_ps(s, bx, _mm256_mul_ps(c, by)));
+            __m256 mz = _mm256_fmadd_ps(pz, bw, _mm256_mul_ps(k, bz));
+
+            if (models)
+            {
+                storeColumn8(models + i, j, mx, my, mz, bw);
+            }
+            if (mvps)
+            {
+                __m256 row[4];
+                for (int r = 0; r < 4; r++)
+                {
+                    __m256 v = _mm256_mul_ps(_mm256_set1_ps(viewProj[3][r]), bw);
+                    v = _mm256_fmadd_ps(_mm256_set1_ps(viewProj[2][r]), mz, v);
+                    v = _mm256_fmadd_ps(_mm256_set1_ps(viewProj[1][r]), my, v);
+                    row[r] = _mm256_fmadd_ps(_mm256_set1_ps(viewProj[0][r]), mx, v);
+                }
+                storeColumn8(mvps + i, j, row[0], row[1], row[2], row[3]);
+            }
+        }
+    }
+}
+
+#else
+
+bool transformAvx2Compiled()
+{
+    return false;
+}
+
+void transformObjectsAvx2(const TransformSoA&, const unsigned int*, unsigned int,
+                          const glm::mat4&, const glm::mat4&,
+                          glm::mat4*, glm::mat4*)
+{
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Transform hierarchy: node creation, dirty marking and the incremental
+* world-matrix update.
+*/
+
+#include <vector>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "transformhierarchy.hpp"
+
+const unsigned int TransformHierarchy::kNoParent;
+
+TransformHierarchy::TransformHierarchy()
+{
+}
+
+void TransformHierarchy::reserve(unsigned int nodes)
+{
+    m_local.reserve(nodes);
+    m_world.reserve(nodes);
+    m_parent.reserve(nodes);
+    m_firstChild.reserve(nodes);
+    m_nextSibling.reserve(nodes);
+    m_dirty.reserve(nodes);
+}
+
+unsigned int TransformHierarchy::createNode(unsigned int parent, const glm::mat4& local)
+{
+    unsigned int node = nodeCount();
+    m_local.push_back(local);
+    m_world.push_back(local);
+    m_parent.push_back(parent);
+    m_firstChild.push_back(kNoParent);
+    m_nextSibling.push_back(kNoParent);
+    m_dirty.push_back(1);
+    m_dirtyNodes.push_back(node);
+    if (parent != kNoParent)
+    {
+        m_nextSibling[node] = m_firstChild[parent];
+        m_firstChild[parent] = node;
+    }
+    return node;
+}
+
+void TransformHierarchy::setLocal(unsigned int node, const glm::mat4& local)
+{
+    m_local[node] = local;
+    if (!m_dirty[node])
+    {
+        m_dirty[node] = 1;
+        m_dirtyNodes.push_back(node);
+    }
+}
+
+/*
+* update
+* ------------------------------------------------------------------
+* Purpose: Walk the dirty nodes in index order (parents first) and
+* recompute each one's subtree depth first. A dirty node inside a subtree
+* already recomputed this pass has had its flag cleared and is skipped, so
+* every world matrix is computed at most once.
+*/
+unsigned int TransformHierarchy::update()
+{
+    std::sort(m_dirtyNodes.begin(), m_dirtyNodes.end());
+
+    unsigned int updated = 0;
+    for (size_t d = 0; d < m_dirtyNodes.size(); d++)
+    {
+        if (!m_dirty[m_dirtyNodes[d]])
+        {
+            continue;
+        }
+        m_stack.push_back(m_dirtyNodes[d]);
+        while (!m_stack.empty())
+        {
+            unsigned int node = m_stack.back();
+            m_stack.pop_back();
+            unsigned int parent = m_parent[node];
+            m_world[node] = parent == kNoParent ? m_local[node] : m_world[parent] * m_local[node];
+            m_dirty[node] = 0;
+            updated++;
+            for (unsigned int child = m_firstChild[node]; child != kNoParent; child = m_nextSibling[child])
+            {
+                m_stack.push_back(child);
+            }
+        }
+    }
+    m_dirtyNodes.clear();
+    return updated;
+}
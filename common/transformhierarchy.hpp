@@ -0,0 +1,70 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Transform hierarchy (scene graph) with cached world matrices. Each node
+* has a parent, a local matrix and a world matrix = world(parent) * local,
+* all kept in contiguous arrays indexed by node. Parents are always created
+* before their children, so node order is a valid update order.
+*
+* Changing a local matrix only marks the node dirty; update() recomputes
+* the world matrices of the dirty nodes and their descendants and nothing
+* else, so a frame in which nothing moved costs nothing, and the cost of a
+* frame grows with the number of changed subtrees rather than the number
+* of nodes.
+*/
+
+#ifndef TRANSFORMHIERARCHY_HPP
+#define TRANSFORMHIERARCHY_HPP
+
+#include <vector>
+
+class TransformHierarchy
+{
+public:
+    static const unsigned int kNoParent = ~0u;
+
+    TransformHierarchy();
+
+    void reserve(unsigned int nodes);
+
+    /*
+    * createNode()
+    * ------------------------------------------------------------------
+    * Purpose: Add a node under `parent` (kNoParent for a root). The node
+    * starts dirty, so its world matrix is valid after the next update().
+    * Returns: the node index; indices are handed out in order from 0.
+    */
+    unsigned int createNode(unsigned int parent, const glm::mat4& local);
+
+    // Replace a node's local matrix and mark it (and so its subtree) dirty
+    void setLocal(unsigned int node, const glm::mat4& local);
+
+    const glm::mat4& local(unsigned int node) const { return m_local[node]; }
+    const glm::mat4& world(unsigned int node) const { return m_world[node]; }
+    unsigned int parent(unsigned int node) const { return m_parent[node]; }
+    unsigned int nodeCount() const { return (unsigned int)m_local.size(); }
+
+    /*
+    * update()
+    * ------------------------------------------------------------------
+    * Purpose: Bring every world matrix up to date, visiting only dirty
+    * nodes and their descendants.
+    * Returns: the number of world matrices recomputed.
+    */
+    unsigned int update();
+
+private:
+    std::vector<glm::mat4>     m_local;
+    std::vector<glm::mat4>     m_world;
+    std::vector<unsigned int>  m_parent;
+    std::vector<unsigned int>  m_firstChild;   // kNoParent: none
+    std::vector<unsigned int>  m_nextSibling;  // kNoParent: last child
+    std::vector<unsigned char> m_dirty;
+    std::vector<unsigned int>  m_dirtyNodes;   // marked since the last update
+    std::vector<unsigned int>  m_stack;        // update() traversal scratch
+};
+
+#endif
@@ -0,0 +1,192 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the per-frame / per-object uniform buffer system.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "streambuffer.hpp"
+#include "uniformblocks.hpp"
+#include "glstate.hpp"
+
+// Both blocks come from one streaming ring: the per-frame block and this
+// frame's per-object blocks are sub-allocated from the frame's segment
+static StreamBuffer g_stream;
+
+static GLsizeiptr g_alignment      = 256;  // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+static GLsizeiptr g_objectStride   = 0;    // sizeof(PerObjectBlock) rounded to the offset alignment
+static unsigned int g_objectSlots  = 0;    // blocks allocated this frame
+
+static unsigned char* g_objects = NULL;    // this frame's blocks, already strided
+static GLintptr g_objectsOffset = 0;
+static unsigned int g_stagedCount = 0;
+static unsigned int g_demand = 0;          // most blocks any frame tried to stage
+static bool g_reportedOverflow = false;
+
+// Stream space for one frame with `objects` per-object blocks
+static GLsizeiptr frameBytes(unsigned int objects)
+{
+    GLsizeiptr frameBlock = ((GLsizeiptr)sizeof(PerFrameBlock) + g_alignment - 1) / g_alignment * g_alignment;
+    return frameBlock + g_objectStride * objects;
+}
+
+void initUniformBlocks(unsigned int maxObjects)
+{
+    GLint align = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    g_alignment = align;
+    g_objectStride = ((GLsizeiptr)sizeof(PerObjectBlock) + align - 1) / align * align;
+    g_stream.init(frameBytes(maxObjects > 0 ? maxObjects : 1));
+}
+
+void bindProgramUniformBlocks(GLuint programID)
+{
+    GLuint frameIndex  = glGetUniformBlockIndex(programID, "PerFrame");
+    GLuint objectIndex = glGetUniformBlockIndex(programID, "PerObject");
+    if (frameIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(programID, frameIndex, UBO_BINDING_PER_FRAME);
+    }
+    if (objectIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(programID, objectIndex, UBO_BINDING_PER_OBJECT);
+    }
+}
+
+void beginFrameUniforms(const PerFrameBlock& frame, unsigned int objectCount)
+{
+    // A frame that pushed more than it announced sizes the following ones
+    objectCount = std::max(objectCount, g_demand);
+    if (frameBytes(objectCount) > g_stream.segmentBytes())
+    {
+        g_stream.resize(frameBytes(objectCount + objectCount / 2));
+    }
+    g_stream.beginFrame();
+
+    // One write for everything that is constant across the frame's draws
+    StreamAllocation frameBlock = g_stream.allocate(sizeof(PerFrameBlock), g_alignment);
+    memcpy(frameBlock.data, &frame, sizeof(PerFrameBlock));
+    glsBindBufferRange(GL_UNIFORM_BUFFER, UBO_BINDING_PER_FRAME, g_stream.buffer(), frameBlock.offset,
+        sizeof(PerFrameBlock));
+
+    StreamAllocation objects = g_stream.allocate(g_objectStride * (objectCount > 0 ? objectCount : 1), g_alignment);
+    g_objects = (unsigned char*)objects.data;
+    g_objectsOffset = objects.offset;
+    g_objectSlots = objectCount;
+    g_stagedCount = 0;
+}
+
+/*
+* reserveObjectSlots
+* ------------------------------------------------------------------
+* Purpose: Make room for `slots` blocks this frame. Nothing is bound
+* before the flush, so the staged blocks can still move: they are copied
+* to a larger range of the current segment. Without room the request
+* fails; it is remembered so beginFrameUniforms() grows the ring.
+* Returns: false if the blocks do not fit this frame.
+*/
+static bool reserveObjectSlots(unsigned int slots)
+{
+    if (slots <= g_objectSlots)
+    {
+        return true;
+    }
+    g_demand = std::max(g_demand, slots);
+
+    unsigned int grown = std::max(slots, g_objectSlots * 2);
+    StreamAllocation objects = g_stream.allocate(g_objectStride * grown, g_alignment);
+    if (!objects.data)
+    {
+        grown = slots;
+        objects = g_stream.allocate(g_objectStride * grown, g_alignment);
+    }
+    if (!objects.data)
+    {
+        if (!g_reportedOverflow)
+        {
+            printf("Uniform blocks: %u objects this frame, room for %u; the rest are not drawn "
+                   "until the next frame grows the ring\n", slots, g_objectSlots);
+            g_reportedOverflow = true;
+        }
+        return false;
+    }
+    memcpy(objects.data, g_objects, size_t(g_objectStride) * g_stagedCount);
+    g_objects = (unsigned char*)objects.data;
+    g_objectsOffset = objects.offset;
+    g_objectSlots = grown;
+    return true;
+}
+
+unsigned int pushObjectUniforms(const PerObjectBlock& object)
+{
+    if (!reserveObjectSlots(g_stagedCount + 1))
+    {
+        return kNoObjectSlot;
+    }
+    memcpy(g_objects + size_t(g_objectStride) * g_stagedCount, &object, sizeof(PerObjectBlock));
+    return g_stagedCount++;
+}
+
+unsigned int pushObjectUniformBlocks(const PerObjectBlock* objects, unsigned int count)
+{
+    if (!reserveObjectSlots(g_stagedCount + count))
+    {
+        return kNoObjectSlot;
+    }
+    unsigned int first = g_stagedCount;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        memcpy(g_objects + size_t(g_objectStride) * (first + i), &objects[i], sizeof(PerObjectBlock));
+    }
+    g_stagedCount += count;
+    return first;
+}
+
+void flushObjectUniforms()
+{
+    // Persistent: the blocks were written in place. Otherwise one
+    // unsynchronized copy of the frame's range.
+    g_stream.flush();
+}
+
+bool bindObjectUniforms(unsigned int slot)
+{
+    if (slot >= g_stagedCount)
+    {
+        if (!g_reportedOverflow)
+        {
+            printf("Uniform blocks: draw uses block %u, only %u staged; skipped\n", slot, g_stagedCount);
+            g_reportedOverflow = true;
+        }
+        return false;
+    }
+    GLintptr offset = g_objectsOffset + g_objectStride * GLintptr(slot);
+    glsBindBufferRange(GL_UNIFORM_BUFFER, UBO_BINDING_PER_OBJECT, g_stream.buffer(), offset, sizeof(PerObjectBlock));
+    return true;
+}
+
+void endFrameUniforms()
+{
+    g_stream.endFrame();
+}
+
+const StreamStats& uniformStreamStats()
+{
+    return g_stream.stats();
+}
+
+void cleanupUniformBlocks()
+{
+    g_stream.destroy();
+}
@@ -0,0 +1,112 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Constant-buffer system for StandardShading. Values shared by every draw
+* (view, projection, light) live in one per-frame block written once per
+* frame. Per-object values (model matrix, tint) are written while the frame
+* is built, and each draw then selects its block with glBindBufferRange().
+* Both come out of a StreamBuffer ring (streambuffer.hpp), so the CPU never
+* overwrites a block the GPU may still be reading and no storage is
+* respecified per frame.
+*/
+
+#ifndef UNIFORMBLOCKS_HPP
+#define UNIFORMBLOCKS_HPP
+
+// Uniform-buffer binding points shared by the C++ side and the shaders
+enum
+{
+    UBO_BINDING_PER_FRAME  = 0,
+    UBO_BINDING_PER_OBJECT = 1
+};
+
+// CPU mirror of `PerFrame` (std140) in StandardShading.*shader
+struct PerFrameBlock
+{
+    glm::mat4 V;                         // world -> camera
+    glm::mat4 P;                         // camera -> clip
+    glm::vec4 LightPosition_worldspace;  // xyz used
+    glm::vec4 ShadowParams;              // xy: ShadowCache::depthParams(), z: depth bias, w: normal offset
+    glm::vec4 ClusterParams;             // LightClusters::shaderParams()
+    glm::uvec4 ClusterOffsets;           // LightClusters::shaderOffsets()
+};
+
+// CPU mirror of `PerObject` (std140) in StandardShading.*shader
+struct PerObjectBlock
+{
+    glm::mat4 M;     // model -> world
+    glm::vec4 Tint;  // rgb: flat color for the USE_TINT shader variant
+};
+
+/*
+* initUniformBlocks()
+* ------------------------------------------------------------------
+* Purpose: Create the per-frame UBO and the per-object ring UBO sized for
+* `maxObjects` blocks per frame (grown on demand by beginFrameUniforms).
+*/
+void initUniformBlocks(unsigned int maxObjects);
+
+/*
+* bindProgramUniformBlocks()
+* ------------------------------------------------------------------
+* Purpose: Point the program's `PerFrame`/`PerObject` blocks at the
+* binding points above (GLSL 330 has no layout(binding=...)).
+*/
+void bindProgramUniformBlocks(GLuint programID);
+
+/*
+* beginFrameUniforms()
+* ------------------------------------------------------------------
+* Purpose: Open the next ring segment, write and bind the per-frame block
+* and reserve `objectCount` per-object blocks. Waits on that segment's
+* fence if the GPU has not finished with it yet.
+*/
+void beginFrameUniforms(const PerFrameBlock& frame, unsigned int objectCount);
+
+// Returned by the push functions when the frame's segment has no room
+// left; binding it fails, so the draw is skipped rather than drawn with
+// another object's block
+static const unsigned int kNoObjectSlot = 0xFFFFFFFFu;
+
+/*
+* pushObjectUniforms()
+* ------------------------------------------------------------------
+* Purpose: Stage one per-object block for this frame. Pushing more blocks
+* than beginFrameUniforms() reserved moves the staged ones to a larger
+* range of the segment if it has room; if not, the push fails (reported
+* once) and the next frame reserves enough.
+* Returns: slot index to pass to bindObjectUniforms(), or kNoObjectSlot.
+*/
+unsigned int pushObjectUniforms(const PerObjectBlock& object);
+
+// Stage `count` blocks at once; returns the slot of the first one, or
+// kNoObjectSlot (nothing staged) under the same conditions
+unsigned int pushObjectUniformBlocks(const PerObjectBlock* objects, unsigned int count);
+
+/*
+* flushObjectUniforms()
+* ------------------------------------------------------------------
+* Purpose: Make the pushed blocks visible to GL (one unsynchronized copy
+* when the ring isn't persistently mapped). Call after the last push,
+* before drawing.
+*/
+void flushObjectUniforms();
+
+// Bind the block in `slot` to UBO_BINDING_PER_OBJECT for the next draw.
+// Returns false (binding nothing) for a slot that was never staged this
+// frame; the caller must skip the draw.
+bool bindObjectUniforms(unsigned int slot);
+
+// Fence the current segment; call once after the frame's last draw
+void endFrameUniforms();
+
+// Stalls and sizes of the uniform ring (include streambuffer.hpp to read them)
+struct StreamStats;
+const StreamStats& uniformStreamStats();
+
+void cleanupUniformBlocks();
+
+#endif
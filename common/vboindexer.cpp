@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 
 #include "vboindexer.hpp"
+#include "profiler.hpp"
 
 #include <string.h> // for memcmp
 
@@ -107,6 +108,7 @@ void indexVBO(
 	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals
 ){
+	PROFILE_SCOPE("indexVBO");
 	std::map<PackedVertex,unsigned short> VertexToOutIndex;
 
 	// For each input vertex
@@ -0,0 +1,130 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Implementation of the persistent worker pool.
+*/
+
+#include <stdio.h>
+#include <algorithm>
+
+#include "profiler.hpp"
+#include "workerpool.hpp"
+
+WorkerPool::WorkerPool()
+    : m_task(NULL), m_count(0), m_next(0), m_busy(0), m_generation(0), m_quit(false)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+}
+
+unsigned int WorkerPool::defaultThreadCount(unsigned int cap)
+{
+    unsigned int hw = std::thread::hardware_concurrency();
+    return std::min(cap, hw > 1 ? hw - 1 : 0u);
+}
+
+void WorkerPool::start(unsigned int threads)
+{
+    stop();
+    m_quit = false;
+    for (unsigned int t = 0; t < threads; t++)
+    {
+        m_threads.push_back(std::thread(&WorkerPool::workerMain, this, t + 1));
+    }
+}
+
+void WorkerPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (size_t t = 0; t < m_threads.size(); t++)
+    {
+        m_threads[t].join();
+    }
+    m_threads.clear();
+}
+
+void WorkerPool::runIndices(unsigned int worker)
+{
+    for (;;)
+    {
+        unsigned int i = m_next.fetch_add(1);
+        if (i >= m_count)
+        {
+            break;
+        }
+        (*m_task)(i, worker);
+    }
+}
+
+void WorkerPool::workerMain(unsigned int worker)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "worker %u", worker);
+    profilerSetThreadName(name);
+
+    unsigned long long seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_quit && m_generation == seen)
+            {
+                m_wake.wait(lock);
+            }
+            if (m_quit)
+            {
+                return;
+            }
+            seen = m_generation;
+        }
+
+        runIndices(worker);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busy == 0)
+        {
+            m_done.notify_one();
+        }
+    }
+}
+
+void WorkerPool::parallelFor(unsigned int count, const Task& task)
+{
+    if (m_threads.empty() || count <= 1)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            task(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_next = 0;
+        m_busy = (unsigned int)m_threads.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    runIndices(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_busy > 0)
+    {
+        m_done.wait(lock);
+    }
+    m_task = NULL;
+}
@@ -0,0 +1,64 @@
+/*
+* Author: Liam Long
+* Class: ECE4122 (Lab 3)
+* Last Date Modified: 2026-10-18
+*
+* Description / Purpose of this file:
+* Small persistent thread pool for data-parallel CPU work inside a frame
+* (occlusion binning/rasterization, culling). parallelFor() hands out task
+* indices through an atomic counter; the calling thread takes part and the
+* call returns once every index has run.
+*/
+
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+class WorkerPool
+{
+public:
+    // task(index, worker): worker is 0 for the caller, 1..n for pool threads
+    typedef std::function<void(unsigned int, unsigned int)> Task;
+
+    WorkerPool();
+    ~WorkerPool();
+
+    // Start `threads` pool threads in addition to the caller (0 = inline)
+    void start(unsigned int threads);
+    void stop();
+
+    // Threads that may run tasks, including the caller
+    unsigned int workerCount() const { return (unsigned int)m_threads.size() + 1; }
+
+    // Run task(i, worker) for every i in [0, count) and wait for all of them
+    void parallelFor(unsigned int count, const Task& task);
+
+    // hardware_concurrency() - 1, at least 0 and at most `cap`
+    static unsigned int defaultThreadCount(unsigned int cap);
+
+private:
+    WorkerPool(const WorkerPool&);
+    WorkerPool& operator=(const WorkerPool&);
+
+    void workerMain(unsigned int worker);
+    void runIndices(unsigned int worker);
+
+    std::vector<std::thread>  m_threads;
+    std::mutex                m_mutex;
+    std::condition_variable   m_wake;       // new generation or quit
+    std::condition_variable   m_done;       // last busy worker finished
+    const Task*               m_task;
+    unsigned int              m_count;
+    std::atomic<unsigned int> m_next;
+    unsigned int              m_busy;       // pool threads still in this generation
+    unsigned long long        m_generation;
+    bool                      m_quit;
+};
+
+#endif
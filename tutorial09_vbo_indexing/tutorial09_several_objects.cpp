@@ -1,22 +1,42 @@
 /*
 * Author: Liam Long
 * Class: ECE4122 (Lab 3)
-* Last Date Modified: 2025-10-18
+* Last Date Modified: 2026-10-18
 *
 * Description / Purpose of this file:
 * OpenGL/GLFW application that renders a textured floor quad and eight
-* indexed “Suzanne” monkey heads arranged uniformly on a ring. The heads are
+* (or --heads N) indexed “Suzanne” monkey heads arranged uniformly on a
+* ring, either one draw per head, all at once with --instanced, or GPU-driven
+* with --gpu-driven (compute-shader frustum culling and LOD selection feeding
+* one multi-draw indirect call). On the CPU paths heads outside the view
+* frustum are culled (SIMD sphere tests) before submission, and --occlusion
+* also rejects heads hidden behind the nearest ones using a small software
+* depth buffer. Draws are recorded as packets with 64-bit sort keys into a
+* render queue that is radix sorted and submitted with redundant state
+* skipped. The floor and heads are entities in an archetype store (SoA
+* component columns walked in chunks by the frame preparation workers),
+* and their model matrices are cached in a transform hierarchy and only
+* recomputed for heads that move (--animate N spins some of them). On the
+* per-head path each visible head also gets a LOD by distance. The heads are
 * rotated/uprighted so the chins sit on the z = 0 plane, and each head faces
 * radially outward. Camera/view/projection are driven by the provided
 * controls helper. The program demonstrates VBO/IBO usage, VAO setup, basic
 * lighting uniforms, texturing, polygon offset to avoid z‑fighting, and
-* back‑face culling control.
+* back‑face culling control. Per-frame constants (V, P, light, toggles) and
+* per-object constants (M, tint) live in uniform buffer objects; the vertex
+* shader forms P * V * M itself. Shading features are compile-time shader
+* permutations selected per draw, and loose uniforms go through the
+* ShaderProgram wrapper, which caches locations at link time and skips
+* redundant uploads.
 */
 
 // Include standard headers
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <string>
 #include <vector>
+#include <algorithm>
 #include <limits>               // for std::numeric_limits
 #include <glm/gtc/constants.hpp> // for glm::half_pi<float>()
 #include <cmath>
@@ -34,10 +54,58 @@ GLFWwindow* window;
 using namespace glm;
 
 #include <common/shader.hpp>
+#include <common/shaderprogram.hpp>
+#include <common/shadervariants.hpp>
+#include <common/streambuffer.hpp>
+#include <common/uniformblocks.hpp>
 #include <common/texture.hpp>
+#include <common/text2D.hpp>
 #include <common/controls.hpp>
 #include <common/objloader.hpp>
 #include <common/vboindexer.hpp>
+#include <common/scenegen.hpp>
+#include <common/framecapture.hpp>
+#include <common/options.hpp>
+#include <common/rendertarget.hpp>
+#include <common/dynamicresolution.hpp>
+#include <common/benchmark.hpp>
+#include <common/meshlod.hpp>
+#include <common/gpudriven.hpp>
+#include <common/frustum.hpp>
+#include <common/shadowcache.hpp>
+#include <common/occlusion.hpp>
+#include <common/lightclusters.hpp>
+#include <common/renderqueue.hpp>
+#include <common/glstate.hpp>
+#include <common/frameprep.hpp>
+#include <common/transform.hpp>
+#include <common/transformhierarchy.hpp>
+#include <common/entitystore.hpp>
+#include <common/profiler.hpp>
+#include <common/headless.hpp>
+#include <common/clock.hpp>
+
+/*
+* onShadingVariantLinked()
+* ------------------------------------------------------------------
+* Purpose:
+* Link-time setup shared by every StandardShading permutation: attach the
+* PerFrame/PerObject blocks to their binding points and point the sampler
+* at texture unit 0. Nothing per-variant has to be set during the frame.
+*
+* Inputs:
+* program - the freshly linked variant.
+*/
+static void onShadingVariantLinked(ShaderProgram& program)
+{
+	bindProgramUniformBlocks(program.id());
+	program.use();
+	program.setInt(program.uniform("myTextureSampler"), 0);
+	program.setInt(program.uniform("ShadowMap"), 1); // SHADOWS variants only
+	program.setInt(program.uniform("ClusterGrid"), 2); // CLUSTERED_LIGHTS variants only
+	program.setInt(program.uniform("ClusterLightIndices"), 3);
+	program.setInt(program.uniform("ClusterLightData"), 4);
+}
 
 /*
 * main()
@@ -48,54 +116,151 @@ using namespace glm;
 * exits (ESC or window close).
 *
 * Inputs:
-* (none)
+* argc/argv - scene, instancing and benchmark options (see printUsage in
+* common/options.cpp). With --benchmark N the scene is rendered N frames
+* into an offscreen target along a scripted camera path and a frame-time
+* report is written instead of running interactively. --headless does the
+* same through an EGL context, without a window or display server.
 *
 * Outputs / Return:
 * int process exit code (0 on success; negative on initialization failure).
 */
-int main()
+int main(int argc, char* argv[])
 {
-	// Initialize GLFW
-	if( !glfwInit() )
+	// Command line / config file
+	AppOptions options;
+	setDefaultOptions(options);
+	if (!parseCommandLine(argc, argv, options))
 	{
-		fprintf( stderr, "Failed to initialize GLFW\n" );
-		getchar();
 		return -1;
 	}
+	profilerInit(!options.tracePath.empty());
+	profilerSetThreadName("main");
+
+	// Headless runs are benchmark runs with no window system at all
+	const bool headless = options.headless;
+	if (headless && options.benchmarkFrames == 0)
+	{
+		options.benchmarkFrames = 300;
+	}
+	bool gpuDriven = options.gpuDriven;
+	bool instanced = options.instanced && !gpuDriven;
+	const bool benchmark = options.benchmarkFrames > 0;
+	const unsigned int numHeads = options.scene.count;
+	bool dynamicResolution = options.frameBudgetMs > 0.0f;
+
+	// Rendering on demand waits for input, so benchmark runs (scripted,
+	// possibly headless) draw every frame regardless
+	const bool onDemand = options.onDemand && !benchmark;
 
-	glfwWindowHint(GLFW_SAMPLES, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // To make macOS happy; should not be needed
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	// Multisampling of the window, or of the dynamic resolution target
+	// that takes its place (benchmark targets are single-sampled)
+	const int windowSamples = 4;
 
-	// Open a window and create its OpenGL context
-	window = glfwCreateWindow( 1024, 768, "ECE 4122 - Lab 3", NULL, NULL);
-	if( window == NULL ){
-		fprintf( stderr, "Failed to open GLFW window. If you have an Intel GPU, they are not 3.3 compatible. Try the 2.1 version of the tutorials.\n" );
+	// Initialize GLFW (headless: not needed, and impossible without a display)
+	if( !headless && !glfwInit() )
+	{
+		fprintf( stderr, "Failed to initialize GLFW\n" );
 		getchar();
-		glfwTerminate();
 		return -1;
 	}
-	glfwMakeContextCurrent(window);
+
+	// Kernel benchmark only: no window needed
+	if (options.cullBenchmarkSpheres > 0)
+	{
+		bool agree = benchmarkSphereCulling(options.cullBenchmarkSpheres);
+		glfwTerminate();
+		return agree ? 0 : 1;
+	}
+	if (options.transformBenchmarkObjects > 0)
+	{
+		bool agree = benchmarkTransforms(options.transformBenchmarkObjects);
+		glfwTerminate();
+		return agree ? 0 : 1;
+	}
+
+	window = NULL;
+	if (headless)
+	{
+		// EGL context; frames go to the offscreen target created below
+		if (!createHeadlessContext())
+		{
+			return -1;
+		}
+	}
+	else
+	{
+		glfwWindowHint(GLFW_SAMPLES, dynamicResolution ? 0 : windowSamples);
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // To make macOS happy; should not be needed
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		if (benchmark)
+		{
+			glfwWindowHint(GLFW_VISIBLE, GL_FALSE); // frames go to an offscreen target
+		}
+
+		// Open a window and create its OpenGL context. Prefer a 4.5 context
+		// (persistent buffer mapping and newer paths), fall back to 3.3.
+		const int contextVersions[2][2] = { {4, 5}, {3, 3} };
+		for (int v = 0; v < 2 && window == NULL; v++)
+		{
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, contextVersions[v][0]);
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, contextVersions[v][1]);
+			window = glfwCreateWindow( options.width, options.height, "ECE 4122 - Lab 3", NULL, NULL);
+		}
+		if( window == NULL ){
+			fprintf( stderr, "Failed to open GLFW window. If you have an Intel GPU, they are not 3.3 compatible. Try the 2.1 version of the tutorials.\n" );
+			getchar();
+			glfwTerminate();
+			return -1;
+		}
+		glfwMakeContextCurrent(window);
+	}
     
-	// Initialize GLEW
+	// Initialize GLEW. Its GLX extension query fails without an X display
+	// even though the GL entry points were loaded, so headless runs only
+	// require the functions themselves.
 	glewExperimental = true; // Needed for core profile
-	if (glewInit() != GLEW_OK) {
+	GLenum glewStatus = glewInit();
+	if (glewStatus != GLEW_OK && !(headless && glCreateShader != NULL && glGenFramebuffers != NULL)) {
 		fprintf(stderr, "Failed to initialize GLEW\n");
-		getchar();
+		if (!headless)
+		{
+			getchar();
+		}
+		destroyHeadlessContext();
 		glfwTerminate();
 		return -1;
 	}
+	profilerInitGpu();
 
-	// Ensure we can capture the escape key being pressed below
-	glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
-    // Hide the mouse and enable unlimited movement
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-    
-    // Set the mouse at the center of the screen
-    glfwPollEvents();
-    glfwSetCursorPos(window, 1024/2, 768/2);
+	// The GPU-driven path needs compute shaders and multi-draw indirect
+	if (gpuDriven && !gpuDrivenSupported())
+	{
+		printf("GL 4.3 compute / multi-draw indirect not available, using --instanced\n");
+		gpuDriven = false;
+		instanced = true;
+	}
+	// Both batched paths share one per-object block and the INSTANCED shader
+	const bool batched = instanced || gpuDriven;
+	printf("Rendering %u heads, %s layout (%s)\n", numHeads, sceneLayoutName(options.scene.layout),
+		gpuDriven ? "GPU-driven" : instanced ? "instanced" : "one draw per head");
+
+	if (!headless)
+	{
+		// Ensure we can capture the escape key being pressed below
+		glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
+		// Hide the mouse and enable unlimited movement
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+		// Set the mouse at the center of the screen
+		glfwPollEvents();
+		glfwSetCursorPos(window, options.width/2, options.height/2);
+
+		// Key and refresh events: what the on-demand loop sleeps on, and
+		// the start of the input-to-present latency in either mode
+		trackInputEvents();
+	}
+    setAspectRatio(float(options.width) / float(options.height));
 
 	// Dark blue background
 	glClearColor(0.0f, 0.0f, 0.4f, 0.0f);
@@ -112,19 +277,35 @@ int main()
 	glGenVertexArrays(1, &VertexArrayID);
 	glBindVertexArray(VertexArrayID);
 
-	// Create and compile our GLSL program from the shaders
-	GLuint programID = LoadShaders( "StandardShading.vertexshader", "StandardShading.fragmentshader" );
+	// Per-frame UBO + ring of per-object blocks (floor + one per head, or
+	// floor + one shared block for the instanced / GPU-driven batch)
+	const unsigned int objectBlocks = batched ? 2 : numHeads + 1;
+	initUniformBlocks(objectBlocks);
+
+	// Create and compile our GLSL programs from the shaders. Each feature
+	// (tint, diffuse+specular, instancing) is a compile-time permutation
+	// selected by bitmask at draw time; the ones the scene uses are built
+	// up front.
+	ShaderVariantCache shading;
+	shading.init( "StandardShading.vertexshader", "StandardShading.fragmentshader",
+		kStandardShadingDefines, SHADING_FEATURE_COUNT, onShadingVariantLinked );
+	const unsigned int litBits = SHADING_DIFFUSE_SPECULAR | (options.shadows ? SHADING_SHADOWS : 0) |
+		(options.pointLights > 0 ? SHADING_CLUSTERED_LIGHTS : 0);
+	const unsigned int startupVariants[] = { 0, litBits, SHADING_INSTANCED, SHADING_INSTANCED | litBits };
+	shading.precompile(startupVariants, batched ? 4 : 2);
 
-	// Get a handle for our "MVP" uniform
-	GLuint MatrixID = glGetUniformLocation(programID, "MVP");
-	GLuint ViewMatrixID = glGetUniformLocation(programID, "V");
-	GLuint ModelMatrixID = glGetUniformLocation(programID, "M");
+	// Depth pre-pass: the same vertex transform without any fragment work
+	ShaderVariantCache depthOnly;
+	if (options.depthPrepass)
+	{
+		depthOnly.init( "DepthPrepass.vertexshader", "ShadowDepth.fragmentshader",
+			kStandardShadingDefines, SHADING_FEATURE_COUNT, onShadingVariantLinked );
+		const unsigned int depthVariants[] = { 0, SHADING_INSTANCED };
+		depthOnly.precompile(depthVariants, batched ? 2 : 1);
+	}
 
 	// Load the texture
 	GLuint Texture = loadDDS("uvmap.DDS");
-	
-	// Get a handle for our "myTextureSampler" uniform
-	GLuint TextureID  = glGetUniformLocation(programID, "myTextureSampler");
 
 	// Read our .obj file
 	std::vector<glm::vec3> vertices;
@@ -151,6 +332,41 @@ int main()
     // add to model z to place chin on the floor
     float liftToGround = -minZ;
 
+	// Scene placement never changes: compute it once
+	std::vector<glm::vec4> headPlacements;
+	float sceneRadius = generateScene(options.scene, liftToGround, headPlacements);
+	setSceneRadius(sceneRadius);
+
+	// World-space bounding sphere per head for frustum culling: the mesh
+	// sphere (after the chin fix) yawed and moved to each placement
+	glm::vec4 headLocalSphere = computeBoundingSphere(indexed_vertices, Rfix);
+	std::vector<glm::vec4> headSpheres(numHeads);
+	for (unsigned int i = 0; i < numHeads; i++)
+	{
+		float c = cosf(headPlacements[i].w), s = sinf(headPlacements[i].w);
+		glm::vec3 offset(c * headLocalSphere.x - s * headLocalSphere.y,
+			s * headLocalSphere.x + c * headLocalSphere.y, headLocalSphere.z);
+		headSpheres[i] = glm::vec4(glm::vec3(headPlacements[i]) + offset, headLocalSphere.w);
+	}
+
+	// Spinning heads (not on the GPU-driven path, whose placements live on
+	// the GPU): their spheres grow to cover every yaw
+	const unsigned int animatedHeads = gpuDriven ? 0 : std::min(options.animatedHeads, numHeads);
+	const float spinReach = glm::length(glm::vec2(headLocalSphere.x, headLocalSphere.y));
+	for (unsigned int i = 0; i < animatedHeads; i++)
+	{
+		headSpheres[i] = glm::vec4(headPlacements[i].x, headPlacements[i].y,
+			headPlacements[i].z + headLocalSphere.z, headLocalSphere.w + spinReach);
+	}
+
+	// Heads submitted this frame (culled by the frame preparation stage)
+	const bool cpuCulling = !gpuDriven && !options.disableCulling;
+	unsigned int visibleHeads = numHeads;
+	if (cpuCulling)
+	{
+		printf("Frustum culling with the %s kernel\n", cullKernelName(bestCullKernel()));
+	}
+
 	// Load it into a VBO
 
 	GLuint vertexbuffer;
@@ -168,16 +384,157 @@ int main()
 	glBindBuffer(GL_ARRAY_BUFFER, normalbuffer);
 	glBufferData(GL_ARRAY_BUFFER, indexed_normals.size() * sizeof(glm::vec3), &indexed_normals[0], GL_STATIC_DRAW);
 
+	// Coarser LODs by vertex clustering, appended after the full mesh in
+	// the same element buffer (LOD 0 stays at offset 0, which is all the
+	// instanced path draws)
+	std::vector<MeshLod> headLods;
+	std::vector<unsigned short> lodIndices;
+	const unsigned int lodGrids[] = { 24, 12 };
+	buildMeshLods(indices, indexed_vertices, lodGrids, 2, lodIndices, headLods);
+	const std::vector<unsigned short>& elementIndices = lodIndices;
+
 	// Generate a buffer for the indices as well
 	GLuint elementbuffer;
 	glGenBuffers(1, &elementbuffer);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementbuffer);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0] , GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, elementIndices.size() * sizeof(unsigned short), &elementIndices[0] , GL_STATIC_DRAW);
+
+	// Object records, culling shader and indirect commands; the bounding
+	// sphere is taken in the placed frame before the per-head yaw
+	if (gpuDriven && !initGpuDriven("CullLod.computeshader", headPlacements,
+		headLocalSphere, headLods,
+		vertexbuffer, uvbuffer, normalbuffer, elementbuffer))
+	{
+		printf("Culling shader unavailable, using --instanced\n");
+		gpuDriven = false;
+		instanced = true;
+	}
+	const bool verifyCulling = gpuDriven && options.verifyCulling;
+	CullResult gpuCull, cpuCull;
+	unsigned int cullChecks = 0, cullMismatches = 0, cullBorderline = 0;
+
+	// One draw per head: the mesh attributes and indices live in a VAO
+	// built once instead of being re-specified for every draw
+	GLuint headVAO;
+	glGenVertexArrays(1, &headVAO);
+	glBindVertexArray(headVAO);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	glEnableVertexAttribArray(1);
+	glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	glEnableVertexAttribArray(2);
+	glBindBuffer(GL_ARRAY_BUFFER, normalbuffer);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementbuffer);
+	glBindVertexArray(0);
+
+	// Depth pre-pass stream: positions only, so the pre-pass fetches a
+	// third of the vertex data
+	GLuint headDepthVAO;
+	glGenVertexArrays(1, &headDepthVAO);
+	glBindVertexArray(headDepthVAO);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementbuffer);
+	glBindVertexArray(0);
+
+	// Instanced path: per-instance position+yaw data (16 bytes per head)
+	// and a VAO that carries the mesh attributes plus the instance stream.
+	// When culling or spin rewrite the data every frame it comes from a
+	// streaming ring instead of a static buffer.
+	GLuint instancebuffer = 0;
+	GLuint headInstancedVAO = 0, headInstancedDepthVAO = 0;
+	const bool streamedInstances = instanced && (cpuCulling || options.occlusion || animatedHeads > 0);
+	StreamBuffer instanceStream;
+	if (instanced)
+	{
+		if (streamedInstances)
+		{
+			instanceStream.init(GLsizeiptr(std::max<size_t>(headPlacements.size(), 1) * sizeof(glm::vec4)));
+		}
+		else
+		{
+			glGenBuffers(1, &instancebuffer);
+			glBindBuffer(GL_ARRAY_BUFFER, instancebuffer);
+			glBufferData(GL_ARRAY_BUFFER, headPlacements.size() * sizeof(glm::vec4), &headPlacements[0],
+				GL_STATIC_DRAW);
+		}
+
+		glGenVertexArrays(1, &headInstancedVAO);
+		glBindVertexArray(headInstancedVAO);
+		glEnableVertexAttribArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+		glEnableVertexAttribArray(1);
+		glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+		glEnableVertexAttribArray(2);
+		glBindBuffer(GL_ARRAY_BUFFER, normalbuffer);
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+		glEnableVertexAttribArray(3);
+		glBindBuffer(GL_ARRAY_BUFFER, streamedInstances ? instanceStream.buffer() : instancebuffer);
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, (void*)0); // re-pointed per frame when streamed
+		glVertexAttribDivisor(3, 1); // advance once per head, not per vertex
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementbuffer);
+		glBindVertexArray(0);
+
+		// Its pre-pass twin: positions and the same instance stream
+		glGenVertexArrays(1, &headInstancedDepthVAO);
+		glBindVertexArray(headInstancedDepthVAO);
+		glEnableVertexAttribArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+		glEnableVertexAttribArray(3);
+		glBindBuffer(GL_ARRAY_BUFFER, streamedInstances ? instanceStream.buffer() : instancebuffer);
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+		glVertexAttribDivisor(3, 1);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementbuffer);
+		glBindVertexArray(0);
+	}
+
+	// Shadows of the heads from the point light. The map is rendered once;
+	// afterwards only the regions around spinning heads are redrawn (their
+	// spheres already cover every yaw). The floor only receives.
+	const glm::vec3 lightPosition(4, 4, 4);
+	ShadowCache shadows;
+	bool shadowsEnabled = options.shadows;
+	std::vector<glm::vec4> casterPlacements;
+	unsigned int shadowFaces = 0; // face regions re-rendered for the last frame
+	if (shadowsEnabled)
+	{
+		ShadowCasterMesh casterMesh;
+		casterMesh.positionBuffer = vertexbuffer;
+		casterMesh.elementBuffer = elementbuffer;
+		casterMesh.indexCount = (GLsizei)indices.size(); // LOD 0
+		casterMesh.indexType = GL_UNSIGNED_SHORT;
+		casterMesh.base = Rfix;
+		float shadowFar = glm::length(lightPosition) + sceneRadius + 2.0f * headLocalSphere.w;
+		shadowsEnabled = shadows.init(options.shadowSize, 0.05f, shadowFar,
+			"ShadowDepth.vertexshader", "ShadowDepth.fragmentshader", casterMesh, headSpheres);
+		if (!shadowsEnabled)
+		{
+			printf("Shadow map unavailable, rendering without shadows\n");
+		}
+		casterPlacements = headPlacements;
+	}
+
+	// Point lights scattered around the scene on top of the main light,
+	// each fragment shading only those listed for its froxel cluster
+	LightClusters lightClusters;
+	bool clusteredLights = options.pointLights > 0;
+	if (clusteredLights)
+	{
+		std::vector<PointLight> pointLights;
+		generateRingLights(options.pointLights, sceneRadius, pointLights);
+		clusteredLights = lightClusters.init(pointLights, WorkerPool::defaultThreadCount(7),
+			options.gpuLightAssignment ? "ClusterLights.computeshader" : NULL);
+		printf("%u point lights in %u clusters, assigned by the %s\n", options.pointLights,
+			LightClusters::kClusterCount, lightClusters.kernelName());
+	}
 
-	// Get a handle for our "LightPosition" uniform
-	glUseProgram(programID);
-	GLuint LightID = glGetUniformLocation(programID, "LightPosition_worldspace");
-	
 	// Geometry (two triangles) centered at origin on z = 0
     float s = 4.5f; // Length of 1 side of rectangle
     
@@ -242,159 +599,871 @@ int main()
     
     glBindVertexArray(0);
 
+    // Positions only, for the depth pre-pass
+    GLuint floorDepthVAO;
+    glGenVertexArrays(1, &floorDepthVAO);
+    glBindVertexArray(floorDepthVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, floorVBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, floorEBO);
+    glBindVertexArray(0);
+
+	// One worker pool for the frame preparation and the occlusion culler it
+	// drives (they never run at the same time)
+	WorkerPool prepWorkers;
+	prepWorkers.start(options.prepThreads >= 0 ? (unsigned int)options.prepThreads :
+		WorkerPool::defaultThreadCount(7));
+
+	// CPU occlusion: occluders are the floor and a coarse Suzanne proxy,
+	// shrunk toward the mesh center so it stays inside the real silhouette
+	const bool occlusionCulling = options.occlusion && !gpuDriven;
+	OcclusionCuller occlusion;
+	unsigned int floorOccluder = 0, headOccluder = 0;
+	if (occlusionCulling)
+	{
+		occlusion.init(float(options.width) / float(options.height), prepWorkers);
+		floorOccluder = occlusion.addOccluderMesh(std::vector<glm::vec3>(floorPos, floorPos + 4),
+			std::vector<unsigned short>(floorIdx, floorIdx + 6), true);
+
+		const unsigned int proxyGrid[] = { 8 };
+		std::vector<unsigned short> proxyLodIndices;
+		std::vector<MeshLod> proxyLods;
+		buildMeshLods(indices, indexed_vertices, proxyGrid, 1, proxyLodIndices, proxyLods);
+		glm::vec3 meshCenter = glm::vec3(computeBoundingSphere(indexed_vertices, glm::mat4(1.0f)));
+		std::vector<glm::vec3> proxyPositions(indexed_vertices.size());
+		for (size_t v = 0; v < indexed_vertices.size(); v++)
+		{
+			proxyPositions[v] = meshCenter + 0.9f * (indexed_vertices[v] - meshCenter);
+		}
+		headOccluder = occlusion.addOccluderMesh(proxyPositions,
+			std::vector<unsigned short>(proxyLodIndices.begin() + proxyLods[1].firstIndex,
+				proxyLodIndices.begin() + proxyLods[1].firstIndex + proxyLods[1].indexCount), false);
+	}
+
+	// Scene objects: the floor and the heads are entities whose transform
+	// points at a node of the transform hierarchy and whose mesh and
+	// material handles index the tables below. Head nodes hang under a
+	// shared root and are built with the batched kernel; after the first
+	// update only moved heads are recomputed.
+	enum { MESH_FLOOR, MESH_HEAD };
+	enum { MATERIAL_FLOOR, MATERIAL_HEAD, MATERIAL_COUNT };
+	std::vector<SceneMesh> sceneMeshes(2);
+	sceneMeshes[MESH_FLOOR].vao = floorVAO;
+	sceneMeshes[MESH_FLOOR].depthVao = floorDepthVAO;
+	sceneMeshes[MESH_FLOOR].indexType = GL_UNSIGNED_SHORT;
+	MeshLod floorRange = { 0, 6 };
+	sceneMeshes[MESH_FLOOR].lods.push_back(floorRange);
+	sceneMeshes[MESH_HEAD].vao = headVAO;
+	sceneMeshes[MESH_HEAD].depthVao = headDepthVAO;
+	sceneMeshes[MESH_HEAD].indexType = GL_UNSIGNED_SHORT;
+	sceneMeshes[MESH_HEAD].lods = headLods;
+
+	TransformHierarchy sceneGraph;
+	sceneGraph.reserve(numHeads + 2);
+	EntityStore entities;
+	const unsigned int headComponents = COMPONENT_TRANSFORM | COMPONENT_BOUNDS | COMPONENT_MESH |
+		COMPONENT_MATERIAL | COMPONENT_LOD;
+	entities.reserve(headComponents, numHeads);
+
+	EntityDesc floorEntity = {};
+	floorEntity.components = COMPONENT_TRANSFORM | COMPONENT_MESH | COMPONENT_MATERIAL;
+	floorEntity.scale = 1.0f;
+	floorEntity.node = sceneGraph.createNode(TransformHierarchy::kNoParent, glm::mat4(1.0f)); // stays on z = 0
+	floorEntity.mesh = MESH_FLOOR;
+	floorEntity.material = MATERIAL_FLOOR;
+	entities.create(floorEntity);
+
+	const unsigned int headsRoot = sceneGraph.createNode(TransformHierarchy::kNoParent, glm::mat4(1.0f));
+	{
+		TransformSoA headTransforms;
+		buildTransformSoA(headPlacements, headTransforms);
+		std::vector<glm::mat4> headLocals(numHeads);
+		transformObjects(headTransforms, NULL, numHeads, Rfix, glm::mat4(1.0f), &headLocals[0], NULL);
+		EntityDesc head = {};
+		head.components = headComponents;
+		head.scale = 1.0f;
+		head.mesh = MESH_HEAD;
+		head.material = MATERIAL_HEAD;
+		for (unsigned int i = 0; i < numHeads; i++)
+		{
+			head.placement = headPlacements[i];
+			head.sphere = headSpheres[i];
+			head.node = sceneGraph.createNode(headsRoot, headLocals[i]);
+			entities.create(head);
+		}
+	}
+	if (animatedHeads > 0)
+	{
+		printf("Spinning %u of %u heads\n", animatedHeads, numHeads);
+	}
+
+	// Culling, LOD selection, transforms and draw packets are built by
+	// worker threads; by default one frame ahead of the one being submitted
+	FramePrepScene prepScene;
+	prepScene.entities = &entities;
+	prepScene.meshes = &sceneMeshes;
+	prepScene.meshFix = Rfix;
+	prepScene.hierarchy = &sceneGraph;
+	prepScene.spinning = entities.findArchetype(headComponents);
+	prepScene.spinningCount = animatedHeads;
+	prepScene.submission = gpuDriven ? HEADS_GPU_DRIVEN : instanced ? HEADS_INSTANCED : HEADS_PER_OBJECT;
+	prepScene.frustumCulling = cpuCulling;
+	prepScene.occlusion = occlusionCulling ? &occlusion : NULL;
+	prepScene.floorOccluder = floorOccluder;
+	prepScene.headOccluder = headOccluder;
+	prepScene.occluderCount = options.occluderCount;
+	prepScene.depthPrepass = options.depthPrepass;
+	FramePrep framePrep;
+	// On demand, the frame drawn after an input must be prepared from it:
+	// overlap would show the camera sampled one frame earlier
+	framePrep.init(prepScene, prepWorkers, !options.noOverlap && !onDemand);
+	printf("Frame preparation on %u threads%s\n", framePrep.workerCount(),
+		framePrep.overlapped() ? ", overlapped with submission" : "");
+	if (onDemand)
+	{
+		printf("Rendering on demand: %s\n", animatedHeads > 0 ?
+			"spinning heads keep every frame drawn" : "sleeping until input or window events");
+	}
+	else if (options.onDemand)
+	{
+		printf("--on-demand ignored: benchmark runs draw every frame\n");
+	}
+	unsigned int occludedHeads = 0;
+	unsigned int occludedTriangles = 0;  // at the LOD each occluded head would have drawn
+
+	// Optional HUD: needs the 16x16 glyph atlas Holstein.DDS from the
+	// opengl-tutorial text tutorial (tutorial11_2d_fonts). It is not part of
+	// this repository; copy it next to the shaders in tutorial09_vbo_indexing/
+	// (the working directory) to get the on-screen counters.
+	FILE* fontFile = fopen("Holstein.DDS", "rb");
+	bool hudEnabled = fontFile != NULL;
+	if (fontFile)
+	{
+		fclose(fontFile);
+		initText2D("Holstein.DDS");
+	}
+	else
+	{
+		printf("HUD disabled: Holstein.DDS not found in the working directory\n"
+		       "  (copy it from opengl-tutorial's tutorial11_2d_fonts folder)\n");
+	}
+
+	// Benchmark mode: fixed frame count, scripted camera, offscreen target,
+	// no vsync, and a frame-time report at the end
+	RenderTarget offscreen = { 0, 0, 0, 0, 0 };
+	FrameBenchmark frameBench;
+	if (benchmark)
+	{
+		if (!createRenderTarget(offscreen, options.width, options.height))
+		{
+			destroyHeadlessContext();
+			glfwTerminate();
+			return -1;
+		}
+		if (!headless)
+		{
+			glfwSwapInterval(0);
+		}
+	}
+
+	// Dynamic resolution: the scene is drawn into a scaled target sized
+	// from the GPU time of recent frames, then upscaled into the frame
+	DynamicResolution dynamicRes;
+	if (dynamicResolution)
+	{
+		dynamicResolution = dynamicRes.init(options.width, options.height, benchmark ? 0 : windowSamples,
+			options.frameBudgetMs, options.minRenderScale, "Upscale.vertexshader", "Upscale.fragmentshader");
+		if (dynamicResolution)
+		{
+			printf("Dynamic resolution: %.1f ms GPU budget, scale %.2f to 1\n", options.frameBudgetMs,
+				options.minRenderScale);
+		}
+		else
+		{
+			printf("Dynamic resolution target unavailable, rendering at native resolution\n");
+		}
+	}
+	int renderWidth = options.width, renderHeight = options.height;
+
+	// Per-frame statistics reported next to the timings
+	const unsigned int visibleCounter = frameBench.addCounter("visible_heads");
+	const unsigned int occludedCounter = frameBench.addCounter("occluded_heads");
+	const unsigned int savedTriCounter = frameBench.addCounter("occluded_triangles");
+	const unsigned int stateCounter = frameBench.addCounter("state_changes");
+	const unsigned int forwardedCounter = frameBench.addCounter("gl_calls_forwarded");
+	const unsigned int elidedCounter = frameBench.addCounter("gl_calls_elided");
+	const unsigned int prepCounter = frameBench.addCounter("prep_ms");
+	const unsigned int transformCounter = frameBench.addCounter("transforms_updated");
+	const unsigned int shadowCounter = frameBench.addCounter("shadow_faces");
+	const unsigned int lightListCounter = frameBench.addCounter("cluster_light_entries");
+	const unsigned int lightAssignCounter = frameBench.addCounter("light_assign_ms");
+	const unsigned int shadedCounter = frameBench.addCounter("shaded_samples");
+	const unsigned int overdrawCounter = frameBench.addCounter("shading_overdraw");
+	const unsigned int scaleCounter = frameBench.addCounter("render_scale");
+	if (benchmark)
+	{
+		frameBench.begin(options.benchmarkFrames);
+	}
+	unsigned int frameIndex = 0;
+
+	// Optional capture of every frame, read back and encoded off the
+	// render thread's critical path
+	FrameCapture frameCapture;
+	if (!options.capturePrefix.empty())
+	{
+		frameCapture.init(options.width, options.height, options.captureFormat, options.capturePrefix);
+	}
+
 	// For speed computation - frame time counter
-	double lastTime = glfwGetTime();
+	double lastTime = clockSeconds();
 	int nbFrames = 0;
+	double msPerFrame = 0.0;
+	double lastCpuSeconds = processCpuSeconds();
+
+	// Input-to-present latency: from GLFW delivering a key press to the end
+	// of the swap of the first frame drawn from it
+	double kickedInputTime = -1.0;   // press behind the frame last kicked
+	double drawnInputTime = -1.0;    // press behind the frame being drawn
+	double latencySumMs = 0.0, latencyMaxMs = 0.0;
+	unsigned int latencyCount = 0;
+	bool cameraChanged = true;       // the first frame is always drawn
+	UniformStats uniformStats = { 0, 0 }; // uploads of the last complete frame
+	RenderQueueStats queueStats = { 0, 0, 0 }; // last submitted frame
+	GLStateStats glStats = { 0, 0, 0 };         // shadowed GL calls of the last frame
+	double prepMs = 0.0;                        // preparation time of the last frame
+	unsigned int transformsUpdated = 0;         // world matrices recomputed for the last frame
+
+	// Samples the shading pass runs the fragment shader for (what passes
+	// the depth test), read back a few frames late and only once the GPU
+	// has the result, so it never stalls (a late result is dropped).
+	// Divided by the target's samples it is the shading overdraw: about 1
+	// with the depth pre-pass, more the more heads overlap without it. Each
+	// slot keeps the render size of the frame it counted, which dynamic
+	// resolution may have changed since.
+	const unsigned int kShadedQueries = 4;
+	GLuint shadedQueries[kShadedQueries];
+	bool shadedQueryIssued[kShadedQueries] = {};
+	int shadedQuerySize[kShadedQueries][2] = {};
+	glGenQueries(kShadedQueries, shadedQueries);
+	GLint sceneSamples = 0;
+	if (dynamicResolution)
+	{
+		sceneSamples = benchmark ? 0 : windowSamples;
+	}
+	else
+	{
+		if (benchmark)
+		{
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, offscreen.framebuffer);
+		}
+		glGetIntegerv(GL_SAMPLES, &sceneSamples);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	}
+	double shadedSamples = 0.0; // latest read back
+	double shadingOverdraw = 0.0;
+
+	// Per-frame GL state goes through the shadow from here on; the setup
+	// above used raw calls, so tracking starts with everything unknown
+	glsInit(options.validateGLState);
+
+	// Sample the camera, describe the draws that don't depend on culling,
+	// and start preparing that frame
+	auto kickFrame = [&]()
+	{
+		PROFILE_SCOPE("kick frame");
+
+		// Compute the MVP matrix from keyboard and mouse input, or from the
+		// scripted path when benchmarking
+		if (benchmark)
+		{
+			computeMatricesFromScript(float(frameIndex) / float(options.benchmarkFrames), sceneRadius);
+		}
+		else
+		{
+			cameraChanged = computeMatricesFromInputs();
+			const double inputTime = cameraChanged ? getInputEventTime() : -1.0;
+			if (framePrep.overlapped())
+			{
+				// Drawn next iteration; this iteration draws the previous kick
+				drawnInputTime = kickedInputTime;
+				kickedInputTime = inputTime;
+			}
+			else
+			{
+				drawnInputTime = inputTime;
+			}
+		}
+
+		// Pick the shader permutations for this frame: the 'L' toggle
+		// selects whether diffuse + specular is compiled in at all
+		unsigned int lightingBits = getEnableDiffuseSpec() ? SHADING_DIFFUSE_SPECULAR : 0;
+		if (lightingBits && shadowsEnabled)
+		{
+			lightingBits |= SHADING_SHADOWS; // shadows only mask diffuse + specular
+		}
+		if (lightingBits && clusteredLights)
+		{
+			lightingBits |= SHADING_CLUSTERED_LIGHTS;
+		}
+		const bool floorUseTint = false; // floor stays textured; set to use the green tint
+		ShaderProgram& floorProgram = shading.get(lightingBits | (floorUseTint ? SHADING_USE_TINT : 0));
+		ShaderProgram& headProgram  = shading.get(lightingBits | (batched ? SHADING_INSTANCED : 0));
+
+		FramePrepInput& in = framePrep.nextInput();
+		in.view = getViewMatrix();
+		in.projection = getProjectionMatrix();
+		in.cameraPosition = getCameraPosition();
+		in.time = benchmark ? float(frameIndex) / 60.0f : float(glfwGetTime());
+		in.fixedBlocks.clear();
+		in.fixedPackets.clear();
+
+		// Floor: seen from both sides (no culling), pushed back with polygon
+		// offset to avoid z-fighting with heads touching z = 0
+		in.materials.resize(MATERIAL_COUNT);
+		SceneMaterial& floorMaterial = in.materials[MATERIAL_FLOOR];
+		floorMaterial.program = floorProgram.id();
+		floorMaterial.depthProgram = options.depthPrepass ? depthOnly.get(0).id() : 0;
+		floorMaterial.texture = Texture;
+		floorMaterial.renderState = RS_POLYGON_OFFSET;
+		floorMaterial.tint = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f); // green, used by the USE_TINT variant
+
+		SceneMaterial& headMaterial = in.materials[MATERIAL_HEAD];
+		headMaterial.program = headProgram.id();
+		headMaterial.depthProgram = options.depthPrepass ? depthOnly.get(batched ? SHADING_INSTANCED : 0).id() : 0;
+		headMaterial.texture = Texture;
+		headMaterial.renderState = RS_CULL_BACK;
+		headMaterial.tint = glm::vec4(0.0f);
+
+		// Batched heads: one packet for all of them
+		DrawPacket& headPacket = in.headPacket;
+		headPacket = DrawPacket();
+		headPacket.program = headProgram.id();
+		headPacket.texture = Texture;
+		headPacket.vao = instanced ? headInstancedVAO : headVAO;
+		headPacket.renderState = RS_CULL_BACK;
+		headPacket.indexCount = (GLsizei)indices.size();
+		headPacket.indexType = GL_UNSIGNED_SHORT;
+		in.headDepthProgram = headMaterial.depthProgram;
+		in.headDepthVao = headInstancedDepthVAO;
+		if (batched)
+		{
+			// Instanced / GPU-driven: one shared block (slot 0) whose M is the
+			// chin fix; the vertex shader applies each head's translation and
+			// yaw on top
+			PerObjectBlock batchBlock;
+			batchBlock.M = Rfix;
+			batchBlock.Tint = glm::vec4(0.0f);
+			in.fixedBlocks.push_back(batchBlock);
+			headPacket.uniformSlot = 0;
+		}
+		if (gpuDriven)
+		{
+			// One indirect draw covers every LOD; the VAO is the module's own
+			headPacket.vao = 0;
+			headPacket.customDraw = drawGpuDriven;
+			headPacket.key = RenderQueue::makeKey(PASS_OPAQUE, headPacket.program, headPacket.texture,
+				0, headPacket.renderState, 0.0f);
+			if (options.depthPrepass)
+			{
+				// The indirect draw twice; its VAO carries every attribute
+				in.fixedPackets.push_back(splitDepthPrepass(headPacket, in.headDepthProgram, 0, 0.0f));
+			}
+			in.fixedPackets.push_back(headPacket);
+		}
+		framePrep.kick();
+	};
+	if (framePrep.overlapped())
+	{
+		// The first frame has nothing to overlap with
+		kickFrame();
+	}
 
     // Main loop
 	do
 	{
+		// On demand: sleep until input, a window event or animation needs a
+		// frame. A held key keeps the camera changing, so it never sleeps
+		// then; once asleep it wakes every second to report idle CPU use.
+		if (onDemand)
+		{
+			while (!cameraChanged && animatedHeads == 0 && !inputPending() && !glfwWindowShouldClose(window))
+			{
+				double now = clockSeconds();
+				if (now - lastTime >= 1.0)
+				{
+					double cpuSeconds = processCpuSeconds();
+					printf("idle: %d frames drawn, %.1f%% CPU\n", nbFrames,
+						100.0 * (cpuSeconds - lastCpuSeconds) / (now - lastTime));
+					lastCpuSeconds = cpuSeconds;
+					nbFrames = 0;
+					lastTime = now;
+				}
+				waitForInput(lastTime + 1.0 - now);
+			}
+		}
+
+		PROFILE_SCOPE("frame");
+		profilerBeginFrame();
+
 		// Measure speed
-		double currentTime = glfwGetTime();
+		double currentTime = clockSeconds();
 		nbFrames++;
 		if ( currentTime - lastTime >= 1.0 ){ // If last prinf() was more than 1sec ago
 			// printf and reset
-			printf("%f ms/frame\n", 1000.0/double(nbFrames));
+			msPerFrame = 1000.0/double(nbFrames);
+			printf("%f ms/frame, %u uniform uploads/frame (%u avoided), %u state changes (%u unsorted), "
+				"%u GL state calls (%u elided), %u/%u heads visible",
+				msPerFrame, uniformStats.issued, uniformStats.avoided, queueStats.stateChanges,
+				queueStats.naiveStateChanges, glStats.forwarded, glStats.elided, visibleHeads, numHeads);
+			printf(", prep %.2f ms, %u transforms updated", prepMs, transformsUpdated);
+			printf(", %.2fx shading overdraw (%s)", shadingOverdraw,
+				options.depthPrepass ? "depth pre-pass" : "front to back");
+			if (dynamicResolution)
+			{
+				printf(", rendering %dx%d (scale %.3f, %.2f ms GPU)", renderWidth, renderHeight,
+					dynamicRes.scale(), dynamicRes.stats().smoothedGpuMs);
+			}
+			if (shadowsEnabled)
+			{
+				printf(", %u shadow faces redrawn", shadowFaces);
+			}
+			if (clusteredLights && !lightClusters.gpuAssignment())
+			{
+				const LightClusterStats& lightStats = lightClusters.stats();
+				printf(", %u cluster light entries (max %u), lights assigned in %.2f ms",
+					lightStats.listEntries, lightStats.maxPerCluster, lightStats.assignMs);
+			}
+			if (occlusionCulling)
+			{
+				// Instanced, an occluded head is one instance fewer in the
+				// single draw rather than a draw saved
+				printf(instanced ? ", %u occluded (%u instances culled / %u triangles saved)" :
+					", %u occluded (%u draws / %u triangles saved)",
+					occludedHeads, occludedHeads, occludedTriangles);
+			}
+			double cpuSeconds = processCpuSeconds();
+			printf(", %.1f%% CPU", 100.0 * (cpuSeconds - lastCpuSeconds) / (currentTime - lastTime));
+			lastCpuSeconds = cpuSeconds;
+			if (latencyCount > 0)
+			{
+				printf(", input to present %.1f ms (max %.1f)", latencySumMs / latencyCount, latencyMaxMs);
+				latencySumMs = latencyMaxMs = 0.0;
+				latencyCount = 0;
+			}
+			printf("\n");
 			nbFrames = 0;
 			lastTime += 1.0;
 		}
 
-		// Clear the screen
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glsBeginFrame();
+		if (benchmark)
+		{
+			frameBench.beginFrame();
+			bindRenderTarget(offscreen);
+		}
 
+		// Clear the screen, or the part of the scaled target in use
+		if (dynamicResolution)
+		{
+			dynamicRes.beginFrame();
+			renderWidth = dynamicRes.renderWidth();
+			renderHeight = dynamicRes.renderHeight();
+			if (benchmark)
+			{
+				frameBench.setCounter(scaleCounter, dynamicRes.scale());
+			}
+		}
+		else
+		{
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		}
+		ShaderProgram::beginFrame();
 
-		// Compute the MVP matrix from keyboard and mouse input
-		computeMatricesFromInputs();
-		glm::mat4 ProjectionMatrix = getProjectionMatrix();
-		glm::mat4 ViewMatrix = getViewMatrix();
-		
-		// Use our shader
-		glUseProgram(programID);
-	
-		glm::vec3 lightPos = glm::vec3(4,4,4);
-		glUniform3f(LightID, lightPos.x, lightPos.y, lightPos.z);
-		glUniformMatrix4fv(ViewMatrixID, 1, GL_FALSE, &ViewMatrix[0][0]); // This one doesn't change between objects, so this can be done once for all objects that use "programID"
-		
-		// Draw floor rectangle
-		
-		// Make sure we see it from both sides (or set proper winding)
-        GLboolean wasCulled = glIsEnabled(GL_CULL_FACE);
-        glDisable(GL_CULL_FACE);
-        
-        // Avoid z-fighting with heads touching z=0
-        glEnable(GL_POLYGON_OFFSET_FILL);
-        glPolygonOffset(1.0f, 1.0f);
-        
-        glm::mat4 M_floor(1.0f); // stays on z = 0
-        glm::mat4 MVP_floor = ProjectionMatrix * ViewMatrix * M_floor;
-        
-        // uniforms the shader already expects
-        glUniformMatrix4fv(MatrixID,      1, GL_FALSE, &MVP_floor[0][0]);
-        glUniformMatrix4fv(ViewMatrixID,  1, GL_FALSE, &ViewMatrix[0][0]);
-        glUniformMatrix4fv(ModelMatrixID, 1, GL_FALSE, &M_floor[0][0]);
-        
-        // bind SAME texture + sampler uniform
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, Texture);
-        glUniform1i(TextureID, 0);
-        
-        // get uniform locations once (after program link)
-        GLint uUseTintLoc = glGetUniformLocation(programID, "uUseTint");
-        GLint uTintLoc    = glGetUniformLocation(programID, "uTint");
-        
-        GLint uEnableLoc = glGetUniformLocation(programID, "uEnableDiffuseSpec");
-        glUniform1i(uEnableLoc, getEnableDiffuseSpec() ? 1 : 0);
-        
-        // Use a solid green tint for the floor (shader multiplies it)
-        glUniform1i(uUseTintLoc, 0); // 0 = use texture (still)
-        glUniform3f(uTintLoc, 0.0f, 1.0f, 0.0f); // tint color if enabled
-        
-        glBindVertexArray(floorVAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (void*)0); // Draws the floor
-        glBindVertexArray(0);
-        
-        glDisable(GL_POLYGON_OFFSET_FILL);
-        if (wasCulled) glEnable(GL_CULL_FACE);
-		
-		// Draw all suzanne heads
-		// Place 8 heads on a circuit of radius r in the x-y plane
-		const float r = sqrt(14.0f);    // radial distance from origin
-        const float start = -M_PI / 2;  // start at -90 degrees
-        const float step = M_PI / 4;    // 45 degree offsets
-        
-        for (int i = 0; i < 8; i++)
-        {
-            // Polar placement
-            float theta = start + i * step;
-            float x = r * std::cos(theta);
-            float y = r * std::sin(theta);
-            float yaw = theta + M_PI / 2;
-            
-            // Model transformation:
-            // 1. Move onto ring
-            // 2. Yaw the head to face radially away from origin
-            // 3. Apply x-rotation and vertical lift to place chins on z = 0 plane
-            glm::mat4 M(1.0f);
-            M = glm::translate(M, glm::vec3(x, y, liftToGround));  // place on ring
-            M = glm::rotate(M, yaw, glm::vec3(0,0,1));             // face radially
-            M = M * Rfix;                                          // chin fix
-            glm::mat4 MVP = ProjectionMatrix * ViewMatrix * M;
-            
-            // Send our transformation to the currently bound shader, 
-    		// in the "MVP" uniform
-    		glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
-    		glUniformMatrix4fv(ModelMatrixID, 1, GL_FALSE, &M[0][0]);
-    
-    		glBindVertexArray(VertexArrayID);  // re-bind a VAO we can attach attributes to
-    		glUniform1i(uUseTintLoc, 0); // back to textured heads
-    		
-    		// 1rst attribute buffer : vertices
-    		glEnableVertexAttribArray(0);
-    		glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-    		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-    		// 2nd attribute buffer : UVs
-    		glEnableVertexAttribArray(1);
-    		glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
-    		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-    		// 3rd attribute buffer : normals
-    		glEnableVertexAttribArray(2);
-    		glBindBuffer(GL_ARRAY_BUFFER, normalbuffer);
-    		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-    		// Index buffer
-    		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementbuffer);
-    
-    		// Draw the triangles !
-    		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, (void*)0);
-    	
-        }
 
-		glDisableVertexAttribArray(0);
-		glDisableVertexAttribArray(1);
-		glDisableVertexAttribArray(2);
+		// Start this iteration's frame, then take the oldest prepared one:
+		// with overlap that is last iteration's, prepared while the previous
+		// frame was submitted
+		kickFrame();
+		PreparedFrame& frame = framePrep.wait();
+		visibleHeads = frame.visibleCount;
+		occludedHeads = frame.occluded;
+		occludedTriangles = frame.occludedTriangles;
+		prepMs = frame.prepMs;
+		transformsUpdated = frame.transformsUpdated;
+		if (benchmark)
+		{
+			frameBench.setCounter(prepCounter, prepMs);
+			frameBench.setCounter(transformCounter, transformsUpdated);
+		}
+		if (benchmark && !gpuDriven) // GPU-driven visibility stays on the GPU
+		{
+			frameBench.setCounter(visibleCounter, visibleHeads);
+			frameBench.setCounter(occludedCounter, occludedHeads);
+			frameBench.setCounter(savedTriCounter, occludedTriangles);
+		}
+		const glm::mat4& ViewMatrix = frame.input.view;
+		const glm::mat4& ProjectionMatrix = frame.input.projection;
+		glm::mat4 viewProj = ProjectionMatrix * ViewMatrix;
 
-		// Swap buffers
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		// Redraw what changed in the shadow map: the spinning heads (the
+		// first rows) moved, nothing else did
+		if (shadowsEnabled)
+		{
+			PROFILE_SCOPE("shadow update");
+			GPU_PROFILE_SCOPE("shadow update");
+			shadows.setLight(lightPosition);
+			for (size_t i = 0; i < frame.spinPlacements.size(); i++)
+			{
+				casterPlacements[i] = frame.spinPlacements[i];
+				shadows.invalidateSphere(headSpheres[i]);
+			}
+			// The scene target to return to: the scaled one, the
+			// benchmark's offscreen one, or the window
+			GLuint sceneFramebuffer = dynamicResolution ? dynamicRes.framebuffer() :
+				benchmark ? offscreen.framebuffer : 0;
+			shadowFaces = shadows.update(&casterPlacements[0], sceneFramebuffer, renderWidth, renderHeight);
+			glsActiveTexture(GL_TEXTURE1);
+			glsBindTexture(GL_TEXTURE_CUBE_MAP, shadows.texture());
+			glsActiveTexture(GL_TEXTURE0);
+			if (benchmark)
+			{
+				frameBench.setCounter(shadowCounter, shadowFaces);
+			}
+		}
+
+		// Light lists of this view's clusters (CPU pool or compute shader)
+		if (clusteredLights)
+		{
+			PROFILE_SCOPE("light assignment");
+			GPU_PROFILE_SCOPE("light assignment");
+			lightClusters.update(ViewMatrix, ProjectionMatrix);
+			lightClusters.bindTextures(2);
+			if (benchmark)
+			{
+				frameBench.setCounter(lightListCounter, lightClusters.stats().listEntries);
+				frameBench.setCounter(lightAssignCounter, lightClusters.stats().assignMs);
+			}
+		}
+
+		{
+			PROFILE_SCOPE("upload uniforms");
+
+			// Everything that doesn't change between objects: one upload per frame
+			PerFrameBlock frameBlock;
+			frameBlock.V = ViewMatrix;
+			frameBlock.P = ProjectionMatrix;
+			frameBlock.LightPosition_worldspace = glm::vec4(lightPosition, 1);
+			glm::vec2 shadowDepth = shadowsEnabled ? shadows.depthParams() : glm::vec2(0.0f);
+			frameBlock.ShadowParams = glm::vec4(shadowDepth.x, shadowDepth.y, 0.0002f, 0.02f);
+			frameBlock.ClusterParams = clusteredLights ?
+				lightClusters.shaderParams(renderWidth, renderHeight) : glm::vec4(0.0f);
+			frameBlock.ClusterOffsets = lightClusters.shaderOffsets();
+			beginFrameUniforms(frameBlock, (unsigned int)frame.blocks.size());
+
+			// The per-object blocks were computed by the workers (the GPU forms
+			// P * V * M itself); packet slots index them from 0
+			pushObjectUniformBlocks(&frame.blocks[0], (unsigned int)frame.blocks.size());
+			flushObjectUniforms();
+		}
+
+		if (benchmark)
+		{
+			frameBench.markSubmit();
+		}
+
+		// GPU-driven: cull and pick LODs before the queue's indirect draw
+		// (the dispatch binds its own compute program)
+		if (gpuDriven)
+		{
+			PROFILE_SCOPE("GPU culling dispatch");
+			GPU_PROFILE_SCOPE("GPU culling");
+			dispatchGpuCulling(viewProj, frame.input.cameraPosition);
+		}
+		if (streamedInstances)
+		{
+			// Only the visible heads go into this frame's segment of the
+			// instance stream; the VAO's instance attribute is moved to it
+			PROFILE_SCOPE("instance upload");
+			instanceStream.beginFrame();
+			StreamAllocation instances = instanceStream.allocate(GLsizeiptr(visibleHeads * sizeof(glm::vec4)));
+			if (visibleHeads > 0)
+			{
+				memcpy(instances.data, &frame.visiblePlacements[0], visibleHeads * sizeof(glm::vec4));
+			}
+			instanceStream.flush();
+			glsBindVertexArray(headInstancedVAO);
+			glsBindBuffer(GL_ARRAY_BUFFER, instanceStream.buffer());
+			glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, (void*)instances.offset);
+			if (options.depthPrepass)
+			{
+				glsBindVertexArray(headInstancedDepthVAO);
+				glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, (void*)instances.offset);
+			}
+		}
+
+		// Shaded samples of the frame this query slot last counted, if the
+		// GPU has finished it; reusing the slot below discards a late one
+		const unsigned int shadedSlot = frameIndex % kShadedQueries;
+		bool shadedSampleRead = false;
+		if (shadedQueryIssued[shadedSlot])
+		{
+			GLint available = 0;
+			glGetQueryObjectiv(shadedQueries[shadedSlot], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				GLuint64 samples = 0;
+				glGetQueryObjectui64v(shadedQueries[shadedSlot], GL_QUERY_RESULT, &samples);
+				shadedSamples = double(samples);
+				shadingOverdraw = shadedSamples / (double(shadedQuerySize[shadedSlot][0]) *
+					shadedQuerySize[shadedSlot][1] * std::max(sceneSamples, 1));
+				shadedSampleRead = true;
+			}
+		}
+
+		// Draw the floor and all suzanne heads
+		{
+			PROFILE_SCOPE("submit queue");
+			GPU_PROFILE_SCOPE("draw scene");
+			frame.queue.submit(shadedQueries[shadedSlot]);
+			shadedQueryIssued[shadedSlot] = true;
+			shadedQuerySize[shadedSlot][0] = renderWidth;
+			shadedQuerySize[shadedSlot][1] = renderHeight;
+		}
+		queueStats = frame.queue.stats();
+		if (benchmark)
+		{
+			frameBench.setCounter(stateCounter, queueStats.stateChanges);
+			if (shadedSampleRead)
+			{
+				frameBench.setCounter(shadedCounter, shadedSamples);
+				frameBench.setCounter(overdrawCounter, shadingOverdraw);
+			}
+		}
+
+		if (verifyCulling)
+		{
+			// Stalls on the GPU results: a correctness mode, not for timing
+			PROFILE_SCOPE("verify culling");
+			readBackGpuCulling(gpuCull);
+			cullOnCpu(viewProj, frame.input.cameraPosition, cpuCull);
+			CullComparison cmp = compareCullResults(gpuCull, cpuCull);
+			cullChecks++;
+			cullMismatches += cmp.mismatches;
+			cullBorderline += cmp.borderline;
+			if (cmp.mismatches > cmp.borderline)
+			{
+				printf("Frame %u: GPU culling differs from the CPU reference for %u objects\n",
+					frameIndex, cmp.mismatches - cmp.borderline);
+			}
+		}
+
+		endFrameUniforms();
+		if (streamedInstances)
+		{
+			instanceStream.endFrame();
+		}
+		if (clusteredLights)
+		{
+			lightClusters.endFrame();
+		}
+		uniformStats = ShaderProgram::frameStats();
+
+		// Stretch the scene over the frame; the HUD is drawn at full size
+		if (dynamicResolution)
+		{
+			PROFILE_SCOPE("upscale");
+			GPU_PROFILE_SCOPE("upscale");
+			dynamicRes.endFrame(benchmark ? offscreen.framebuffer : 0, options.width, options.height);
+		}
+
+		// HUD: every label is queued, then drawn with one call
+		if (hudEnabled)
+		{
+			PROFILE_SCOPE("HUD");
+			GPU_PROFILE_SCOPE("HUD");
+			char hudLine[64];
+			snprintf(hudLine, sizeof(hudLine), "%.2f ms/frame", msPerFrame);
+			printText2D(hudLine, 10, 570, 20);
+			snprintf(hudLine, sizeof(hudLine), "%u shader variants", shading.compiledCount());
+			printText2D(hudLine, 10, 545, 20);
+			if (!gpuDriven)
+			{
+				snprintf(hudLine, sizeof(hudLine), "%u/%u heads visible", visibleHeads, numHeads);
+				printText2D(hudLine, 10, 520, 20);
+			}
+			snprintf(hudLine, sizeof(hudLine), "%u state changes", queueStats.stateChanges);
+			printText2D(hudLine, 10, 470, 20);
+			if (occlusionCulling)
+			{
+				snprintf(hudLine, sizeof(hudLine), "%u occluded", occludedHeads);
+				printText2D(hudLine, 10, 495, 20);
+			}
+			if (dynamicResolution)
+			{
+				snprintf(hudLine, sizeof(hudLine), "%dx%d render", renderWidth, renderHeight);
+				printText2D(hudLine, 10, 445, 20);
+			}
+			flushText2D();
+		}
+
+		glStats = glsFrameStats();
+		if (benchmark)
+		{
+			frameBench.setCounter(forwardedCounter, glStats.forwarded);
+			frameBench.setCounter(elidedCounter, glStats.elided);
+		}
+		if (options.validateGLState)
+		{
+			glsValidate("end of frame");
+		}
+
+		// Queue this frame's readback (offscreen target or back buffer)
+		frameCapture.capture(frameIndex);
+
+		// Swap buffers (offscreen benchmark frames are never presented)
+		if (benchmark)
+		{
+			frameBench.endFrame();
+		}
+		else
+		{
+			PROFILE_SCOPE("swap buffers");
+			glfwSwapBuffers(window);
+		}
+		if (drawnInputTime >= 0.0)
+		{
+			const double latencyMs = (glfwGetTime() - drawnInputTime) * 1000.0;
+			latencySumMs += latencyMs;
+			latencyMaxMs = std::max(latencyMaxMs, latencyMs);
+			latencyCount++;
+			drawnInputTime = -1.0;
+		}
+		if (!headless)
+		{
+			glfwPollEvents();
+		}
+		frameIndex++;
 
 	} // Check if the ESC key was pressed or the window was closed
-	while( glfwGetKey(window, GLFW_KEY_ESCAPE ) != GLFW_PRESS &&
-		   glfwWindowShouldClose(window) == 0 );
+	while( (headless || (glfwGetKey(window, GLFW_KEY_ESCAPE ) != GLFW_PRESS &&
+		                 glfwWindowShouldClose(window) == 0)) &&
+		   (!benchmark || frameIndex < options.benchmarkFrames) );
+
+	if (benchmark)
+	{
+		frameBench.finish();
+		frameBench.printSummary();
+		char description[256];
+		snprintf(description, sizeof(description), "%u heads, %s layout, %s, %s, %dx%d%s%s",
+			numHeads, sceneLayoutName(options.scene.layout),
+			gpuDriven ? "GPU-driven" : instanced ? "instanced" : "one draw per head",
+			options.depthPrepass ? "depth pre-pass" : "front to back",
+			options.width, options.height, dynamicResolution ? ", dynamic resolution" : "",
+			headless ? ", headless" : "");
+		frameBench.writeReport(options.benchmarkOutput, description);
+		destroyRenderTarget(offscreen);
+
+		// Frames that had to wait for the GPU to release a stream segment
+		const StreamStats& uniformStream = uniformStreamStats();
+		printf("Streaming: uniforms %u stalls (%.1f ms), peak %.1f KB/frame", uniformStream.stalls, uniformStream.stallMs, uniformStream.peakBytes / 1024.0);
+		if (streamedInstances)
+		{
+			const StreamStats& instances = instanceStream.stats();
+			printf("; instances %u stalls (%.1f ms), peak %.1f KB/frame", instances.stalls, instances.stallMs,
+				instances.peakBytes / 1024.0);
+		}
+		printf("\n");
+	}
+
+	if (frameCapture.active())
+	{
+		frameCapture.shutdown();
+		CaptureStats captureStats = frameCapture.stats();
+		printf("Capture: %u/%u frames written, handed to the encoder %.2f frames after their read, "
+			"%u stalls (%.1f ms)\n", captureStats.written, captureStats.captured, captureStats.meanDelay,
+			captureStats.stalls, captureStats.stallMs);
+	}
+
+	if (shadowsEnabled)
+	{
+		const ShadowStats& shadowStats = shadows.stats();
+		const double facePixels = double(options.shadowSize) * options.shadowSize;
+		printf("Shadows: %u of %u frames redrew the map, %u face regions (%u whole faces), "
+			"%.2f faces' worth of pixels and %.1f casters per frame\n", shadowStats.updates, frameIndex,
+			shadowStats.facesRendered, shadowStats.fullFaces,
+			frameIndex ? shadowStats.pixelsRendered / facePixels / frameIndex : 0.0,
+			frameIndex ? double(shadowStats.castersDrawn) / frameIndex : 0.0);
+	}
+
+	// Profile of the whole run (GPU results still in flight are waited for)
+	profilerShutdown();
+	if (profilerEnabled())
+	{
+		profilerPrintSummary();
+		profilerWriteTrace(options.tracePath.c_str());
+	}
+
+	// Culling check summary; differences beyond float tolerance fail the run
+	int exitCode = 0;
+	if (options.validateGLState)
+	{
+		printf("GL state check: %u mismatches between the shadow and the driver\n",
+			glsFrameStats().validationErrors);
+		if (glsFrameStats().validationErrors > 0)
+		{
+			exitCode = 1;
+		}
+	}
+	if (verifyCulling)
+	{
+		printf("Culling check: %u frames, %u mismatching objects (%u within tolerance of a boundary)\n",
+			cullChecks, cullMismatches, cullBorderline);
+		if (cullMismatches > cullBorderline)
+		{
+			exitCode = 1;
+		}
+	}
 
 	// Cleanup VBO and shader
 	glDeleteBuffers(1, &vertexbuffer);
 	glDeleteBuffers(1, &uvbuffer);
 	glDeleteBuffers(1, &normalbuffer);
 	glDeleteBuffers(1, &elementbuffer);
-	glDeleteProgram(programID);
+	shading.destroy();
+	depthOnly.destroy();
+	glDeleteQueries(kShadedQueries, shadedQueries);
+	if (hudEnabled)
+	{
+		cleanupText2D();
+	}
+	cleanupUniformBlocks();
+	shadows.destroy();
+	lightClusters.destroy();
+	dynamicRes.destroy();
 	glDeleteTextures(1, &Texture);
 	glDeleteVertexArrays(1, &VertexArrayID);
+	glDeleteVertexArrays(1, &headVAO);
+	glDeleteVertexArrays(1, &headDepthVAO);
+	if (instanced)
+	{
+		glDeleteBuffers(1, &instancebuffer);
+		instanceStream.destroy();
+		glDeleteVertexArrays(1, &headInstancedVAO);
+		glDeleteVertexArrays(1, &headInstancedDepthVAO);
+	}
+	if (gpuDriven)
+	{
+		cleanupGpuDriven();
+	}
+	framePrep.shutdown();
+	occlusion.shutdown();
+	prepWorkers.stop();
 
-	// Close OpenGL window and terminate GLFW
+	// Close OpenGL window (or the headless context) and terminate GLFW
+	destroyHeadlessContext();
 	glfwTerminate();
 
-	return 0;
+	return exitCode;
 }
 